@@ -2,6 +2,7 @@
 #define SOS_ARCH_COMMON_CONTEXT_H
 
 #include "../../lib/types.h"
+#include "../../memory/memory_map.h"
 
 struct cpu_context;
 
@@ -10,6 +11,14 @@ bool arch_is_userspace_context(struct cpu_context* context);
 void arch_set_syscall_return_value(struct cpu_context* context, u64 value);
 
 u64 arch_get_instruction_pointer(struct cpu_context* context);
+void arch_set_instruction_pointer(struct cpu_context* context, u64 ip);
+
+// These functions should be called only from page fault handler
+vaddr arch_get_page_fault_address(struct cpu_context* context);
+bool arch_is_page_fault_on_write(struct cpu_context* context);
+// Fault was caused by access rights rather than by missing translation
+bool arch_is_page_fault_on_present_page(struct cpu_context* context);
+bool arch_is_page_fault_on_instruction_fetch(struct cpu_context* context);
 
 void arch_clone_cpu_context(struct cpu_context* src, struct cpu_context* dst);
 
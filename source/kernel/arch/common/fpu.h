@@ -0,0 +1,40 @@
+#ifndef SOS_ARCH_COMMON_FPU_H
+#define SOS_ARCH_COMMON_FPU_H
+
+#include "../../lib/types.h"
+
+struct _thread;
+
+/*
+ * Every user thread owns area for its fpu and vector registers. Registers are
+ * saved to the area when thread leaves cpu and restored lazily, on the first
+ * fpu instruction after thread comes back, so threads which don't touch fpu
+ * never pay for it.
+ */
+
+// Returns area holding initial fpu state or NULL if out of memory
+void* arch_fpu_state_alloc();
+void arch_fpu_state_free(void* state);
+
+// Called by scheduler when cpu is switched from prev to next
+void arch_fpu_switch(struct _thread* prev, struct _thread* next);
+
+// Copies fpu state of current thread to another thread
+void arch_fpu_clone(struct _thread* dst);
+
+/*
+ * Kernel may use vector registers only between kernel_fpu_begin and
+ * kernel_fpu_end and only in files built without -mgeneral-regs-only (see
+ * Makefile). Live user state is saved first and interrupts stay disabled, so
+ * thread can't be preempted or migrated inside section. Sections can't nest
+ * and must not sleep.
+ */
+
+// Returns interrupts state to pass to kernel_fpu_end
+bool kernel_fpu_begin();
+void kernel_fpu_end(bool interrupts_enabled);
+
+// False on cpu whose fpu isn't set up yet, i.e. during its early boot
+bool kernel_fpu_usable();
+
+#endif // SOS_ARCH_COMMON_FPU_H
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef SOS_ARCH_COMMON_PERCPU_H
+#define SOS_ARCH_COMMON_PERCPU_H
+
+#include "../../lib/types.h"
+
+struct percpu;
+
+// Makes provided area reachable through this_cpu_* accessors on current cpu
+void arch_percpu_set(struct percpu* area);
+
+// Each accessor is a single instruction relative to current cpu area, so it
+// can't observe data of another cpu even if thread migrates in the meantime.
+// Arch header defines them inline, so that no access costs a call:
+// u64 arch_this_cpu_read(u64 offset);
+// void arch_this_cpu_write(u64 offset, u64 value);
+// void arch_this_cpu_add(u64 offset, u64 value);
+#include "../x86_64/cpu/percpu.h"
+
+#endif // SOS_ARCH_COMMON_PERCPU_H
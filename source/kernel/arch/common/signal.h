@@ -9,6 +9,11 @@ struct cpu_context;
 void arch_enter_signal_handler(struct cpu_context* context,
                                signal_handler* handler);
 
+// Code which user space returns to from signal handler, it makes syscall for
+// signal return. It is mapped once into every process, see vdso.h
+const void* arch_signal_trampoline_code();
+u64 arch_signal_trampoline_size();
+
 // returns value of register, that is used for carrying syscall return value and
 // will be scratched, to preserve it.
 u64 arch_return_from_signal_handler(struct cpu_context* context);
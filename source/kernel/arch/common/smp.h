@@ -0,0 +1,20 @@
+#ifndef SOS_ARCH_COMMON_SMP_H
+#define SOS_ARCH_COMMON_SMP_H
+
+#include "../../lib/types.h"
+
+#define MAX_CPUS 64
+
+// Starts application processors, each of them enters scheduler once it is up.
+// Should be called after scheduler is initialized.
+void arch_smp_init();
+
+// Cpus are indexed in range [0, arch_cpus_count()), boot cpu is 0
+u64 arch_cpus_count();
+
+// Makes provided cpu enter scheduler as soon as possible
+void arch_send_reschedule(u64 cpu);
+// Same as above, for all cpus except current one
+void arch_broadcast_reschedule();
+
+#endif // SOS_ARCH_COMMON_SMP_H
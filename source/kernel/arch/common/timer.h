@@ -0,0 +1,9 @@
+#ifndef SOS_ARCH_COMMON_TIMER_H
+#define SOS_ARCH_COMMON_TIMER_H
+
+#include "../../lib/types.h"
+
+// Seconds since unix epoch, read from hardware clock
+u64 arch_wall_clock_seconds();
+
+#endif // SOS_ARCH_COMMON_TIMER_H
\ No newline at end of file
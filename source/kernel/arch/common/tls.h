@@ -0,0 +1,20 @@
+#ifndef SOS_ARCH_COMMON_TLS_H
+#define SOS_ARCH_COMMON_TLS_H
+
+#include "../../lib/types.h"
+
+// User thread pointer (fs base on x86_64), it stays in cpu while user thread
+// runs and is switched together with threads
+u64 arch_tls_read();
+void arch_tls_write(u64 base);
+
+// Second user base register (gs base on x86_64). Kernel doesn't use it for
+// user space, it is only kept per thread when user space can change it.
+u64 arch_tls_aux_read();
+void arch_tls_aux_write(u64 base);
+
+// True if user space may change thread pointer without kernel, so it has to
+// be read back when thread leaves cpu
+bool arch_tls_user_writable();
+
+#endif // SOS_ARCH_COMMON_TLS_H
\ No newline at end of file
@@ -6,6 +6,22 @@
 
 extern const u64 PAGE_SIZE;
 
+#define UNMAP_BATCH_SIZE 64
+
+// Range of pages unmapped from vm space and their private frames. Other cpus
+// that have space loaded may still cache translations to them, so frames are
+// returned to pmm only by arch_finish_unmap, after those cpus flushed range.
+typedef struct {
+    vm_space* space;
+    vaddr start;
+    vaddr end;
+    paddr frames[UNMAP_BATCH_SIZE];
+    u64 count;
+} unmap_batch;
+
+#define UNMAP_BATCH_INITIALIZER(vm)                                            \
+    { .space = (vm), .start = 0, .end = 0, .count = 0 }
+
 void arch_init_kernel_vm(vm_space* kernel_space);
 
 void arch_set_vm_space(vm_space* space);
@@ -14,11 +30,32 @@ void arch_notify_vm_space_changed();
 bool arch_map_page(struct page_table* table, vaddr page, vm_area_flags flags);
 bool arch_map_page_to_frame(struct page_table* table, vaddr page, paddr frame,
                             vm_area_flags flags);
-bool arch_unmap_page(struct page_table* table, vaddr page);
+bool arch_unmap_page(struct page_table* table, vaddr page,
+                     unmap_batch* batch);
+// Flushes unmapped range on other cpus that have space of batch loaded and
+// frees collected frames
+void arch_finish_unmap(unmap_batch* batch);
+
+// Drops translations of pages in [start, end) cached by current cpu and by
+// other cpus that have space loaded, waiting until they are done
+void arch_flush_tlb_range(vm_space* space, vaddr start, vaddr end);
+// Drops translation of page cached by current cpu only
+void arch_flush_local_tlb_page(vaddr page);
+
+// Maps frame, that is not owned by page table: it won't be freed on unmapping
+// or table destruction and won't be copied on fork
+bool arch_map_page_to_shared_frame(struct page_table* table, vaddr page,
+                                   paddr frame, vm_area_flags flags);
+// Replaces shared frame mapped at page with private copy of it, does nothing
+// if page is already backed by private frame
+bool arch_unshare_page(struct page_table* table, vaddr page,
+                       vm_area_flags flags);
 
 bool arch_map_kernel_page(vaddr page, vm_area_flags flags);
 
+// Returns NULL if page isn't mapped
 void* arch_get_page_view(struct page_table* table, vaddr page);
+bool arch_is_page_mapped(struct page_table* table, vaddr page);
 vm_area_flags arch_get_page_flags(struct page_table* table, vaddr page);
 
 struct page_table* arch_fork_page_table(struct page_table* table);
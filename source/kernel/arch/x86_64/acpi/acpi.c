@@ -0,0 +1,95 @@
+#include "acpi.h"
+#include "../../../lib/memory_util.h"
+
+#define RSDP_SIGNATURE "RSD PTR "
+#define RSDP_SIGNATURE_LENGTH 8
+#define RSDP_V1_LENGTH 20
+
+#define BIOS_AREA_START 0xE0000
+#define BIOS_AREA_END 0xFFFFF
+#define EBDA_POINTER_ADDR 0x40E
+#define EBDA_SEARCH_LENGTH 1024
+
+static const acpi_sdt_header* root_table = NULL;
+static bool extended_root_table = false;
+
+static bool checksum_valid(const void* data, u64 length) {
+    const u8* bytes = (const u8*) data;
+    u8 sum = 0;
+
+    for (u64 i = 0; i < length; i++) {
+        sum += bytes[i];
+    }
+
+    return sum == 0;
+}
+
+static bool rsdp_valid(const acpi_rsdp* rsdp) {
+    if (memcmp(rsdp->signature, RSDP_SIGNATURE, RSDP_SIGNATURE_LENGTH) != 0)
+        return false;
+    if (!checksum_valid(rsdp, RSDP_V1_LENGTH))
+        return false;
+
+    return rsdp->revision < 2 || checksum_valid(rsdp, rsdp->length);
+}
+
+static const acpi_rsdp* search_rsdp(paddr start, paddr end) {
+    // RSDP is always 16 byte aligned
+    for (paddr addr = start; addr + sizeof(acpi_rsdp) <= end; addr += 16) {
+        const acpi_rsdp* rsdp = (const acpi_rsdp*) P2V(addr);
+        if (rsdp_valid(rsdp))
+            return rsdp;
+    }
+
+    return NULL;
+}
+
+static const acpi_rsdp* find_rsdp() {
+    paddr ebda = (paddr) (*(u16*) P2V(EBDA_POINTER_ADDR)) << 4;
+    const acpi_rsdp* rsdp =
+        ebda ? search_rsdp(ebda, ebda + EBDA_SEARCH_LENGTH) : NULL;
+
+    return rsdp ? rsdp : search_rsdp(BIOS_AREA_START, BIOS_AREA_END);
+}
+
+bool acpi_init(paddr rsdp_addr) {
+    const acpi_rsdp* rsdp =
+        rsdp_addr ? (const acpi_rsdp*) P2V(rsdp_addr) : find_rsdp();
+
+    if (!rsdp || !rsdp_valid(rsdp))
+        return false;
+
+    extended_root_table = rsdp->revision >= 2 && rsdp->xsdt_address;
+    root_table = (const acpi_sdt_header*) P2V(
+        extended_root_table ? rsdp->xsdt_address : rsdp->rsdt_address);
+
+    if (!checksum_valid(root_table, root_table->length)) {
+        root_table = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+const acpi_sdt_header* acpi_find_table(const char signature[4]) {
+    if (!root_table)
+        return NULL;
+
+    u64 entry_size = extended_root_table ? sizeof(u64) : sizeof(u32);
+    u64 entries = (root_table->length - sizeof(acpi_sdt_header)) / entry_size;
+    const u8* entries_start = (const u8*) (root_table + 1);
+
+    for (u64 i = 0; i < entries; i++) {
+        const u8* entry = entries_start + i * entry_size;
+        paddr table_addr =
+            extended_root_table ? *(const u64*) entry : *(const u32*) entry;
+
+        const acpi_sdt_header* table =
+            (const acpi_sdt_header*) P2V(table_addr);
+        if (memcmp(table->signature, signature, 4) == 0
+            && checksum_valid(table, table->length))
+            return table;
+    }
+
+    return NULL;
+}
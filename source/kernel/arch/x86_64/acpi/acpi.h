@@ -0,0 +1,39 @@
+#ifndef SOS_ACPI_H
+#define SOS_ACPI_H
+
+#include "../../../lib/types.h"
+#include "../../../memory/memory_map.h"
+
+typedef struct __attribute__((__packed__)) {
+    char signature[8];
+    u8 checksum;
+    char oem_id[6];
+    u8 revision;
+    u32 rsdt_address;
+    // fields below are valid only since ACPI 2.0 (revision >= 2)
+    u32 length;
+    u64 xsdt_address;
+    u8 extended_checksum;
+    u8 reserved[3];
+} acpi_rsdp;
+
+typedef struct __attribute__((__packed__)) {
+    char signature[4];
+    u32 length;
+    u8 revision;
+    u8 checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    u32 oem_revision;
+    u32 creator_id;
+    u32 creator_revision;
+} acpi_sdt_header;
+
+// Uses RSDP provided by bootloader or searches for it in BIOS memory if
+// `rsdp` is NULL. Returns false if ACPI tables are not available.
+bool acpi_init(paddr rsdp);
+
+// Returns (virtual) pointer to table with provided signature or NULL
+const acpi_sdt_header* acpi_find_table(const char signature[4]);
+
+#endif // SOS_ACPI_H
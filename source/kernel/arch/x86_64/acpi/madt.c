@@ -0,0 +1,154 @@
+#include "madt.h"
+#include "acpi.h"
+
+#define MADT_SIGNATURE "APIC"
+#define MADT_PCAT_COMPAT_FLAG (1 << 0)
+
+#define MADT_PROCESSOR_ENABLED_FLAG (1 << 0)
+#define MADT_PROCESSOR_ONLINE_CAPABLE_FLAG (1 << 1)
+
+typedef enum {
+    MADT_LOCAL_APIC = 0,
+    MADT_IO_APIC = 1,
+    MADT_INTERRUPT_SOURCE_OVERRIDE = 2,
+    MADT_LOCAL_APIC_ADDRESS_OVERRIDE = 5,
+    MADT_LOCAL_X2APIC = 9
+} madt_entry_type;
+
+typedef struct __attribute__((__packed__)) {
+    acpi_sdt_header header;
+    u32 lapic_address;
+    u32 flags;
+} madt;
+
+typedef struct __attribute__((__packed__)) {
+    u8 type;
+    u8 length;
+} madt_entry_header;
+
+typedef struct __attribute__((__packed__)) {
+    madt_entry_header header;
+    u8 processor_id;
+    u8 apic_id;
+    u32 flags;
+} madt_local_apic;
+
+typedef struct __attribute__((__packed__)) {
+    madt_entry_header header;
+    u8 id;
+    u8 reserved;
+    u32 address;
+    u32 gsi_base;
+} madt_io_apic;
+
+typedef struct __attribute__((__packed__)) {
+    madt_entry_header header;
+    u8 bus;
+    u8 source;
+    u32 gsi;
+    u16 flags;
+} madt_interrupt_source_override;
+
+typedef struct __attribute__((__packed__)) {
+    madt_entry_header header;
+    u16 reserved;
+    u64 address;
+} madt_local_apic_address_override;
+
+typedef struct __attribute__((__packed__)) {
+    madt_entry_header header;
+    u16 reserved;
+    u32 x2apic_id;
+    u32 flags;
+    u32 processor_uid;
+} madt_local_x2apic;
+
+static madt_info info;
+
+static void add_cpu(u32 apic_id, u32 flags) {
+    // disabled processors which are not online capable can never be started
+    bool usable = flags
+                  & (MADT_PROCESSOR_ENABLED_FLAG
+                     | MADT_PROCESSOR_ONLINE_CAPABLE_FLAG);
+
+    if (!usable || info.cpus_count >= MAX_CPUS)
+        return;
+
+    info.cpu_apic_ids[info.cpus_count++] = apic_id;
+}
+
+static void parse_entry(const madt_entry_header* entry) {
+    switch (entry->type) {
+    case MADT_LOCAL_APIC: {
+        const madt_local_apic* lapic = (const madt_local_apic*) entry;
+        add_cpu(lapic->apic_id, lapic->flags);
+        break;
+    }
+
+    case MADT_LOCAL_X2APIC: {
+        const madt_local_x2apic* x2apic = (const madt_local_x2apic*) entry;
+        add_cpu(x2apic->x2apic_id, x2apic->flags);
+        break;
+    }
+
+    case MADT_IO_APIC: {
+        const madt_io_apic* ioapic = (const madt_io_apic*) entry;
+        if (info.ioapics_count >= MADT_MAX_IOAPICS)
+            break;
+
+        info.ioapics[info.ioapics_count++] =
+            (madt_ioapic){.id = ioapic->id,
+                          .address = ioapic->address,
+                          .gsi_base = ioapic->gsi_base};
+        break;
+    }
+
+    case MADT_INTERRUPT_SOURCE_OVERRIDE: {
+        const madt_interrupt_source_override* override =
+            (const madt_interrupt_source_override*) entry;
+        if (info.overrides_count >= MADT_MAX_OVERRIDES)
+            break;
+
+        info.overrides[info.overrides_count++] =
+            (madt_override){.bus_irq = override->source,
+                            .gsi = override->gsi,
+                            .flags = override->flags};
+        break;
+    }
+
+    case MADT_LOCAL_APIC_ADDRESS_OVERRIDE: {
+        const madt_local_apic_address_override* override =
+            (const madt_local_apic_address_override*) entry;
+        info.lapic_address = override->address;
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+bool madt_init() {
+    const madt* table = (const madt*) acpi_find_table(MADT_SIGNATURE);
+    if (!table)
+        return false;
+
+    info.lapic_address = table->lapic_address;
+    info.legacy_pics_present = table->flags & MADT_PCAT_COMPAT_FLAG;
+
+    const u8* ptr = (const u8*) (table + 1);
+    const u8* end = (const u8*) table + table->header.length;
+
+    while (ptr + sizeof(madt_entry_header) <= end) {
+        const madt_entry_header* entry = (const madt_entry_header*) ptr;
+        if (entry->length < sizeof(madt_entry_header))
+            break;
+
+        parse_entry(entry);
+        ptr += entry->length;
+    }
+
+    return true;
+}
+
+const madt_info* madt_get() { return &info; }
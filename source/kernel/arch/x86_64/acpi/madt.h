@@ -0,0 +1,44 @@
+#ifndef SOS_MADT_H
+#define SOS_MADT_H
+
+#include "../../../lib/types.h"
+#include "../../../memory/memory_map.h"
+#include "../../common/smp.h"
+
+#define MADT_MAX_IOAPICS 8
+#define MADT_MAX_OVERRIDES 24
+
+typedef struct {
+    u32 id;
+    paddr address;
+    u32 gsi_base;
+} madt_ioapic;
+
+// Legacy isa irq that is connected to different global system interrupt
+typedef struct {
+    u8 bus_irq;
+    u32 gsi;
+    u16 flags;
+} madt_override;
+
+typedef struct {
+    paddr lapic_address;
+    bool legacy_pics_present;
+
+    u64 cpus_count;
+    u32 cpu_apic_ids[MAX_CPUS]; // boot cpu is not necessarily first
+
+    u64 ioapics_count;
+    madt_ioapic ioapics[MADT_MAX_IOAPICS];
+
+    u64 overrides_count;
+    madt_override overrides[MADT_MAX_OVERRIDES];
+} madt_info;
+
+// Returns false if there is no MADT, in which case system is treated as
+// uniprocessor one
+bool madt_init();
+
+const madt_info* madt_get();
+
+#endif // SOS_MADT_H
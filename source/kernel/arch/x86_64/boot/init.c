@@ -1,14 +1,22 @@
 #include "../../common/init.h"
 #include "../../../memory/physical/pmm.h"
+#include "../../../threading/percpu.h"
+#include "../../../time/clock.h"
+#include "../acpi/acpi.h"
 #include "../cpu/features.h"
 #include "../cpu/gdt.h"
 #include "../cpu/tss.h"
 #include "../interrupts/interrupts.h"
+#include "../interrupts/syscall_entry.h"
+#include "../smp/smp.h"
+#include "../timer/hpet.h"
+#include "../timer/tsc.h"
 #include "pmm_init.h"
 
 void arch_init(const multiboot_info* const mboot_info) {
-    gdt_init();
-    tss_init();
+    gdt_init(0);
+    percpu_init(0);
+    tss_init(0);
     interrupts_init();
     pmm_init(mboot_info);
 
@@ -17,4 +25,13 @@ void arch_init(const multiboot_info* const mboot_info) {
     println("");
 
     features_init();
+    syscall_entry_init();
+    acpi_init(mboot_info->acpi_rsdp);
+
+    // hpet is both clocksource and reference for tsc calibration
+    hpet_init();
+    tsc_init();
+    clock_init();
+
+    smp_boot_cpu_init();
 }
@@ -1,4 +1,7 @@
 #include "pmm_init.h"
+#include "../../../lib/alignment.h"
+#include "../../../lib/panic.h"
+#include "../../../memory/physical/page.h"
 #include "../../../memory/physical/pmm.h"
 #include "../../common/vmm.h"
 
@@ -9,6 +12,8 @@ static paddr kernel_start = NULL;
 static paddr kernel_end = NULL;
 static paddr mboot_start = NULL;
 static paddr mboot_end = NULL;
+static paddr descriptors_start = NULL;
+static paddr descriptors_end = NULL;
 
 static bool addr_inside(paddr addr, paddr start, paddr end);
 static bool frame_intersects(paddr frame, paddr start, paddr end);
@@ -19,6 +24,9 @@ static paddr find_kernel_start(const multiboot_info* mboot_info);
 static paddr find_kernel_end(const multiboot_info* mboot_info);
 static bool is_frame_available(const multiboot_info* mboot_info, paddr frame);
 static bool is_inside_module(const multiboot_info* mboot_info, paddr frame);
+static bool is_frame_usable(const multiboot_info* mboot_info, paddr frame);
+static paddr find_descriptors_location(const multiboot_info* mboot_info,
+                                       paddr memory_end, u64 size);
 static void pmm_maybe_free_frame(const multiboot_info* mboot_info, paddr frame);
 
 void pmm_init(const multiboot_info* const mboot_info) {
@@ -29,6 +37,15 @@ void pmm_init(const multiboot_info* const mboot_info) {
 
     paddr memory_end = find_end_of_memory(mboot_info);
 
+    // page descriptors table occupies first run of usable frames big enough
+    // to hold it, its frames are never handed out by pmm
+    u64 descriptors_size =
+        align_to_upper(page_descriptors_table_size(memory_end), PAGE_SIZE);
+    descriptors_start =
+        find_descriptors_location(mboot_info, memory_end, descriptors_size);
+    descriptors_end = descriptors_start + descriptors_size - 1;
+    page_descriptors_init(descriptors_start, memory_end);
+
     for (paddr frame = 0; frame < memory_end; frame += PAGE_SIZE) {
         pmm_maybe_free_frame(mboot_info, frame);
     }
@@ -50,19 +67,49 @@ static bool frame_inside(paddr frame, paddr start, paddr end) {
            && addr_inside(frame + PAGE_SIZE, start, end);
 }
 
-static void pmm_maybe_free_frame(const multiboot_info* const mboot_info,
-                                 paddr frame) {
+static bool is_frame_usable(const multiboot_info* const mboot_info,
+                            paddr frame) {
 
     frame = FRAME(frame);
     if (!is_frame_available(mboot_info, frame))
-        return;
+        return false;
     if (frame_intersects(frame, kernel_start, kernel_end))
-        return;
+        return false;
     if (frame_intersects(frame, mboot_start, mboot_end))
-        return;
+        return false;
     if (is_inside_module(mboot_info, frame))
+        return false;
+    return frame >= RESERVED_LOWER_PMEM_SIZE;
+}
+
+static paddr find_descriptors_location(const multiboot_info* const mboot_info,
+                                       paddr memory_end, u64 size) {
+
+    paddr run_start = NULL;
+    for (paddr frame = RESERVED_LOWER_PMEM_SIZE; frame < memory_end;
+         frame += PAGE_SIZE) {
+
+        if (!is_frame_usable(mboot_info, frame)) {
+            run_start = NULL;
+            continue;
+        }
+
+        if (!run_start)
+            run_start = frame;
+        if (frame + PAGE_SIZE - run_start >= size)
+            return run_start;
+    }
+
+    panic("Not enough contiguous memory for page descriptors");
+}
+
+static void pmm_maybe_free_frame(const multiboot_info* const mboot_info,
+                                 paddr frame) {
+
+    frame = FRAME(frame);
+    if (addr_inside(frame, descriptors_start, descriptors_end))
         return;
-    if (frame >= RESERVED_LOWER_PMEM_SIZE)
+    if (is_frame_usable(mboot_info, frame))
         pmm_free_frame(frame);
 }
 
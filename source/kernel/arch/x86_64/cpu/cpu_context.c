@@ -1,7 +1,13 @@
 #include "cpu_context.h"
 #include "../../../lib/kprint.h"
+#include "../../../lib/util.h"
 #include "../../common/context.h"
 #include "gdt.h"
+#include "registers.h"
+
+#define PAGE_FAULT_PRESENT_FLAG (1 << 0)
+#define PAGE_FAULT_WRITE_FLAG (1 << 1)
+#define PAGE_FAULT_INSTRUCTION_FETCH_FLAG (1 << 4)
 
 bool arch_is_userspace_context(struct cpu_context* context) {
     cpu_context* arch_context = (cpu_context*) context;
@@ -50,6 +56,29 @@ u64 arch_get_instruction_pointer(struct cpu_context* context) {
     return ((cpu_context*) context)->rip;
 }
 
+void arch_set_instruction_pointer(struct cpu_context* context, u64 ip) {
+    ((cpu_context*) context)->rip = ip;
+}
+
+vaddr arch_get_page_fault_address(struct cpu_context* context) {
+    UNUSED(context);
+    return get_cr2();
+}
+
+bool arch_is_page_fault_on_write(struct cpu_context* context) {
+    return ((cpu_context*) context)->error_code & PAGE_FAULT_WRITE_FLAG ? true
+                                                                       : false;
+}
+
+bool arch_is_page_fault_on_present_page(struct cpu_context* context) {
+    return ((cpu_context*) context)->error_code & PAGE_FAULT_PRESENT_FLAG;
+}
+
+bool arch_is_page_fault_on_instruction_fetch(struct cpu_context* context) {
+    return ((cpu_context*) context)->error_code
+           & PAGE_FAULT_INSTRUCTION_FETCH_FLAG;
+}
+
 void arch_clone_cpu_context(struct cpu_context* src, struct cpu_context* dst) {
     *((cpu_context*) dst) = *((cpu_context*) src);
 }
\ No newline at end of file
@@ -6,3 +6,11 @@ void cpuid(u32 reg, u32* eax, u32* ebx, u32* ecx, u32* edx) {
                      : "0"(reg)
                      : "memory");
 }
+
+void cpuid_subleaf(u32 reg, u32 subleaf, u32* eax, u32* ebx, u32* ecx,
+                   u32* edx) {
+    __asm__ volatile("cpuid"
+                     : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                     : "0"(reg), "2"(subleaf)
+                     : "memory");
+}
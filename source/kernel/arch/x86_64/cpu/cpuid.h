@@ -5,11 +5,25 @@
 
 #define CPUID_VENDOR 0x00000000
 #define CPUID_FEATURES 0x00000001
+#define CPUID_STRUCTURED_EXT_FEATURES 0x00000007
+#define CPUID_XSAVE 0x0000000D
+#define CPUID_TSC_FREQUENCY 0x00000015
+#define CPUID_PROCESSOR_FREQUENCY 0x00000016
 #define CPUID_EXT_VENDOR 0x80000000
 #define CPUID_EXT_FEATURES 0x80000001
+#define CPUID_EXT_POWER_MANAGEMENT 0x80000007
 
 #define CPUID_EXECUTE_DISABLE_FEATURE_OFFSET 20
+#define CPUID_X2APIC_FEATURE_OFFSET 21
+#define CPUID_TSC_DEADLINE_FEATURE_OFFSET 24
+#define CPUID_INVARIANT_TSC_FEATURE_OFFSET 8
+#define CPUID_FSGSBASE_FEATURE_OFFSET 0
+#define CPUID_XSAVE_FEATURE_OFFSET 26
+#define CPUID_XSAVEOPT_FEATURE_OFFSET 0
 
 void cpuid(u32 reg, u32* eax, u32* ebx, u32* ecx, u32* edx);
+// For leaves which are split into subleafs selected by ecx
+void cpuid_subleaf(u32 reg, u32 subleaf, u32* eax, u32* ebx, u32* ecx,
+                   u32* edx);
 
 #endif // SOS_CPUID_H
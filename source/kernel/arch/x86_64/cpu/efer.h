@@ -4,6 +4,8 @@
 #include "../../../lib/types.h"
 
 #define EFER_SYSCALL_ENABLE 0x00000001
+#define EFER_LONG_MODE_ENABLE 0x00000100
+#define EFER_LONG_MODE_ACTIVE 0x00000400
 #define EFER_NX_ENABLE 0x00000800
 
 u64 efer_read();
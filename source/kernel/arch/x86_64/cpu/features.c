@@ -1,8 +1,11 @@
 #include "features.h"
 #include "cpuid.h"
 #include "efer.h"
+#include "fpu.h"
+#include "registers.h"
 
 static bool execute_disable_supported;
+static bool fsgsbase_supported;
 
 void features_init() {
     u32 eax;
@@ -16,6 +19,22 @@ void features_init() {
 
     if (execute_disable_supported)
         efer_write(efer_read() | EFER_NX_ENABLE);
+
+    // Make kernel respect read-only user pages, otherwise it could silently
+    // write through shared frames (e.g. zero page)
+    set_cr0(get_cr0() | CR0_WRITE_PROTECT_FLAG);
+
+    cpuid_subleaf(CPUID_STRUCTURED_EXT_FEATURES, 0, &eax, &ebx, &ecx, &edx);
+    fsgsbase_supported = (ebx >> CPUID_FSGSBASE_FEATURE_OFFSET) & 1;
+
+    // Lets both kernel and user space switch fs and gs bases without msr
+    // access, so both of them are kept per thread
+    if (fsgsbase_supported)
+        set_cr4(get_cr4() | CR4_FSGSBASE_FLAG);
+
+    fpu_init();
 }
 
-bool features_execute_disable_supported() { return execute_disable_supported; }
\ No newline at end of file
+bool features_execute_disable_supported() { return execute_disable_supported; }
+
+bool features_fsgsbase_supported() { return fsgsbase_supported; }
\ No newline at end of file
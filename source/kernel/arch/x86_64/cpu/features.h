@@ -6,5 +6,6 @@
 void features_init();
 
 bool features_execute_disable_supported();
+bool features_fsgsbase_supported();
 
 #endif // SOS_FEATURES_H
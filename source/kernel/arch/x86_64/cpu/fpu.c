@@ -0,0 +1,254 @@
+#include "fpu.h"
+#include "../../../interrupts/irq.h"
+#include "../../../lib/memory_util.h"
+#include "../../../lib/panic.h"
+#include "../../../lib/util.h"
+#include "../../../memory/heap/kheap.h"
+#include "../../../threading/scheduler.h"
+#include "../../../threading/thread.h"
+#include "../../common/context.h"
+#include "../../common/fpu.h"
+#include "cpuid.h"
+#include "registers.h"
+
+// State components kept per thread: x87, sse, avx and avx-512
+#define XFEATURE_X87 (1 << 0)
+#define XFEATURE_SSE (1 << 1)
+#define XFEATURE_AVX (1 << 2)
+#define XFEATURE_AVX512 (0b111 << 5)
+#define XFEATURES_WANTED                                                       \
+    (XFEATURE_X87 | XFEATURE_SSE | XFEATURE_AVX | XFEATURE_AVX512)
+
+#define XCR0 0
+
+#define FXSAVE_AREA_SIZE 512
+#define XSAVE_HEADER_OFFSET FXSAVE_AREA_SIZE
+#define XSAVE_HEADER_SIZE 64
+
+#define FCW_OFFSET 0
+#define MXCSR_OFFSET 24
+#define MXCSR_MASK_OFFSET 28
+
+#define FCW_DEFAULT 0x37F
+#define MXCSR_DEFAULT 0x1F80
+#define MXCSR_MASK_DEFAULT 0xFFBF
+
+static bool xsave_supported;
+static bool xsaveopt_supported;
+static u64 xfeatures; // enabled in xcr0
+static u64 state_size;
+static u32 mxcsr_mask;
+
+static void xsetbv(u32 reg, u64 value) {
+    __asm__ volatile("xsetbv"
+                     :
+                     : "c"(reg), "a"((u32) value), "d"((u32) (value >> 32)));
+}
+
+static void clts() { __asm__ volatile("clts"); }
+
+static void stts() { set_cr0(get_cr0() | CR0_TASK_SWITCHED_FLAG); }
+
+// xsaveopt skips components that are in initial state or weren't modified
+// since they were restored from the same area
+static void save(void* state) {
+    u32 low = (u32) xfeatures;
+    u32 high = (u32) (xfeatures >> 32);
+
+    if (xsaveopt_supported)
+        __asm__ volatile("xsaveopt64 (%0)"
+                         :
+                         : "r"(state), "a"(low), "d"(high)
+                         : "memory");
+    else if (xsave_supported)
+        __asm__ volatile("xsave64 (%0)"
+                         :
+                         : "r"(state), "a"(low), "d"(high)
+                         : "memory");
+    else
+        __asm__ volatile("fxsave64 (%0)" : : "r"(state) : "memory");
+}
+
+static void restore(const void* state) {
+    u32 low = (u32) xfeatures;
+    u32 high = (u32) (xfeatures >> 32);
+
+    if (xsave_supported)
+        __asm__ volatile("xrstor64 (%0)"
+                         :
+                         : "r"(state), "a"(low), "d"(high)
+                         : "memory");
+    else
+        __asm__ volatile("fxrstor64 (%0)" : : "r"(state) : "memory");
+}
+
+static void detect_mxcsr_mask() {
+    u8 legacy_area[FXSAVE_AREA_SIZE] __attribute__((aligned(16)));
+    memset(legacy_area, 0, FXSAVE_AREA_SIZE);
+    __asm__ volatile("fninit\n"
+                     "fxsave64 (%0)"
+                     :
+                     : "r"(legacy_area)
+                     : "memory");
+
+    mxcsr_mask = *(u32*) (legacy_area + MXCSR_MASK_OFFSET);
+    if (!mxcsr_mask)
+        mxcsr_mask = MXCSR_MASK_DEFAULT;
+}
+
+void fpu_init() {
+    u32 eax;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+    cpuid(CPUID_FEATURES, &eax, &ebx, &ecx, &edx);
+    xsave_supported = (ecx >> CPUID_XSAVE_FEATURE_OFFSET) & 1;
+
+    u64 cr0 = get_cr0() & ~(CR0_EMULATION_FLAG | CR0_TASK_SWITCHED_FLAG);
+    set_cr0(cr0 | CR0_MONITOR_COPROCESSOR_FLAG | CR0_NUMERIC_ERROR_FLAG);
+
+    u64 cr4 = get_cr4() | CR4_OSFXSR_FLAG | CR4_OSXMMEXCPT_FLAG;
+    set_cr4(xsave_supported ? cr4 | CR4_OSXSAVE_FLAG : cr4);
+
+    state_size = FXSAVE_AREA_SIZE;
+    if (xsave_supported) {
+        cpuid_subleaf(CPUID_XSAVE, 0, &eax, &ebx, &ecx, &edx);
+        xfeatures = (((u64) edx << 32) | eax) & XFEATURES_WANTED;
+        xsetbv(XCR0, xfeatures);
+
+        // ebx reports area size for features currently enabled in xcr0
+        cpuid_subleaf(CPUID_XSAVE, 0, &eax, &ebx, &ecx, &edx);
+        state_size = ebx;
+
+        cpuid_subleaf(CPUID_XSAVE, 1, &eax, &ebx, &ecx, &edx);
+        xsaveopt_supported = (eax >> CPUID_XSAVEOPT_FEATURE_OFFSET) & 1;
+    }
+
+    detect_mxcsr_mask();
+
+    // registers don't hold state of any thread yet
+    stts();
+}
+
+u64 fpu_state_size() { return state_size; }
+
+void fpu_save(thread* thread) {
+    if (thread->fpu_loaded)
+        save(thread->fpu_state);
+}
+
+void fpu_drop(thread* thread) {
+    if (thread->fpu_loaded) {
+        thread->fpu_loaded = false;
+        stts();
+    }
+}
+
+// xrstor faults on reserved mxcsr bits, unknown components and compacted or
+// otherwise malformed header
+bool fpu_state_valid(thread* thread) {
+    const u8* state = thread->fpu_state;
+    if (*(const u32*) (state + MXCSR_OFFSET) & ~mxcsr_mask)
+        return false;
+    if (!xsave_supported)
+        return true;
+
+    const u64* header = (const u64*) (state + XSAVE_HEADER_OFFSET);
+    if (header[0] & ~xfeatures)
+        return false;
+
+    for (u64 i = 1; i < XSAVE_HEADER_SIZE / sizeof(u64); i++) {
+        if (header[i])
+            return false;
+    }
+
+    return true;
+}
+
+struct cpu_context* handle_device_not_available(struct cpu_context* context) {
+    thread* current = get_current_thread();
+    if (!current || current->kernel_thread
+        || !arch_is_userspace_context(context)) {
+
+        arch_print_cpu_context(context);
+        panic("Fpu used inside kernel outside of kernel_fpu_begin/end");
+    }
+
+    clts();
+    restore(current->fpu_state);
+    current->fpu_loaded = true;
+
+    return context;
+}
+
+struct cpu_context* handle_fpu_exception(struct cpu_context* context) {
+    thread* current = get_current_thread();
+    if (!current || current->kernel_thread
+        || !arch_is_userspace_context(context)) {
+
+        arch_print_cpu_context(context);
+        panic("Fpu exception inside kernel");
+    }
+
+    thread_signal(current, SIGFPE);
+    return context;
+}
+
+void* arch_fpu_state_alloc() {
+    u8* area = kmalloc_aligned(FPU_STATE_HEADROOM + state_size,
+                               FPU_STATE_ALIGNMENT);
+    if (!area)
+        return NULL;
+
+    u8* state = area + FPU_STATE_HEADROOM;
+
+    // zeroed xsave header marks every component as being in initial state,
+    // only control words are always loaded from legacy area
+    memset(state, 0, state_size);
+    *(u16*) (state + FCW_OFFSET) = FCW_DEFAULT;
+    *(u32*) (state + MXCSR_OFFSET) = MXCSR_DEFAULT;
+
+    return state;
+}
+
+void arch_fpu_state_free(void* state) {
+    kfree((u8*) state - FPU_STATE_HEADROOM);
+}
+
+void arch_fpu_switch(thread* prev, thread* next) {
+    UNUSED(next);
+
+    if (!prev || !prev->fpu_loaded)
+        return;
+
+    save(prev->fpu_state);
+    prev->fpu_loaded = false;
+    stts();
+}
+
+bool kernel_fpu_begin() {
+    bool interrupts_enabled = local_irq_save();
+
+    thread* current = get_current_thread();
+    if (current && current->fpu_loaded) {
+        save(current->fpu_state);
+        current->fpu_loaded = false;
+    }
+
+    clts();
+    return interrupts_enabled;
+}
+
+// User state is restored lazily, same as after thread switch
+void kernel_fpu_end(bool interrupts_enabled) {
+    stts();
+    local_irq_restore(interrupts_enabled);
+}
+
+bool kernel_fpu_usable() { return get_cr4() & CR4_OSFXSR_FLAG; }
+
+void arch_fpu_clone(thread* dst) {
+    thread* current = get_current_thread();
+    fpu_save(current);
+    memcpy(dst->fpu_state, current->fpu_state, state_size);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef SOS_FPU_H
+#define SOS_FPU_H
+
+#include "../../../lib/types.h"
+
+struct _thread;
+struct cpu_context;
+
+// Xsave requires 64 byte aligned area, fxsave 16 byte aligned one
+#define FPU_STATE_ALIGNMENT 64
+
+// Every state area is allocated with this much room in front of it, so that
+// signal frame can be assembled next to the state and copied to user at once
+#define FPU_STATE_HEADROOM 192
+
+void fpu_init();
+
+u64 fpu_state_size();
+
+// Saves registers to area of thread, if they hold its state. Registers stay
+// loaded.
+void fpu_save(struct _thread* thread);
+
+// Forgets state held in registers, so that area of thread can be replaced.
+// Area is loaded on next fpu instruction.
+void fpu_drop(struct _thread* thread);
+
+// Area which came from user must be checked before it reaches xrstor
+bool fpu_state_valid(struct _thread* thread);
+
+// #NM, raised on fpu instruction while cr0.ts is set
+struct cpu_context* handle_device_not_available(struct cpu_context* context);
+
+// #MF and #XM, raised on unmasked x87 or simd floating point exception
+struct cpu_context* handle_fpu_exception(struct cpu_context* context);
+
+#endif // SOS_FPU_H
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "gdt.h"
+#include "../../common/smp.h"
 #include "privilege_level.h"
 #include "tss.h"
 
@@ -38,8 +39,9 @@ const u8 BUSY_OFFSET = 1;
 const u8 ACCESSED_OFFSET = 0;
 
 // 6 segments, last is tss which occupies two entries
-segment_descriptor gdt_data[7];
-const gdt_descriptor gdt = {.data = gdt_data, .limit = sizeof(gdt_data) - 1};
+#define GDT_ENTRIES 7
+
+static segment_descriptor cpus_gdt_data[MAX_CPUS][GDT_ENTRIES];
 
 u8 gen_code_segment_descriptor_8_15_flags(bit present, privilege_level dpl,
                                           bit conforming, bit read_enabled,
@@ -163,7 +165,11 @@ u16 USER_CODE_SEGMENT_SELECTOR;
 u16 USER_DATA_SEGMENT_SELECTOR;
 u16 TSS_SEGMENT_SELECTOR;
 
-void gdt_init(void) {
+void gdt_init(u64 cpu) {
+    segment_descriptor* gdt_data = cpus_gdt_data[cpu];
+    const gdt_descriptor gdt = {.data = gdt_data,
+                                .limit = sizeof(cpus_gdt_data[cpu]) - 1};
+
     gdt_data[0] = gen_null_segment_decriptor();
 
     // in long mode default operation size flag should be zero, base and limits
@@ -172,17 +178,19 @@ void gdt_init(void) {
         gen_code_segment_descriptor(0, 0xFFFFF, 1, 0, 1, 1, 1, PL_0, 0, 0, 0);
     gdt_data[2] =
         gen_data_segment_descriptor(0, 0xFFFFF, 1, 0, 1, 1, 1, PL_0, 0, 1, 0);
+    // sysret takes user ss and cs from two entries following kernel data
+    // segment, so user data segment goes first
     gdt_data[3] =
-        gen_code_segment_descriptor(0, 0xFFFFF, 1, 0, 1, 0, 1, PL_3, 0, 0, 0);
-    gdt_data[4] =
         gen_data_segment_descriptor(0, 0xFFFFF, 1, 0, 1, 0, 1, PL_3, 0, 1, 0);
+    gdt_data[4] =
+        gen_code_segment_descriptor(0, 0xFFFFF, 1, 0, 1, 0, 1, PL_3, 0, 0, 0);
     *(tss_segment_descriptor*) &gdt_data[5] =
-        gen_task_state_segment_descriptor(&tss, PL_0);
+        gen_task_state_segment_descriptor(tss_of(cpu), PL_0);
 
     KERNEL_CODE_SEGMENT_SELECTOR = gen_segment_selector(1, PL_0);
     KERNEL_DATA_SEGMENT_SELECTOR = gen_segment_selector(2, PL_0);
-    USER_CODE_SEGMENT_SELECTOR = gen_segment_selector(3, PL_3);
-    USER_DATA_SEGMENT_SELECTOR = gen_segment_selector(4, PL_3);
+    USER_DATA_SEGMENT_SELECTOR = gen_segment_selector(3, PL_3);
+    USER_CODE_SEGMENT_SELECTOR = gen_segment_selector(4, PL_3);
     TSS_SEGMENT_SELECTOR = gen_segment_selector(5, PL_0);
 
     __asm__ volatile("    lgdt %0\n"
@@ -9,6 +9,7 @@ extern u16 USER_CODE_SEGMENT_SELECTOR;
 extern u16 USER_DATA_SEGMENT_SELECTOR;
 extern u16 TSS_SEGMENT_SELECTOR;
 
-void gdt_init(void);
+// Loads gdt of provided cpu, each cpu has its own copy because of tss
+void gdt_init(u64 cpu);
 
 #endif // GDT_H
@@ -1,5 +1,9 @@
 #include "../../common/idle.h"
+#include "../smp/smp.h"
 
-void pause() { __asm__ volatile("pause"); }
+void pause() {
+    smp_handle_tlb_flush_request();
+    __asm__ volatile("pause");
+}
 
 void halt() { __asm__ volatile("hlt"); }
\ No newline at end of file
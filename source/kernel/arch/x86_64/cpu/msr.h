@@ -2,6 +2,10 @@
 #ifndef SOS_MSR_H
 #define SOS_MSR_H
 
+// Holds user gs base while in kernel and per cpu area pointer while in user
+// space, swapgs exchanges it with gs base
+#define KERNEL_GS_BASE_MSR 0xC0000102
+
 u64 msr_read(u32 reg);
 void msr_write(u32 msr, u64 value);
 
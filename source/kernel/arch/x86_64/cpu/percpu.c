@@ -0,0 +1,12 @@
+#include "../../common/percpu.h"
+#include "msr.h"
+
+#define GS_BASE_MSR 0xC0000101
+
+// While in kernel, gs base points to per cpu area. Interrupt stubs do swapgs
+// when entering from or returning to user space, so user gs base is kept in
+// KERNEL_GS_BASE msr meanwhile.
+void arch_percpu_set(struct percpu* area) {
+    msr_write(GS_BASE_MSR, (u64) area);
+    msr_write(KERNEL_GS_BASE_MSR, 0);
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef SOS_X86_64_PERCPU_H
+#define SOS_X86_64_PERCPU_H
+
+#include "../../../lib/types.h"
+
+// Field of current cpu area as gs relative memory operand, offsets are
+// compile time constants, so every accessor is one instruction with
+// displacement and no call
+#define GS_FIELD(offset) (*(u64 __seg_gs*) (offset))
+
+static inline u64 arch_this_cpu_read(u64 offset) {
+    u64 value;
+    __asm__ volatile("movq %1, %0" : "=r"(value) : "m"(GS_FIELD(offset)));
+    return value;
+}
+
+static inline void arch_this_cpu_write(u64 offset, u64 value) {
+    __asm__ volatile("movq %1, %0"
+                     : "=m"(GS_FIELD(offset))
+                     : "er"(value)
+                     : "memory");
+}
+
+static inline void arch_this_cpu_add(u64 offset, u64 value) {
+    __asm__ volatile("addq %1, %0"
+                     : "+m"(GS_FIELD(offset))
+                     : "er"(value)
+                     : "memory");
+}
+
+#endif // SOS_X86_64_PERCPU_H
\ No newline at end of file
@@ -1,8 +1,39 @@
 #include "registers.h"
 
+u64 get_cr0() {
+    u64 cr0;
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0) : : "memory");
+
+    return cr0;
+}
+
+void set_cr0(u64 cr0) { __asm__ volatile("mov %0, %%cr0" : : "r"(cr0)); }
+
 u64 get_cr2() {
     u64 cr2;
     __asm__ volatile("mov %%cr2, %0" : "=rm"(cr2) : : "memory");
 
     return cr2;
+}
+
+u64 get_cr3() {
+    u64 cr3;
+    __asm__ volatile("mov %%cr3, %0" : "=r"(cr3) : : "memory");
+
+    return cr3;
+}
+
+void set_cr3(u64 cr3) {
+    __asm__ volatile("mov %0, %%cr3" : : "r"(cr3) : "memory");
+}
+
+u64 get_cr4() {
+    u64 cr4;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4) : : "memory");
+
+    return cr4;
+}
+
+void set_cr4(u64 cr4) {
+    __asm__ volatile("mov %0, %%cr4" : : "r"(cr4) : "memory");
 }
\ No newline at end of file
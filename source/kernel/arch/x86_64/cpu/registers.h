@@ -3,6 +3,26 @@
 
 #include "../../../lib/types.h"
 
+#define CR0_MONITOR_COPROCESSOR_FLAG (1 << 1)
+#define CR0_EMULATION_FLAG (1 << 2)
+#define CR0_TASK_SWITCHED_FLAG (1 << 3)
+#define CR0_NUMERIC_ERROR_FLAG (1 << 5)
+#define CR0_WRITE_PROTECT_FLAG (1 << 16)
+
+#define CR4_OSFXSR_FLAG (1 << 9)
+#define CR4_OSXMMEXCPT_FLAG (1 << 10)
+#define CR4_FSGSBASE_FLAG (1 << 16)
+#define CR4_OSXSAVE_FLAG (1 << 18)
+
+u64 get_cr0();
+void set_cr0(u64 cr0);
+
 u64 get_cr2();
 
+u64 get_cr3();
+void set_cr3(u64 cr3);
+
+u64 get_cr4();
+void set_cr4(u64 cr4);
+
 #endif // SOS_REGISTERS_H
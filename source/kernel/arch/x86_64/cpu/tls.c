@@ -0,0 +1,32 @@
+#include "../../common/tls.h"
+#include "features.h"
+#include "msr.h"
+
+#define FS_BASE_MSR 0xC0000100
+
+// fs base instructions are much cheaper than msr access, but need cr4 bit
+u64 arch_tls_read() {
+    if (!features_fsgsbase_supported())
+        return msr_read(FS_BASE_MSR);
+
+    u64 base;
+    __asm__ volatile("rdfsbase %0" : "=r"(base));
+    return base;
+}
+
+void arch_tls_write(u64 base) {
+    if (!features_fsgsbase_supported()) {
+        msr_write(FS_BASE_MSR, base);
+        return;
+    }
+
+    __asm__ volatile("wrfsbase %0" : : "r"(base) : "memory");
+}
+
+// Kernel runs with per cpu area in gs base, so user one is accessed where
+// swapgs has put it
+u64 arch_tls_aux_read() { return msr_read(KERNEL_GS_BASE_MSR); }
+
+void arch_tls_aux_write(u64 base) { msr_write(KERNEL_GS_BASE_MSR, base); }
+
+bool arch_tls_user_writable() { return features_fsgsbase_supported(); }
\ No newline at end of file
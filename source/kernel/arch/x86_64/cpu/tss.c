@@ -1,24 +1,31 @@
 #include "tss.h"
 #include "../../../lib/memory_util.h"
+#include "../../../threading/percpu.h"
 #include "../../../threading/scheduler.h"
 #include "gdt.h"
 
-task_state_segment tss;
+static task_state_segment cpus_tss[MAX_CPUS];
 
-void tss_init() {
-    memset(&tss, 0, sizeof(task_state_segment));
+task_state_segment* tss_of(u64 cpu) { return &cpus_tss[cpu]; }
+
+void tss_init(u64 cpu) {
+    memset(&cpus_tss[cpu], 0, sizeof(task_state_segment));
+    this_cpu_write(tss, &cpus_tss[cpu]);
 
     __asm__ volatile("ltr %0" : : "r"((u16) TSS_SEGMENT_SELECTOR));
 }
 
 void tss_update_rsp(u64 rsp) {
-    tss.rsp0_low = rsp & 0xFFFFFFFF;
-    tss.rsp0_high = (rsp >> 32) & 0xFFFFFFFF;
+    task_state_segment* tss = this_cpu_read(tss);
+    tss->rsp0_low = rsp & 0xFFFFFFFF;
+    tss->rsp0_high = (rsp >> 32) & 0xFFFFFFFF;
 }
 
 void update_tss() {
     thread* current = get_current_thread();
     if (current) {
-        tss_update_rsp((u64) current->kernel_stack + THREAD_KERNEL_STACK_SIZE);
+        u64 stack = (u64) current->kernel_stack + THREAD_KERNEL_STACK_SIZE;
+        tss_update_rsp(stack);
+        this_cpu_write(kernel_stack, stack);
     }
 }
@@ -31,8 +31,10 @@ typedef struct __attribute__((__packed__)) {
     u16 iopb;
 } task_state_segment;
 
-extern task_state_segment tss;
+// Each cpu has its own tss, since it holds stack of thread running on it
+task_state_segment* tss_of(u64 cpu);
 
-void tss_init();
+// Loads tss of provided cpu, should be called after gdt_init and percpu_init
+void tss_init(u64 cpu);
 
 #endif // SOS_TSS_H
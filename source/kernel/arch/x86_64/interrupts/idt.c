@@ -325,5 +325,7 @@ void idt_init(void) {
     SET_KERNEL_ISR(254);
     SET_KERNEL_ISR(255);
 
-    __asm__ volatile("lidt %0" : : "m"(idt));
-}
\ No newline at end of file
+    idt_load();
+}
+
+void idt_load(void) { __asm__ volatile("lidt %0" : : "m"(idt)); }
\ No newline at end of file
@@ -9,5 +9,7 @@ extern const u16 SLAVE_PIC_COMMAND_ADDR;
 extern const u16 SLAVE_PIC_DATA_ADDR;
 
 void idt_init(void);
+// Loads already initialized idt on current cpu
+void idt_load(void);
 
 #endif // IDT_H
@@ -3,6 +3,7 @@
 #include "../../../syscall/syscall.h"
 #include "../../../time/timer.h"
 #include "../cpu/cpu_context.h"
+#include "../cpu/fpu.h"
 #include "../timer/pit.h"
 #include "idt.h"
 #include "isrs.h"
@@ -24,7 +25,10 @@ void interrupts_init() {
     pit_init();
     pic_init();
 
+    mount_exception_handler(7, handle_device_not_available);
     mount_exception_handler(14, handle_page_fault);
+    mount_exception_handler(16, handle_fpu_exception);
+    mount_exception_handler(19, handle_fpu_exception);
 
     mount_irq_handler(32, handle_timer_interrupt);
     mount_irq_handler(128, syscall_trampoline);
@@ -0,0 +1,206 @@
+#include "ioapic.h"
+#include "../../../lib/kprint.h"
+#include "../../../lib/util.h"
+#include "../../../memory/memory_map.h"
+#include "../../../synchronization/spin_lock.h"
+#include "../acpi/madt.h"
+#include "../smp/smp.h"
+#include "isrs.h"
+#include "lapic.h"
+#include "pic.h"
+
+#define IOAPIC_REGSEL 0x00
+#define IOAPIC_WINDOW 0x10
+
+#define IOAPIC_VERSION 0x01
+#define IOAPIC_REDIRECTION_TABLE 0x10
+
+#define IOAPIC_MAX_REDIRECTION_OFFSET 16
+
+#define REDIRECTION_ACTIVE_LOW (1 << 13)
+#define REDIRECTION_LEVEL_TRIGGERED (1 << 15)
+#define REDIRECTION_MASKED (1 << 16)
+#define REDIRECTION_DESTINATION_OFFSET 56
+
+// Io apic accepts only 8 bit physical destination without interrupt remapping
+#define MAX_DESTINATION_APIC_ID 0xFF
+
+// MPS INTI flags of interrupt source overrides
+#define INTI_POLARITY_MASK 0b11
+#define INTI_POLARITY_ACTIVE_LOW 0b11
+#define INTI_TRIGGER_MASK (0b11 << 2)
+#define INTI_TRIGGER_LEVEL (0b11 << 2)
+
+typedef struct {
+    volatile u32* base;
+    u32 gsi_base;
+    u32 redirections_count;
+} ioapic;
+
+// Where legacy isa irq is wired to
+typedef struct {
+    ioapic* apic;
+    u32 pin;
+    u64 redirection; // redirection entry without mask bit
+    bool connected;
+    bool masked;
+} irq_route;
+
+static ioapic ioapics[MADT_MAX_IOAPICS];
+static u64 ioapics_count = 0;
+
+static irq_route routes[HARD_IRQS_COUNT];
+
+// Register window is shared by all cpus, so select and access should be atomic
+static lock ioapic_lock = SPIN_LOCK_STATIC_INITIALIZER;
+
+static u32 ioapic_read(ioapic* apic, u32 reg) {
+    apic->base[IOAPIC_REGSEL / 4] = reg;
+    return apic->base[IOAPIC_WINDOW / 4];
+}
+
+static void ioapic_write(ioapic* apic, u32 reg, u32 value) {
+    apic->base[IOAPIC_REGSEL / 4] = reg;
+    apic->base[IOAPIC_WINDOW / 4] = value;
+}
+
+// High half is written first, so that entry is never unmasked with stale
+// destination
+static void write_redirection(ioapic* apic, u32 pin, u64 entry) {
+    u32 reg = IOAPIC_REDIRECTION_TABLE + pin * 2;
+    ioapic_write(apic, reg, REDIRECTION_MASKED);
+    ioapic_write(apic, reg + 1, entry >> 32);
+    ioapic_write(apic, reg, (u32) entry);
+}
+
+static ioapic* ioapic_of_gsi(u32 gsi) {
+    for (u64 i = 0; i < ioapics_count; i++) {
+        ioapic* apic = &ioapics[i];
+        if (gsi >= apic->gsi_base
+            && gsi < apic->gsi_base + apic->redirections_count)
+            return apic;
+    }
+
+    return NULL;
+}
+
+static void route_irq(const madt_info* madt, u8 irq, u32 destination) {
+    // isa irqs are edge triggered and active high, unless overridden
+    u32 gsi = irq;
+    u16 flags = 0;
+    for (u64 i = 0; i < madt->overrides_count; i++) {
+        if (madt->overrides[i].bus_irq == irq) {
+            gsi = madt->overrides[i].gsi;
+            flags = madt->overrides[i].flags;
+        }
+    }
+
+    ioapic* apic = ioapic_of_gsi(gsi);
+    if (!apic)
+        return;
+
+    u64 redirection = HARD_IRQ_VECTOR_BASE + irq;
+    if ((flags & INTI_POLARITY_MASK) == INTI_POLARITY_ACTIVE_LOW)
+        redirection |= REDIRECTION_ACTIVE_LOW;
+    if ((flags & INTI_TRIGGER_MASK) == INTI_TRIGGER_LEVEL)
+        redirection |= REDIRECTION_LEVEL_TRIGGERED;
+    redirection |= (u64) destination << REDIRECTION_DESTINATION_OFFSET;
+
+    routes[irq] = (irq_route){.apic = apic,
+                              .pin = gsi - apic->gsi_base,
+                              .redirection = redirection,
+                              .connected = true,
+                              .masked = true};
+}
+
+bool ioapic_init() {
+    const madt_info* madt = madt_get();
+    if (!madt->ioapics_count || !lapic_available())
+        return false;
+
+    u32 destination = lapic_id();
+    if (destination > MAX_DESTINATION_APIC_ID) {
+        println("Boot cpu apic id doesn't fit io apic, keeping 8259");
+        return false;
+    }
+
+    for (u64 i = 0; i < madt->ioapics_count; i++) {
+        ioapic* apic = &ioapics[ioapics_count++];
+        apic->base = (volatile u32*) P2V(madt->ioapics[i].address);
+        apic->gsi_base = madt->ioapics[i].gsi_base;
+
+        u32 version = ioapic_read(apic, IOAPIC_VERSION);
+        apic->redirections_count =
+            ((version >> IOAPIC_MAX_REDIRECTION_OFFSET) & 0xFF) + 1;
+
+        for (u32 pin = 0; pin < apic->redirections_count; pin++) {
+            write_redirection(apic, pin, REDIRECTION_MASKED);
+        }
+    }
+
+    pic_disable();
+
+    for (u8 irq = 0; irq < HARD_IRQS_COUNT; irq++) {
+        route_irq(madt, irq, destination);
+    }
+
+    irq_chip_set(&ioapic_chip);
+
+    // 8259 delivered every line, keep it that way, except for cascade line
+    // which never fires
+    for (u8 irq = 0; irq < HARD_IRQS_COUNT; irq++) {
+        if (irq != 2)
+            irq_unmask(irq);
+    }
+
+    return true;
+}
+
+static void set_masked(u8 irq, bool masked) {
+    irq_route* route = &routes[irq];
+    if (!route->connected)
+        return;
+
+    bool interrupts_enabled = spin_lock_irq_save(&ioapic_lock);
+    route->masked = masked;
+    u64 entry = route->redirection | (masked ? REDIRECTION_MASKED : 0);
+    write_redirection(route->apic, route->pin, entry);
+    spin_unlock_irq_restore(&ioapic_lock, interrupts_enabled);
+}
+
+static void ioapic_mask(u8 irq) { set_masked(irq, true); }
+
+static void ioapic_unmask(u8 irq) { set_masked(irq, false); }
+
+// Io apic needs no acknowledge, level triggered lines are re-armed by
+// local apic eoi broadcast
+static void ioapic_eoi(u8 irq) {
+    UNUSED(irq);
+    lapic_eoi();
+}
+
+static bool ioapic_set_affinity(u8 irq, u64 cpu) {
+    irq_route* route = &routes[irq];
+    if (!route->connected || cpu >= arch_cpus_count())
+        return false;
+
+    u32 destination = smp_cpu_apic_id(cpu);
+    if (destination > MAX_DESTINATION_APIC_ID)
+        return false;
+
+    bool interrupts_enabled = spin_lock_irq_save(&ioapic_lock);
+    route->redirection &= ~((u64) 0xFF << REDIRECTION_DESTINATION_OFFSET);
+    route->redirection |= (u64) destination << REDIRECTION_DESTINATION_OFFSET;
+
+    u64 entry = route->redirection | (route->masked ? REDIRECTION_MASKED : 0);
+    write_redirection(route->apic, route->pin, entry);
+    spin_unlock_irq_restore(&ioapic_lock, interrupts_enabled);
+
+    return true;
+}
+
+const irq_chip ioapic_chip = {.name = "io apic",
+                              .mask = ioapic_mask,
+                              .unmask = ioapic_unmask,
+                              .eoi = ioapic_eoi,
+                              .set_affinity = ioapic_set_affinity};
\ No newline at end of file
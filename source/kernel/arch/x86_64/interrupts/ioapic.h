@@ -0,0 +1,15 @@
+#ifndef SOS_IOAPIC_H
+#define SOS_IOAPIC_H
+
+#include "../../../interrupts/irq_chip.h"
+#include "../../../lib/types.h"
+
+// Programs redirection tables of all io apics listed in MADT, so that legacy
+// isa irqs are delivered to boot cpu through local apic, then masks 8259 and
+// makes io apic current irq chip. Local apic of boot cpu should be set up.
+// Returns false if there are no io apics, legacy pic is kept in that case.
+bool ioapic_init();
+
+extern const irq_chip ioapic_chip;
+
+#endif // SOS_IOAPIC_H
\ No newline at end of file
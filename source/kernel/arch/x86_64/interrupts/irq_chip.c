@@ -0,0 +1,17 @@
+#include "../../../interrupts/irq_chip.h"
+#include "pic.h"
+
+// Legacy pic is used until apics are set up, or if there are none
+static const irq_chip* current_chip = &pic_chip;
+
+void irq_chip_set(const irq_chip* chip) { current_chip = chip; }
+
+const irq_chip* irq_chip_get() { return current_chip; }
+
+void irq_mask(u8 irq) { current_chip->mask(irq); }
+
+void irq_unmask(u8 irq) { current_chip->unmask(irq); }
+
+bool irq_set_affinity(u8 irq, u64 cpu) {
+    return current_chip->set_affinity(irq, cpu);
+}
\ No newline at end of file
@@ -31,7 +31,18 @@ extern handle_pending_signals ; defined in signal.c
     mov ds, bx
 %endmacro
 
+; Kernel keeps per cpu area in gs base, user gs base is swapped into
+; KERNEL_GS_BASE msr while cpu is in kernel. Argument is offset of interrupted
+; cs on the stack.
+%macro swapgs_if_user 1
+    test qword [rsp + %1], 3
+    jz %%kernel
+    swapgs
+%%kernel:
+%endmacro
+
 %macro save_state 0
+    swapgs_if_user 16 ; stack top holds error code, rip and cs
     push r15
     push r14
     push r13
@@ -74,6 +85,7 @@ extern handle_pending_signals ; defined in signal.c
     pop r15
 
     add rsp, 8 ; remove error code from stack
+    swapgs_if_user 8 ; cs of context we are returning to
 %endmacro
 
 ; x86-64 exception with error code handler stub
@@ -1,7 +1,8 @@
 #include "isrs.h"
+#include "../../../interrupts/irq_chip.h"
 #include "../../../lib/kprint.h"
 #include "../../../synchronization/rw_spin_lock.h"
-#include "pic.h"
+#include "../../../threading/percpu.h"
 
 static rw_spin_lock irq_handlers_lock = RW_LOCK_STATIC_INITIALIZER;
 static irq_handler* irq_handlers[256] = {0};
@@ -19,9 +20,7 @@ static struct cpu_context* handle_unknown_irq(u8 irq_num,
 }
 
 static struct cpu_context* handle_irq(u8 irq_num, struct cpu_context* context) {
-    if (irq_num >= 32 && irq_num < 47) {
-        pic_ack(irq_num);
-    }
+    this_cpu_inc(stats.interrupts);
 
     rw_spin_lock_read_irq(&irq_handlers_lock);
     irq_handler* handler = irq_handlers[irq_num];
@@ -39,6 +38,7 @@ struct cpu_context* handle_soft_irq(u8 irq_num, struct cpu_context* context) {
 }
 
 struct cpu_context* handle_hard_irq(u8 irq_num, struct cpu_context* context) {
+    irq_chip_get()->eoi(irq_num - HARD_IRQ_VECTOR_BASE);
     return handle_irq(irq_num, context);
 }
 
@@ -3,6 +3,10 @@
 
 #include "../../../lib/types.h"
 
+// Legacy isa irqs are delivered to these vectors by whatever controller is used
+#define HARD_IRQ_VECTOR_BASE 32
+#define HARD_IRQS_COUNT 16
+
 typedef struct cpu_context* exception_handler(struct cpu_context* context);
 typedef struct cpu_context* irq_handler(struct cpu_context* context);
 
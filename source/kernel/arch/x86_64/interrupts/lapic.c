@@ -0,0 +1,134 @@
+#include "lapic.h"
+#include "../../../synchronization/barriers.h"
+#include "../../common/idle.h"
+#include "../cpu/cpuid.h"
+#include "../cpu/msr.h"
+
+#define IA32_APIC_BASE_MSR 0x1B
+#define IA32_APIC_BASE_X2APIC_ENABLE (1 << 10)
+#define IA32_APIC_BASE_ENABLE (1 << 11)
+
+// In x2apic mode register at offset reg is msr X2APIC_MSR_BASE + reg / 16
+#define X2APIC_MSR_BASE 0x800
+
+#define LAPIC_ID 0x20
+#define LAPIC_TPR 0x80
+#define LAPIC_EOI 0xB0
+#define LAPIC_SVR 0xF0
+#define LAPIC_ESR 0x280
+#define LAPIC_ICR_LOW 0x300
+#define LAPIC_ICR_HIGH 0x310
+#define LAPIC_ICR_X2APIC 0x300 // single 64 bit register in x2apic mode
+
+#define LAPIC_SVR_ENABLE (1 << 8)
+
+#define ICR_DELIVERY_FIXED (0b000 << 8)
+#define ICR_DELIVERY_INIT (0b101 << 8)
+#define ICR_DELIVERY_STARTUP (0b110 << 8)
+#define ICR_DELIVERY_PENDING (1 << 12)
+#define ICR_LEVEL_ASSERT (1 << 14)
+#define ICR_TRIGGER_LEVEL (1 << 15)
+#define ICR_ALL_EXCLUDING_SELF (0b11 << 18)
+
+// In xapic mode registers are accessed through direct mapping of physical
+// memory. It is mapped as write-back, but MTRRs mark apic range as
+// uncacheable, which takes precedence
+static volatile u8* lapic_base = NULL;
+
+// X2apic mode is used on all cpus if boot cpu supports it. Its registers are
+// msrs, which are cheaper to access and don't need memory ordering games.
+static bool x2apic = false;
+
+u32 lapic_read(u32 reg) {
+    if (x2apic)
+        return msr_read(X2APIC_MSR_BASE + reg / 16);
+
+    return *(volatile u32*) (lapic_base + reg);
+}
+
+void lapic_write(u32 reg, u32 value) {
+    if (x2apic) {
+        msr_write(X2APIC_MSR_BASE + reg / 16, value);
+        return;
+    }
+
+    *(volatile u32*) (lapic_base + reg) = value;
+}
+
+void lapic_setup(paddr address) {
+    lapic_base = (volatile u8*) P2V(address);
+
+    u32 eax;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+    cpuid(CPUID_FEATURES, &eax, &ebx, &ecx, &edx);
+    x2apic = (ecx >> CPUID_X2APIC_FEATURE_OFFSET) & 1;
+}
+
+bool lapic_available() { return lapic_base != NULL; }
+
+bool lapic_x2apic_enabled() { return x2apic; }
+
+void lapic_init() {
+    u64 apic_base = msr_read(IA32_APIC_BASE_MSR) | IA32_APIC_BASE_ENABLE;
+    // xapic should be enabled before switching to x2apic mode
+    msr_write(IA32_APIC_BASE_MSR, apic_base);
+    if (x2apic)
+        msr_write(IA32_APIC_BASE_MSR, apic_base | IA32_APIC_BASE_X2APIC_ENABLE);
+
+    // accept all interrupts
+    lapic_write(LAPIC_TPR, 0);
+    lapic_write(LAPIC_SVR, LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+
+    // error status register should be written before it is read
+    lapic_write(LAPIC_ESR, 0);
+    lapic_read(LAPIC_ESR);
+}
+
+// X2apic id is full 32 bit register
+u32 lapic_id() {
+    return x2apic ? lapic_read(LAPIC_ID) : lapic_read(LAPIC_ID) >> 24;
+}
+
+void lapic_eoi() { lapic_write(LAPIC_EOI, 0); }
+
+static void lapic_send_icr(u32 destination, u32 command) {
+    // x2apic icr is msr, whose write isn't ordered with earlier stores, and it
+    // doesn't report delivery status
+    if (x2apic) {
+        smp_mb();
+        msr_write(X2APIC_MSR_BASE + LAPIC_ICR_X2APIC / 16,
+                  ((u64) destination << 32) | command);
+        return;
+    }
+
+    while (lapic_read(LAPIC_ICR_LOW) & ICR_DELIVERY_PENDING) {
+        pause();
+    }
+
+    smp_mb();
+    lapic_write(LAPIC_ICR_HIGH, destination << 24);
+    // write to low half sends interrupt
+    lapic_write(LAPIC_ICR_LOW, command);
+}
+
+void lapic_send_ipi(u32 apic_id, u8 vector) {
+    lapic_send_icr(apic_id, ICR_DELIVERY_FIXED | ICR_LEVEL_ASSERT | vector);
+}
+
+void lapic_broadcast_ipi(u8 vector) {
+    lapic_send_icr(0, ICR_ALL_EXCLUDING_SELF | ICR_DELIVERY_FIXED
+                          | ICR_LEVEL_ASSERT | vector);
+}
+
+void lapic_send_init(u32 apic_id) {
+    lapic_send_icr(apic_id,
+                   ICR_DELIVERY_INIT | ICR_LEVEL_ASSERT | ICR_TRIGGER_LEVEL);
+    // de-assert is needed only by old discrete apics, but is harmless
+    lapic_send_icr(apic_id, ICR_DELIVERY_INIT | ICR_TRIGGER_LEVEL);
+}
+
+void lapic_send_startup(u32 apic_id, u8 page) {
+    lapic_send_icr(apic_id, ICR_DELIVERY_STARTUP | ICR_LEVEL_ASSERT | page);
+}
@@ -0,0 +1,37 @@
+#ifndef SOS_LAPIC_H
+#define SOS_LAPIC_H
+
+#include "../../../lib/types.h"
+#include "../../../memory/memory_map.h"
+
+#define LAPIC_SPURIOUS_VECTOR 255
+
+#define LAPIC_LVT_TIMER 0x320
+#define LAPIC_TIMER_INITIAL_COUNT 0x380
+#define LAPIC_TIMER_CURRENT_COUNT 0x390
+#define LAPIC_TIMER_DIVIDE 0x3E0
+
+// Should be called once on boot cpu before any other routine
+void lapic_setup(paddr address);
+bool lapic_available();
+bool lapic_x2apic_enabled();
+
+// Enables local apic of current cpu
+void lapic_init();
+
+// Register offsets are the ones of xapic mmio, x2apic msrs are derived from
+// them
+u32 lapic_read(u32 reg);
+void lapic_write(u32 reg, u32 value);
+
+u32 lapic_id();
+void lapic_eoi();
+
+void lapic_send_ipi(u32 apic_id, u8 vector);
+// Sends ipi to all cpus except current one
+void lapic_broadcast_ipi(u8 vector);
+
+void lapic_send_init(u32 apic_id);
+void lapic_send_startup(u32 apic_id, u8 page);
+
+#endif // SOS_LAPIC_H
@@ -1,5 +1,8 @@
 #include "pic.h"
+#include "../../../interrupts/irq.h"
+#include "../../../lib/util.h"
 #include "../cpu/io.h"
+#include "isrs.h"
 
 const u8 ICW1_ICW4_OFFSET = 0;
 const u8 ICW1_SINGLE_MODE_OFFSET = 1;
@@ -50,9 +53,9 @@ void pic_init(void) {
     outb(SLAVE_PIC_COMMAND_ADDR, icw1);
     io_wait();
 
-    outb(MASTER_PIC_DATA_ADDR, gen_icw2(32));
+    outb(MASTER_PIC_DATA_ADDR, gen_icw2(HARD_IRQ_VECTOR_BASE));
     io_wait();
-    outb(SLAVE_PIC_DATA_ADDR, gen_icw2(40));
+    outb(SLAVE_PIC_DATA_ADDR, gen_icw2(HARD_IRQ_VECTOR_BASE + 8));
     io_wait();
 
     outb(MASTER_PIC_DATA_ADDR, gen_icw3_master());
@@ -74,15 +77,52 @@ void pic_init(void) {
     io_wait();
 }
 
+void pic_disable(void) {
+    // pics stay remapped, so that their spurious interrupts don't look like
+    // exceptions
+    outb(MASTER_PIC_DATA_ADDR, 0xFF);
+    io_wait();
+    outb(SLAVE_PIC_DATA_ADDR, 0xFF);
+    io_wait();
+}
+
 const u8 OCW2_EOI_OFFSET = 5;
 
-void pic_ack(u8 irq_num) {
+void pic_ack(u8 irq) {
     outb(MASTER_PIC_COMMAND_ADDR, 1 << OCW2_EOI_OFFSET);
     io_wait();
 
     // slave PIC interrupt
-    if (irq_num >= 40 && irq_num < 48) {
+    if (irq >= 8) {
         outb(SLAVE_PIC_COMMAND_ADDR, 1 << OCW2_EOI_OFFSET);
         io_wait();
     }
-}
\ No newline at end of file
+}
+
+// Mask register (OCW1) is read-modify-written, so interrupts are disabled
+// around it. Only boot cpu touches pic.
+static void set_masked(u8 irq, bool masked) {
+    u16 port = irq < 8 ? MASTER_PIC_DATA_ADDR : SLAVE_PIC_DATA_ADDR;
+    u8 line = 1 << (irq % 8);
+
+    bool interrupts_enabled = local_irq_save();
+    u8 ocw1 = inb(port);
+    outb(port, masked ? ocw1 | line : ocw1 & ~line);
+    local_irq_restore(interrupts_enabled);
+}
+
+static void pic_mask(u8 irq) { set_masked(irq, true); }
+
+static void pic_unmask(u8 irq) { set_masked(irq, false); }
+
+// Pic delivers everything to boot cpu
+static bool pic_set_affinity(u8 irq, u64 cpu) {
+    UNUSED(irq);
+    return cpu == 0;
+}
+
+const irq_chip pic_chip = {.name = "8259",
+                           .mask = pic_mask,
+                           .unmask = pic_unmask,
+                           .eoi = pic_ack,
+                           .set_affinity = pic_set_affinity};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef SOS_PIC_H
 #define SOS_PIC_H
 
+#include "../../../interrupts/irq_chip.h"
 #include "../../../lib/types.h"
 
 typedef enum {
@@ -10,6 +11,10 @@ typedef enum {
 } pic_buffered_mode;
 
 void pic_init(void);
-void pic_ack(u8 irq_num);
+// Masks all irq lines, used once apics take over
+void pic_disable(void);
+void pic_ack(u8 irq);
+
+extern const irq_chip pic_chip;
 
 #endif // SOS_PIC_H
\ No newline at end of file
@@ -0,0 +1,138 @@
+; syscall instruction entry-point.
+
+; syscall leaves cpu on user stack with user gs base, interrupts are masked by
+; FMASK msr. Entry switches to kernel stack of current thread and saves full
+; cpu context there, in the same layout isrs.asm uses, so that signals, fork
+; and sigreturn work the same regardless of the way syscall was made.
+
+bits 64
+
+section .text
+
+extern handle_syscall_entry ; defined in syscall_entry.c
+extern handle_pending_signals ; defined in signal.c
+
+; Must match percpu layout in percpu.h
+PERCPU_KERNEL_STACK equ 48
+PERCPU_USER_STACK equ 56
+
+; Must match gdt.c
+USER_CODE_SELECTOR equ 0x23
+USER_DATA_SELECTOR equ 0x1B
+
+; Must match cpu_context layout in cpu_context.h
+CONTEXT_RCX equ 24
+CONTEXT_R11 equ 88
+CONTEXT_RIP equ 136
+CONTEXT_CS equ 144
+CONTEXT_RFLAGS equ 152
+
+; sysret to non canonical address faults in kernel mode on user stack
+USER_ADDRESS_LIMIT equ 0x00007FFFFFFFFFFF
+
+global syscall_entry
+syscall_entry:
+    swapgs
+    mov [gs:PERCPU_USER_STACK], rsp
+    mov rsp, [gs:PERCPU_KERNEL_STACK]
+
+    ; frame interrupt gate would push, rip and rflags are kept in rcx and r11
+    push USER_DATA_SELECTOR ; ss
+    push qword [gs:PERCPU_USER_STACK] ; rsp
+    push r11 ; rflags
+    push USER_CODE_SELECTOR ; cs
+    push rcx ; rip
+    push 0 ; fake error code
+
+    push r15
+    push r14
+    push r13
+    push r12
+    push r11
+    push r10
+    push r9
+    push r8
+    push rbp
+    push rdi
+    push rsi
+    push rdx
+    push rcx
+    push rbx
+    push rax
+
+    ; ds is ignored in long mode, so user one isn't replaced
+    mov bx, ds
+    push rbx
+
+    mov rdi, rsp ; cpu_context pointer
+    call handle_syscall_entry
+
+    mov rsp, rax
+
+    mov rdi, rsp
+    call handle_pending_signals
+
+    ; sysret takes rip from rcx and rflags from r11, so it can be used only if
+    ; context still returns right after syscall instruction. Signal delivery
+    ; and sigreturn replace context, those return through iretq.
+    mov rax, [rsp + CONTEXT_RIP]
+    cmp rax, [rsp + CONTEXT_RCX]
+    jne .iret
+    mov rcx, USER_ADDRESS_LIMIT
+    cmp rax, rcx
+    ja .iret
+    mov rax, [rsp + CONTEXT_RFLAGS]
+    cmp rax, [rsp + CONTEXT_R11]
+    jne .iret
+    cmp qword [rsp + CONTEXT_CS], USER_CODE_SELECTOR
+    jne .iret
+
+    add rsp, 8 ; ds wasn't changed
+    pop rax
+    pop rbx
+    pop rcx
+    pop rdx
+    pop rsi
+    pop rdi
+    pop rbp
+    pop r8
+    pop r9
+    pop r10
+    pop r11
+    pop r12
+    pop r13
+    pop r14
+    pop r15
+
+    ; stack top holds error code, rip, cs, rflags and rsp. Nothing may
+    ; interrupt us once we are on user stack with user gs base.
+    cli
+    mov rsp, [rsp + 32]
+    swapgs
+    o64 sysret
+
+.iret:
+    pop rbx
+    mov ds, bx
+    pop rax
+    pop rbx
+    pop rcx
+    pop rdx
+    pop rsi
+    pop rdi
+    pop rbp
+    pop r8
+    pop r9
+    pop r10
+    pop r11
+    pop r12
+    pop r13
+    pop r14
+    pop r15
+
+    add rsp, 8 ; remove error code from stack
+    test qword [rsp + 8], 3 ; cs of context we are returning to
+    jz .kernel
+    swapgs
+.kernel:
+    iretq
\ No newline at end of file
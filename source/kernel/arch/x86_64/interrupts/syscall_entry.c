@@ -0,0 +1,73 @@
+#include "syscall_entry.h"
+#include "../../../syscall/syscall.h"
+#include "../../../lib/panic.h"
+#include "../../../threading/percpu.h"
+#include "../cpu/cpu_context.h"
+#include "../cpu/efer.h"
+#include "../cpu/gdt.h"
+#include "../cpu/msr.h"
+#include "../cpu/rflags.h"
+
+#define IA32_STAR_MSR 0xC0000081
+#define IA32_LSTAR_MSR 0xC0000082
+#define IA32_FMASK_MSR 0xC0000084
+
+#define STAR_KERNEL_SELECTOR_OFFSET 32
+#define STAR_USER_SELECTOR_OFFSET 48
+
+#define RFLAGS_TRAP_FLAG (1 << 8)
+#define RFLAGS_DIRECTION_FLAG (1 << 10)
+#define RFLAGS_ALIGNMENT_CHECK_FLAG (1 << 18)
+
+// Selectors hardcoded in syscall_entry.asm
+#define ASM_USER_CODE_SELECTOR 0x23
+#define ASM_USER_DATA_SELECTOR 0x1B
+
+#define CONTEXT_OFFSET(field) __builtin_offsetof(cpu_context, field)
+
+// syscall_entry.asm accesses these fields directly
+_Static_assert(PERCPU_OFFSET(kernel_stack) == 48, "percpu layout changed");
+_Static_assert(PERCPU_OFFSET(user_stack) == 56, "percpu layout changed");
+_Static_assert(CONTEXT_OFFSET(rcx) == 24, "cpu_context layout changed");
+_Static_assert(CONTEXT_OFFSET(r11) == 88, "cpu_context layout changed");
+_Static_assert(CONTEXT_OFFSET(rip) == 136, "cpu_context layout changed");
+_Static_assert(CONTEXT_OFFSET(cs) == 144, "cpu_context layout changed");
+_Static_assert(CONTEXT_OFFSET(rflags) == 152, "cpu_context layout changed");
+
+extern void syscall_entry(); // defined in syscall_entry.asm
+
+// Called by syscall_entry with context it saved on kernel stack. Unlike int
+// 0x80, syscall instruction keeps return address in rcx, so fourth argument is
+// passed in r10.
+struct cpu_context* handle_syscall_entry(struct cpu_context* context) {
+    cpu_context* arch_context = (cpu_context*) context;
+
+    arch_context->rax =
+        handle_syscall(arch_context->rdi, arch_context->rsi, arch_context->rdx,
+                       arch_context->r10, arch_context->r8, arch_context->r9,
+                       arch_context->rax, context);
+
+    return context;
+}
+
+void syscall_entry_init() {
+    if (USER_CODE_SEGMENT_SELECTOR != ASM_USER_CODE_SELECTOR
+        || USER_DATA_SEGMENT_SELECTOR != ASM_USER_DATA_SELECTOR)
+        panic("User selectors don't match syscall_entry.asm");
+
+    // syscall loads kernel cs and ss = cs + 8, sysret loads user ss = base + 8
+    // and cs = base + 16
+    u64 user_base = USER_DATA_SEGMENT_SELECTOR - 8;
+    msr_write(IA32_STAR_MSR,
+              (user_base << STAR_USER_SELECTOR_OFFSET)
+                  | ((u64) KERNEL_CODE_SEGMENT_SELECTOR
+                     << STAR_KERNEL_SELECTOR_OFFSET));
+    msr_write(IA32_LSTAR_MSR, (u64) syscall_entry);
+
+    // syscalls run with interrupts disabled, same as through interrupt gate
+    msr_write(IA32_FMASK_MSR, RFLAGS_IRQ_ENABLED_FLAG | RFLAGS_TRAP_FLAG
+                                  | RFLAGS_DIRECTION_FLAG
+                                  | RFLAGS_ALIGNMENT_CHECK_FLAG);
+
+    efer_write(efer_read() | EFER_SYSCALL_ENABLE);
+}
\ No newline at end of file
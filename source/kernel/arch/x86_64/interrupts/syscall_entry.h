@@ -0,0 +1,9 @@
+#ifndef SOS_SYSCALL_ENTRY_H
+#define SOS_SYSCALL_ENTRY_H
+
+// Enables syscall instruction on current cpu, should be called on every cpu
+// after its gdt and per cpu area are set up. Software interrupt 0x80 keeps
+// working for compatibility.
+void syscall_entry_init();
+
+#endif // SOS_SYSCALL_ENTRY_H
\ No newline at end of file
@@ -17,6 +17,9 @@
 #define WRITABLE_ATTR 1 << 1
 #define SUPERVISOR_ATTR 1 << 2
 #define HUGE_PAGE_ATTR 1 << 7
+// bit 9 is ignored by cpu and is used by kernel to mark frames, that are not
+// owned by page table (so they should not be freed or copied by it)
+#define SHARED_FRAME_ATTR (1 << 9)
 #define EXECUTE_DISABLE_ATTR ((u64) 1 << 63)
 
 #define PAGE_ALIGN(addr) ((addr) & ~0xFFF)
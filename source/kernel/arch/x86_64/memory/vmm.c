@@ -1,7 +1,13 @@
 #include "../../../memory/virtual/vmm.h"
+#include "../../../interrupts/irq.h"
+#include "../../../lib/math.h"
 #include "../../../memory/heap/kheap.h"
+#include "../../../memory/physical/page.h"
+#include "../../../lib/simd/simd.h"
 #include "../../../memory/physical/pmm.h"
+#include "../../common/vmm.h"
 #include "../cpu/features.h"
+#include "../smp/smp.h"
 #include "paging.h"
 
 #define TABLE(entry) ((page_table*) P2V(MASK_FLAGS(entry)))
@@ -23,6 +29,10 @@ static void flush_tlb() {
                      : "memory");
 }
 
+static void flush_tlb_page(vaddr page) {
+    __asm__ volatile("invlpg (%0)" : : "r"(page) : "memory");
+}
+
 static void populate_kernel_pml4_with_kernel_entries() {
     for (u16 i = PT_ENTRIES / 2; i < PT_ENTRIES; i++) {
         if (!(kernel_p4_table.entries[i] & PRESENT_ATTR)) {
@@ -49,6 +59,8 @@ static vm_area* create_kernel_binary_vm_area() {
                                                 .shared = true,
                                                 .user_access_allowed = false};
 
+    kernel_binary_area->shm = NULL;
+
     return kernel_binary_area;
 }
 
@@ -66,6 +78,8 @@ static vm_area* create_kernel_vmapped_ram_vm_area() {
                         .shared = true,
                         .user_access_allowed = false};
 
+    kernel_vmapped_ram_area->shm = NULL;
+
     return kernel_vmapped_ram_area;
 }
 
@@ -81,6 +95,8 @@ static vm_area* create_kernel_heap_vm_area() {
                                                  .shared = true,
                                                  .user_access_allowed = false};
 
+    kernel_heap_vm_area->shm = NULL;
+
     return kernel_heap_vm_area;
 }
 
@@ -122,14 +138,10 @@ static u64 vm_area_flags_to_x86_64_flags(vm_area_flags flags) {
     return result;
 }
 
-// TODO: think about what to do if page address is not PAGE_SIZE aligned
-void* arch_get_page_view(struct page_table* table, vaddr page) {
-    if (!IS_CANONICAL(page))
-        return NULL;
-
-    page_table* arch_table = (page_table*) table;
-    page = PAGE_ALIGN(page);
-    u64 pml3 = arch_table->entries[P4_OFFSET(page)];
+// Returns pointer to lowest level entry that maps page, or NULL if any of
+// intermediate tables is not present
+static u64* find_pte(page_table* table, vaddr page) {
+    u64 pml3 = table->entries[P4_OFFSET(page)];
     if (!(pml3 & PRESENT_ATTR))
         return NULL;
 
@@ -141,7 +153,57 @@ void* arch_get_page_view(struct page_table* table, vaddr page) {
     if (!(pml1 & PRESENT_ATTR))
         return NULL;
 
-    return PAGE(NEXT_PTE(pml1, 1, page));
+    return (u64*) NEXT_PT(pml1) + P1_OFFSET(page);
+}
+
+// TODO: think about what to do if page address is not PAGE_SIZE aligned
+void* arch_get_page_view(struct page_table* table, vaddr page) {
+    if (!IS_CANONICAL(page))
+        return NULL;
+
+    u64* pte = find_pte((page_table*) table, PAGE_ALIGN(page));
+    if (!pte || !(*pte & PRESENT_ATTR))
+        return NULL;
+
+    return PAGE(*pte);
+}
+
+bool arch_is_page_mapped(struct page_table* table, vaddr page) {
+    if (!IS_CANONICAL(page))
+        return false;
+
+    u64* pte = find_pte((page_table*) table, PAGE_ALIGN(page));
+    return pte && (*pte & PRESENT_ATTR);
+}
+
+vm_area_flags arch_get_page_flags(struct page_table* table, vaddr page) {
+    vm_area_flags flags = {0};
+    if (!IS_CANONICAL(page))
+        return flags;
+
+    u64* pte = find_pte((page_table*) table, PAGE_ALIGN(page));
+    if (!pte || !(*pte & PRESENT_ATTR))
+        return flags;
+
+    flags.writable = (*pte & WRITABLE_ATTR) != 0;
+    flags.user_access_allowed = (*pte & SUPERVISOR_ATTR) != 0;
+    flags.executable = !(*pte & EXECUTE_DISABLE_ATTR);
+    flags.shared = (*pte & SHARED_FRAME_ATTR) != 0;
+    return flags;
+}
+
+// Keep mapcount of frame descriptors in sync with leaf entries. Frames
+// outside of physical memory (e.g. mmio) have no descriptors
+static void frame_mapped(paddr frame) {
+    page_descriptor* descriptor = frame_to_page(MASK_FLAGS(frame));
+    if (descriptor)
+        page_mapped(descriptor);
+}
+
+static void frame_unmapped(paddr frame) {
+    page_descriptor* descriptor = frame_to_page(MASK_FLAGS(frame));
+    if (descriptor)
+        page_unmapped(descriptor);
 }
 
 static bool map_page(page_table* table, vaddr page, paddr frame, u64 flags) {
@@ -152,13 +214,18 @@ static bool map_page(page_table* table, vaddr page, paddr frame, u64 flags) {
     page = PAGE_ALIGN(page);
     frame = MASK_FLAGS(frame);
 
+    // Access rights of intermediate tables are combined with leaf ones, so
+    // they should be most permissive, otherwise first mapped page (e.g.
+    // read-only one) would restrict all of its neighbours
+    u64 table_flags = (flags & SUPERVISOR_ATTR) | PRESENT_ATTR | WRITABLE_ATTR;
+
     u64 pml4_entry = table->entries[P4_OFFSET(page)];
     if (!(pml4_entry & PRESENT_ATTR)) {
         paddr pml3 = pmm_allocate_zeroed_frame();
         if (!pml3)
             return false;
 
-        table->entries[P4_OFFSET(page)] = pml4_entry = pml3 | flags;
+        table->entries[P4_OFFSET(page)] = pml4_entry = pml3 | table_flags;
     }
 
     u64 pml3_entry = NEXT_PTE(pml4_entry, 3, page);
@@ -167,7 +234,7 @@ static bool map_page(page_table* table, vaddr page, paddr frame, u64 flags) {
         if (!pml2)
             return false;
 
-        NEXT_PTE(pml4_entry, 3, page) = pml3_entry = pml2 | flags;
+        NEXT_PTE(pml4_entry, 3, page) = pml3_entry = pml2 | table_flags;
     }
 
     u64 pml2_entry = NEXT_PTE(pml3_entry, 2, page);
@@ -176,61 +243,83 @@ static bool map_page(page_table* table, vaddr page, paddr frame, u64 flags) {
         if (!pml1)
             return false;
 
-        NEXT_PTE(pml3_entry, 2, page) = pml2_entry = pml1 | flags;
+        NEXT_PTE(pml3_entry, 2, page) = pml2_entry = pml1 | table_flags;
     }
 
     NEXT_PTE(pml2_entry, 1, page) = frame | flags;
+    frame_mapped(frame);
     return true;
 }
 
-static void destroy_pml1(paddr pml1) {
+// Adds frame to batch, returning batch to pmm once it is full, so that pmm lock
+// is taken once per PMM_FRAME_BATCH_SIZE frames rather than once per frame
+static void free_frame_batched(pmm_frame_batch* batch, paddr frame) {
+    pmm_frame_batch_add(batch, frame);
+    if (batch->count >= PMM_FRAME_BATCH_SIZE)
+        pmm_free_frame_batch(batch);
+}
+
+// Mapped frames may be referenced by someone else (e.g. futex operation in
+// progress), then the last one to drop its reference frees frame
+static void put_frame_batched(pmm_frame_batch* batch, paddr frame) {
+    pmm_frame_batch_put(batch, frame);
+    if (batch->count >= PMM_FRAME_BATCH_SIZE)
+        pmm_free_frame_batch(batch);
+}
+
+static void destroy_pml1(paddr pml1, pmm_frame_batch* batch) {
     page_table* table = TABLE(pml1);
     for (u16 i = 0; i < PT_ENTRIES; ++i) {
         u64 entry = table->entries[i];
-        if (entry & PRESENT_ATTR) {
-            pmm_free_frame(MASK_FLAGS(entry));
-        }
+        if (!(entry & PRESENT_ATTR))
+            continue;
+
+        frame_unmapped(entry);
+        if (!(entry & SHARED_FRAME_ATTR))
+            put_frame_batched(batch, MASK_FLAGS(entry));
     }
 
-    pmm_free_frame(pml1);
+    free_frame_batched(batch, pml1);
 }
 
-static void destroy_pml2(paddr pml2) {
+static void destroy_pml2(paddr pml2, pmm_frame_batch* batch) {
     page_table* table = TABLE(pml2);
     for (u16 i = 0; i < PT_ENTRIES; ++i) {
         u64 entry = table->entries[i];
         if (entry & PRESENT_ATTR) {
-            destroy_pml1(MASK_FLAGS(entry));
+            destroy_pml1(MASK_FLAGS(entry), batch);
         }
     }
-    pmm_free_frame(pml2);
+    free_frame_batched(batch, pml2);
 }
 
-static void destroy_pml3(paddr pml3) {
+static void destroy_pml3(paddr pml3, pmm_frame_batch* batch) {
     page_table* table = TABLE(pml3);
     for (u16 i = 0; i < PT_ENTRIES; ++i) {
         u64 entry = table->entries[i];
         if (entry & PRESENT_ATTR) {
-            destroy_pml2(MASK_FLAGS(entry));
+            destroy_pml2(MASK_FLAGS(entry), batch);
         }
     }
-    pmm_free_frame(pml3);
+    free_frame_batched(batch, pml3);
 }
 
-static void destroy_page_table(page_table* table) {
+static void destroy_page_table(page_table* table, pmm_frame_batch* batch) {
     // kernel half of address space is owned by kernel vm, so don't destroy it
     for (u16 i = 0; i < PT_ENTRIES / 2; ++i) {
         u64 entry = table->entries[i];
         if (entry & PRESENT_ATTR) {
-            destroy_pml3(MASK_FLAGS(entry));
+            destroy_pml3(MASK_FLAGS(entry), batch);
         }
     }
 
-    pmm_free_frame(V2P(table));
+    free_frame_batched(batch, V2P(table));
 }
 
 void arch_destroy_page_table(struct page_table* table) {
-    destroy_page_table((page_table*) table);
+    pmm_frame_batch batch = PMM_FRAME_BATCH_STATIC_INITIALIZER;
+    destroy_page_table((page_table*) table, &batch);
+    pmm_free_frame_batch(&batch);
 }
 
 bool arch_map_page_to_frame(struct page_table* table, vaddr page, paddr frame,
@@ -262,7 +351,81 @@ bool arch_map_page(struct page_table* table, vaddr page, vm_area_flags flags) {
     return true;
 }
 
-bool arch_unmap_page(struct page_table* table, vaddr page) {
+bool arch_map_page_to_shared_frame(struct page_table* table, vaddr page,
+                                   paddr frame, vm_area_flags flags) {
+
+    if (!IS_CANONICAL(page))
+        return false;
+
+    page_table* arch_table = (page_table*) table;
+    u64 arch_flags =
+        vm_area_flags_to_x86_64_flags(flags) | PRESENT_ATTR | SHARED_FRAME_ATTR;
+    page = PAGE_ALIGN(page);
+
+    return map_page(arch_table, page, frame, arch_flags);
+}
+
+bool arch_unshare_page(struct page_table* table, vaddr page,
+                       vm_area_flags flags) {
+
+    if (!IS_CANONICAL(page))
+        return false;
+
+    page = PAGE_ALIGN(page);
+    u64* pte = find_pte((page_table*) table, page);
+    if (!pte || !(*pte & PRESENT_ATTR))
+        return false;
+
+    if (!(*pte & SHARED_FRAME_ATTR))
+        return true;
+
+    paddr frame = pmm_allocate_frame();
+    if (!frame)
+        return false;
+
+    simd_copy_page(PAGE(frame), PAGE(*pte));
+    frame_unmapped(*pte);
+    *pte = frame | vm_area_flags_to_x86_64_flags(flags) | PRESENT_ATTR;
+    frame_mapped(frame);
+
+    // other cpus are taken care of by caller, which knows vm space
+    flush_tlb_page(page);
+    return true;
+}
+
+void arch_flush_tlb_range(vm_space* space, vaddr start, vaddr end) {
+    bool interrupts_enabled = local_irq_save();
+    for (vaddr page = start; page < end; page += PAGE_SIZE) {
+        flush_tlb_page(page);
+    }
+    smp_tlb_shootdown(vmm_vm_space_cpus(space), start, end);
+    local_irq_restore(interrupts_enabled);
+}
+
+void arch_flush_local_tlb_page(vaddr page) { flush_tlb_page(PAGE_ALIGN(page)); }
+
+void arch_finish_unmap(unmap_batch* batch) {
+    if (batch->start == batch->end)
+        return;
+
+    // pages were already flushed locally one by one when they were unmapped
+    bool interrupts_enabled = local_irq_save();
+    smp_tlb_shootdown(vmm_vm_space_cpus(batch->space), batch->start,
+                      batch->end);
+    local_irq_restore(interrupts_enabled);
+
+    pmm_frame_batch frames = PMM_FRAME_BATCH_STATIC_INITIALIZER;
+    for (u64 i = 0; i < batch->count; i++) {
+        pmm_frame_batch_put(&frames, batch->frames[i]);
+    }
+    pmm_free_frame_batch(&frames);
+
+    batch->count = 0;
+    batch->start = batch->end = 0;
+}
+
+bool arch_unmap_page(struct page_table* table, vaddr page,
+                     unmap_batch* batch) {
     if (!IS_CANONICAL(page))
         return false;
 
@@ -280,8 +443,25 @@ bool arch_unmap_page(struct page_table* table, vaddr page) {
     if (!(pml1 & PRESENT_ATTR))
         return false;
 
-    pmm_free_frame(MASK_FLAGS(NEXT_PTE(pml1, 1, page)));
-    return NEXT_PTE(pml1, 1, page) = 0;
+    u64 entry = NEXT_PTE(pml1, 1, page);
+    if (!(entry & PRESENT_ATTR))
+        return false;
+
+    if (batch->count == UNMAP_BATCH_SIZE)
+        arch_finish_unmap(batch);
+
+    NEXT_PTE(pml1, 1, page) = 0;
+    flush_tlb_page(page);
+
+    bool empty = batch->start == batch->end;
+    batch->start = empty ? page : MIN(batch->start, page);
+    batch->end = empty ? page + PAGE_SIZE : MAX(batch->end, page + PAGE_SIZE);
+
+    frame_unmapped(entry);
+    if (!(entry & SHARED_FRAME_ATTR))
+        batch->frames[batch->count++] = MASK_FLAGS(entry);
+
+    return true;
 }
 
 bool arch_map_kernel_page(vaddr page, vm_area_flags flags) {
@@ -298,22 +478,30 @@ static paddr clone_pml1(paddr pml1) {
 
     for (u16 i = 0; i < PT_ENTRIES; i++) {
         u64 pml1_entry = table->entries[i];
-        if (pml1_entry & PRESENT_ATTR) {
-            paddr cloned_page = pmm_allocate_zeroed_frame();
+        if ((pml1_entry & PRESENT_ATTR) && (pml1_entry & SHARED_FRAME_ATTR)) {
+            // shared frames are not owned by table, so just share them further
+            cloned_table->entries[i] = pml1_entry;
+            frame_mapped(pml1_entry);
+        } else if (pml1_entry & PRESENT_ATTR) {
+            paddr cloned_page = pmm_allocate_frame();
             if (!cloned_page)
                 goto cleanup_cloned_table;
 
-            memcpy(PAGE(cloned_page), PAGE(pml1_entry), PAGE_SIZE);
+            simd_copy_page(PAGE(cloned_page), PAGE(pml1_entry));
             cloned_table->entries[i] = cloned_page | GET_FLAGS(pml1_entry);
+            frame_mapped(cloned_page);
         }
     }
 
     return cloned_pml1;
 
-cleanup_cloned_table:
-    destroy_pml1(cloned_pml1);
+cleanup_cloned_table: {
+    pmm_frame_batch batch = PMM_FRAME_BATCH_STATIC_INITIALIZER;
+    destroy_pml1(cloned_pml1, &batch);
+    pmm_free_frame_batch(&batch);
     return NULL;
 }
+}
 
 static paddr clone_pml2(paddr pml2) {
     paddr cloned_pml2 = pmm_allocate_zeroed_frame();
@@ -336,10 +524,13 @@ static paddr clone_pml2(paddr pml2) {
 
     return cloned_pml2;
 
-cleanup_cloned_table:
-    destroy_pml2(cloned_pml2);
+cleanup_cloned_table: {
+    pmm_frame_batch batch = PMM_FRAME_BATCH_STATIC_INITIALIZER;
+    destroy_pml2(cloned_pml2, &batch);
+    pmm_free_frame_batch(&batch);
     return NULL;
 }
+}
 
 static paddr clone_pml3(paddr pml3) {
     paddr cloned_pml3 = pmm_allocate_zeroed_frame();
@@ -362,10 +553,13 @@ static paddr clone_pml3(paddr pml3) {
 
     return cloned_pml3;
 
-cleanup_cloned_table:
-    destroy_pml3(cloned_pml3);
+cleanup_cloned_table: {
+    pmm_frame_batch batch = PMM_FRAME_BATCH_STATIC_INITIALIZER;
+    destroy_pml3(cloned_pml3, &batch);
+    pmm_free_frame_batch(&batch);
     return NULL;
 }
+}
 
 static page_table* clone_page_table(page_table* table) {
     paddr cloned_pml4 = pmm_allocate_zeroed_frame();
@@ -391,7 +585,7 @@ static page_table* clone_page_table(page_table* table) {
     return cloned_table;
 
 cleanup_cloned_table:
-    destroy_page_table(cloned_table);
+    arch_destroy_page_table((struct page_table*) cloned_table);
     return NULL;
 }
 
@@ -401,7 +595,14 @@ struct page_table* arch_fork_page_table(struct page_table* table) {
     return (struct page_table*) clone_page_table((page_table*) table);
 }
 
-void arch_notify_vm_space_changed() { flush_tlb(); }
+void arch_notify_vm_space_changed() {
+    bool interrupts_enabled = local_irq_save();
+    flush_tlb();
+    // whole address space range is too long, so targets reload whole tlb
+    smp_tlb_shootdown(vmm_vm_space_cpus(vmm_current_vm_space()), 0,
+                      (vaddr) -1);
+    local_irq_restore(interrupts_enabled);
+}
 
 void arch_set_vm_space(vm_space* space) {
     if (((u64) space->table < (u64) KERNEL_VMAPPED_RAM_START_VADDR)
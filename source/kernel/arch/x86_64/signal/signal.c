@@ -1,29 +1,44 @@
 #include "../../common/signal.h"
 #include "../../../memory/virtual/umem.h"
+#include "../../../threading/scheduler.h"
 #include "../../../threading/thread.h"
+#include "../../../vdso/vdso.h"
 #include "../cpu/cpu_context.h"
+#include "../cpu/fpu.h"
 #include "../cpu/gdt.h"
 #include "../cpu/rflags.h"
 
-#define STACK_PUSH(rsp, type, val)                                             \
-    do {                                                                       \
-        type __val = val;                                                      \
-        rsp -= sizeof(type);                                                   \
-        if (!copy_to_user((void*) (rsp), &__val, sizeof(type)))                \
-            process_exit(128 + SIGSEGV);                                       \
-    } while (0)
-
-#define STACK_PUSH_RAW(rsp, size, src)                                         \
-    do {                                                                       \
-        rsp -= size;                                                           \
-        if (!copy_to_user((void*) (rsp), (void*) (src), size))                 \
-            process_exit(128 + SIGSEGV);                                       \
-    } while (0)
-
 extern void signal_trampoline_code_start();
 extern void signal_trampoline_code_end();
-#define TRAMPOLINE_CODE_SIZE                                                   \
-    ((u64) signal_trampoline_code_end - (u64) signal_trampoline_code_start)
+
+// Area below user rsp which leaf functions may use without moving rsp
+#define RED_ZONE_SIZE 128
+
+// Part of signal frame in front of fpu state. Its size is 8 modulo 16, so
+// handler gets rsp + 8 aligned as abi wants, while fpu state stays aligned.
+typedef struct __attribute__((__packed__)) {
+    u64 return_address;
+    cpu_context context;
+} signal_frame_header;
+
+_Static_assert(sizeof(signal_frame_header) <= FPU_STATE_HEADROOM,
+               "Signal frame header doesn't fit in front of fpu state");
+_Static_assert(sizeof(signal_frame_header) % 16 == 8,
+               "Signal frame header breaks handler stack alignment");
+
+const void* arch_signal_trampoline_code() {
+    return signal_trampoline_code_start;
+}
+
+u64 arch_signal_trampoline_size() {
+    return (u64) signal_trampoline_code_end
+           - (u64) signal_trampoline_code_start;
+}
+
+static signal_frame_header* frame_header(thread* thread) {
+    return (signal_frame_header*) ((u8*) thread->fpu_state
+                                   - sizeof(signal_frame_header));
+}
 
 /*
  * This function installs signal handler and is called when user is coming into
@@ -33,43 +48,55 @@ extern void signal_trampoline_code_end();
  * user stack(which address is stored in context->rsp):
  *      stack growth direction <--- | ... |
  *
- * To install signal handler we need to:
- *      1. save current state on stack
- *      2. place signal trampoline code
- *      3. then place signal trampoline code address, so that returning from
- *      signal handler will cause cpu to start executing signal trampoline code,
- *      which will make syscall for signal return, which in turn will restore
- * saved state
- *      4. set context->rip to signal handler address.
+ * Signal frame is assembled in kernel memory right in front of fpu state of
+ * thread, so it is written to user stack with single copy:
+ *      1. fpu state is saved to its area
+ *      2. current state and address of signal trampoline are put before it,
+ *      trampoline lives in page mapped into every process (see vdso.h), so
+ *      returning from signal handler will make syscall for signal return,
+ *      which in turn will restore saved state
+ *      3. frame is copied below red zone, so that fpu state is aligned
+ *      4. context->rip is set to signal handler address.
  *
  * After that user stack will look like this:
  * user stack:
- *      stack growth direction <--- | tramp addr | tramp code | state | ...
+ *      stack growth direction <--- | tramp addr | state | fpu state | pad |
+ *                                  | red zone | ...
  */
 void arch_enter_signal_handler(struct cpu_context* context,
                                signal_handler* handler) {
 
     cpu_context* arch_context = (cpu_context*) context;
+    thread* current = get_current_thread();
 
-    STACK_PUSH(arch_context->rsp, cpu_context, *arch_context);
-    STACK_PUSH_RAW(arch_context->rsp, TRAMPOLINE_CODE_SIZE,
-                   signal_trampoline_code_start);
-    STACK_PUSH(arch_context->rsp, u64, arch_context->rsp);
+    fpu_save(current);
+    signal_frame_header* header = frame_header(current);
+    header->return_address = VDSO_SIGNAL_TRAMPOLINE_VADDR;
+    header->context = *arch_context;
 
+    u64 fpu_state = arch_context->rsp - RED_ZONE_SIZE - fpu_state_size();
+    fpu_state &= ~(u64) (FPU_STATE_ALIGNMENT - 1);
+    u64 rsp = fpu_state - sizeof(signal_frame_header);
+
+    if (!copy_to_user((void*) rsp, header,
+                      sizeof(signal_frame_header) + fpu_state_size()))
+        process_exit(128 + SIGSEGV);
+
+    arch_context->rsp = rsp;
     arch_context->rip = (u64) handler;
 }
 
 /*
  * This function is counterpart of arch_enter_signal_handler.
  *
- * To enter this function, user space jumped to signal trampoline code by
- * popping trampoline address from the stack, so for now user stack looks like
- * this:
+ * To enter this function, user space returned from signal handler to signal
+ * trampoline by popping its address from the stack, so for now user stack
+ * looks like this:
  * user stack(which address is stored in context->rsp):
- *      stack growth direction <--- tramp code | state | ...
+ *      stack growth direction <--- state | fpu state | ...
  *
- * To restore previous state we just need increase rsp on size of trampoline
- * code and then restore saved cpu context from user stack.
+ * Both are read back with single copy into the same place in front of fpu
+ * state of thread, then saved context replaces current one.
  *
  * Note: cs, ss and flags registers should be copied with care, since we should
  * not let user enter kernel space or disable interrupts.
@@ -79,15 +106,22 @@ void arch_enter_signal_handler(struct cpu_context* context,
  */
 u64 arch_return_from_signal_handler(struct cpu_context* context) {
     cpu_context* arch_context = (cpu_context*) context;
+    thread* current = get_current_thread();
+    signal_frame_header* header = frame_header(current);
 
-    void* src = (void*) arch_context->rsp + TRAMPOLINE_CODE_SIZE;
-    if (!copy_from_user((void*) context, src, sizeof(cpu_context)))
+    // state of handler is dropped, restored one is loaded lazily
+    fpu_drop(current);
+    if (!copy_from_user(&header->context, (void*) arch_context->rsp,
+                        sizeof(cpu_context) + fpu_state_size())
+        || !fpu_state_valid(current))
         process_exit(128 + SIGSEGV);
 
+    *arch_context = header->context;
+
     // make sure user space did not modify cs, ss and flags to mess kernel state
     arch_context->ss = USER_DATA_SEGMENT_SELECTOR;
     arch_context->cs = USER_CODE_SEGMENT_SELECTOR;
     arch_context->rflags |= RFLAGS_IRQ_ENABLED_FLAG | RFLAGS_INIT_FLAGS;
 
     return arch_context->rax;
-}
+}
\ No newline at end of file
@@ -2,7 +2,7 @@ bits 64
 
 section .text
 
-; Signal trampoline code, which will reside on user stack.
+; Signal trampoline code, which is copied to page mapped into every process.
 ; When returning from signal handler, user will jump to this trampoline,
 ; which in turn will make system call to return from signal
 
@@ -11,5 +11,5 @@ global signal_trampoline_code_end
 
 signal_trampoline_code_start:
     mov rax, 3 ; SYS_SIGRET
-    int 0x80
+    syscall
 signal_trampoline_code_end:
@@ -0,0 +1,109 @@
+; Application processor startup trampoline.
+
+; This code is copied by smp.c to AP_TRAMPOLINE_ADDR (below 1MiB) and is
+; executed by application processors after INIT-SIPI-SIPI sequence. Processor
+; starts in real mode at AP_TRAMPOLINE_ADDR, so all addresses here are
+; computed relative to that location, not to where code is linked.
+
+; Trampoline goes straight from real mode to long mode using temporary page
+; table prepared by smp.c, which identity maps first 2MiB of RAM (where this
+; code lives) and shares kernel half with kernel page table. Then it jumps to
+; 64 bit C entry point (ap_main) on stack allocated for that processor.
+
+%define AP_TRAMPOLINE_ADDR 0x8000
+%define REL(addr) (AP_TRAMPOLINE_ADDR + (addr) - ap_trampoline_start)
+
+%define CR0_PROTECTED_MODE 1 << 0
+%define CR0_WRITE_PROTECT 1 << 16
+%define CR0_PAGING 1 << 31
+%define CR4_PAE 1 << 5
+%define EFER_MSR 0xC0000080
+
+%define CODE32_SELECTOR 0x08
+%define DATA_SELECTOR 0x10
+%define CODE64_SELECTOR 0x18
+
+section .text
+
+global ap_trampoline_start
+global ap_trampoline_end
+global ap_trampoline_data
+
+bits 16
+ap_trampoline_start:
+    cli
+    cld
+    xor ax, ax
+    mov ds, ax
+
+    lgdt [REL(trampoline_gdt.pointer)]
+
+    mov eax, cr0
+    or eax, CR0_PROTECTED_MODE
+    mov cr0, eax
+
+    jmp dword CODE32_SELECTOR:REL(protected_mode)
+
+bits 32
+protected_mode:
+    mov ax, DATA_SELECTOR
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    mov eax, cr4
+    or eax, CR4_PAE
+    mov cr4, eax
+
+    mov eax, [REL(ap_trampoline_data.page_table)]
+    mov cr3, eax
+
+    ; efer value of boot processor (long mode enable, no-execute enable)
+    mov ecx, EFER_MSR
+    mov eax, [REL(ap_trampoline_data.efer)]
+    mov edx, [REL(ap_trampoline_data.efer) + 4]
+    wrmsr
+
+    mov eax, cr0
+    or eax, CR0_PAGING | CR0_WRITE_PROTECT
+    mov cr0, eax
+
+    jmp CODE64_SELECTOR:REL(long_mode)
+
+bits 64
+long_mode:
+    mov ax, DATA_SELECTOR
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    mov rsp, [REL(ap_trampoline_data.stack)]
+    mov rdi, [REL(ap_trampoline_data.cpu)]
+    mov rax, [REL(ap_trampoline_data.entry)]
+    call rax
+
+.halt: ; ap_main never returns
+    cli
+    hlt
+    jmp .halt
+
+align 8
+trampoline_gdt:
+    dq 0
+    dq 0x00CF9A000000FFFF ; 32 bit code
+    dq 0x00CF92000000FFFF ; data
+    dq 0x00AF9A000000FFFF ; 64 bit code
+.pointer:
+    dw $ - trampoline_gdt - 1
+    dd REL(trampoline_gdt)
+
+; Filled by boot processor before each processor startup, layout should match
+; ap_trampoline_data_layout struct in smp.c
+align 8
+ap_trampoline_data:
+.page_table: dq 0
+.efer: dq 0
+.stack: dq 0
+.entry: dq 0
+.cpu: dq 0
+ap_trampoline_end:
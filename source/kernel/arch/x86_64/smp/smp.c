@@ -0,0 +1,300 @@
+#include "smp.h"
+#include "../../../interrupts/irq.h"
+#include "../../../lib/kprint.h"
+#include "../../../lib/memory_util.h"
+#include "../../../memory/heap/kheap.h"
+#include "../../../memory/virtual/vmm.h"
+#include "../../../synchronization/barriers.h"
+#include "../../../synchronization/spin_lock.h"
+#include "../../../threading/percpu.h"
+#include "../../../threading/scheduler.h"
+#include "../../common/idle.h"
+#include "../../common/vmm.h"
+#include "../acpi/madt.h"
+#include "../cpu/efer.h"
+#include "../cpu/features.h"
+#include "../cpu/gdt.h"
+#include "../cpu/registers.h"
+#include "../cpu/tss.h"
+#include "../interrupts/idt.h"
+#include "../interrupts/ioapic.h"
+#include "../interrupts/isrs.h"
+#include "../interrupts/lapic.h"
+#include "../interrupts/syscall_entry.h"
+#include "../memory/paging.h"
+#include "../timer/lapic_timer.h"
+#include "../timer/pit.h"
+
+// Trampoline and its temporary page table live in low memory, which is never
+// handed out by pmm. Trampoline address should match one in ap_trampoline.asm
+#define AP_TRAMPOLINE_ADDR 0x8000
+#define AP_PML4_ADDR 0x9000
+#define AP_PML3_ADDR 0xA000
+#define AP_PML2_ADDR 0xB000
+
+#define AP_BOOT_STACK_SIZE 0x4000
+#define AP_INIT_DELAY_US 10000
+#define AP_STARTUP_DELAY_US 200
+#define AP_STARTUP_TIMEOUT_US 100000
+#define AP_STARTUP_POLL_US 50
+
+#define MAX_APIC_ID 255
+
+// Ranges longer than this are cheaper to flush by reloading whole tlb
+#define TLB_SHOOTDOWN_MAX_PAGES 32
+
+typedef struct __attribute__((__packed__)) {
+    u64 page_table;
+    u64 efer;
+    u64 stack;
+    u64 entry;
+    u64 cpu;
+} ap_trampoline_data_layout;
+
+// defined in ap_trampoline.asm
+extern u8 ap_trampoline_start[];
+extern u8 ap_trampoline_end[];
+extern u8 ap_trampoline_data[];
+
+static volatile u64 cpus_count = 1;
+static u32 cpu_apic_ids[MAX_CPUS];
+
+static volatile bool ap_started = false;
+
+// Mask of cpus that haven't flushed tlb for current shootdown yet. Only one
+// shootdown is in flight at a time, range is set before pending mask.
+static volatile u64 tlb_flush_pending = 0;
+static vaddr tlb_flush_start;
+static vaddr tlb_flush_end;
+static DECLARE_SPIN_LOCK(tlb_shootdown_lock);
+
+u64 arch_cpus_count() { return cpus_count; }
+
+u32 smp_cpu_apic_id(u64 cpu) { return cpu_apic_ids[cpu]; }
+
+void arch_send_reschedule(u64 cpu) {
+    lapic_send_ipi(cpu_apic_ids[cpu], RESCHEDULE_IPI_VECTOR);
+}
+
+void arch_broadcast_reschedule() {
+    if (cpus_count > 1)
+        lapic_broadcast_ipi(RESCHEDULE_IPI_VECTOR);
+}
+
+static void flush_tlb_range(vaddr start, vaddr end) {
+    if ((end - start) / PAGE_SIZE > TLB_SHOOTDOWN_MAX_PAGES) {
+        set_cr3(get_cr3());
+        return;
+    }
+
+    for (vaddr page = start; page < end; page += PAGE_SIZE) {
+        __asm__ volatile("invlpg (%0)" : : "r"(page) : "memory");
+    }
+}
+
+void smp_handle_tlb_flush_request() {
+    // nothing is pending until second cpu is online, so cpu id isn't read
+    // before per cpu area is set up
+    if (!tlb_flush_pending)
+        return;
+
+    u64 this_cpu = 1ull << this_cpu_id();
+    if (!(tlb_flush_pending & this_cpu))
+        return;
+
+    flush_tlb_range(tlb_flush_start, tlb_flush_end);
+    atomic_and(&tlb_flush_pending, ~this_cpu);
+}
+
+void smp_tlb_shootdown(u64 cpus, vaddr start, vaddr end) {
+    if (!cpus || start >= end)
+        return;
+
+    // spinning on lock handles shootdowns of other cpus, so concurrent
+    // initiators don't wait for each other forever
+    bool interrupts_enabled = spin_lock_irq_save(&tlb_shootdown_lock);
+
+    tlb_flush_start = start;
+    tlb_flush_end = end;
+    smp_mb();
+    atomic_set(&tlb_flush_pending, cpus);
+    smp_mb();
+
+    for (u64 cpu = 0; cpu < cpus_count; cpu++) {
+        if (cpus & (1ull << cpu))
+            lapic_send_ipi(cpu_apic_ids[cpu], TLB_FLUSH_IPI_VECTOR);
+    }
+
+    while (tlb_flush_pending) {
+        pause();
+    }
+
+    spin_unlock_irq_restore(&tlb_shootdown_lock, interrupts_enabled);
+}
+
+static struct cpu_context* handle_reschedule_ipi(struct cpu_context* context) {
+    // acknowledge before schedule, since it may not return for a long time
+    lapic_eoi();
+    schedule();
+    return context;
+}
+
+static struct cpu_context* handle_tlb_flush_ipi(struct cpu_context* context) {
+    // request may have been handled already while spinning
+    smp_handle_tlb_flush_request();
+    lapic_eoi();
+    return context;
+}
+
+static struct cpu_context* handle_spurious_irq(struct cpu_context* context) {
+    // spurious interrupts must not be acknowledged
+    return context;
+}
+
+void smp_boot_cpu_init() {
+    cpu_apic_ids[0] = 0;
+
+    if (!madt_init()) {
+        println("No ACPI MADT found, running on boot cpu only");
+        return;
+    }
+
+    lapic_setup(madt_get()->lapic_address);
+    lapic_init();
+    ioapic_init();
+    lapic_timer_init();
+
+    u32 boot_apic_id = lapic_id();
+    cpu_apic_ids[0] = boot_apic_id;
+
+    mount_irq_handler(RESCHEDULE_IPI_VECTOR, handle_reschedule_ipi);
+    mount_irq_handler(TLB_FLUSH_IPI_VECTOR, handle_tlb_flush_ipi);
+    mount_irq_handler(LAPIC_SPURIOUS_VECTOR, handle_spurious_irq);
+}
+
+_Noreturn static void ap_main(u64 cpu) {
+    gdt_init(cpu);
+    percpu_init(cpu);
+    tss_init(cpu);
+    idt_load();
+    features_init();
+    syscall_entry_init();
+    lapic_init();
+    lapic_timer_init_cpu();
+
+    // leave temporary trampoline page table
+    vmm_switch_to_kernel_vm_space();
+    scheduler_init_cpu();
+
+    smp_mb();
+    ap_started = true;
+
+    // first timer event or reschedule ipi moves this cpu into scheduler, boot
+    // stack is abandoned after that
+    local_irq_enable();
+    while (true) {
+        halt();
+    }
+}
+
+// Returns data block of trampoline copy in low memory
+static ap_trampoline_data_layout* trampoline_data() {
+    u64 offset = ap_trampoline_data - ap_trampoline_start;
+    return (ap_trampoline_data_layout*) P2V(AP_TRAMPOLINE_ADDR + offset);
+}
+
+static void prepare_trampoline() {
+    memcpy((void*) P2V(AP_TRAMPOLINE_ADDR), ap_trampoline_start,
+           ap_trampoline_end - ap_trampoline_start);
+
+    u64* pml4 = (u64*) P2V(AP_PML4_ADDR);
+    u64* pml3 = (u64*) P2V(AP_PML3_ADDR);
+    u64* pml2 = (u64*) P2V(AP_PML2_ADDR);
+    memset(pml4, 0, PAGE_SIZE);
+    memset(pml3, 0, PAGE_SIZE);
+    memset(pml2, 0, PAGE_SIZE);
+
+    // identity map first 2MiB for trampoline, kernel half is shared with
+    // kernel page table, so that ap_main can run before switching to it
+    pml4[0] = AP_PML3_ADDR | PRESENT_ATTR | WRITABLE_ATTR;
+    pml3[0] = AP_PML2_ADDR | PRESENT_ATTR | WRITABLE_ATTR;
+    pml2[0] = 0 | PRESENT_ATTR | WRITABLE_ATTR | HUGE_PAGE_ATTR;
+
+    u64* kernel_pml4 = (u64*) P2V(get_cr3() & ~0xFFF);
+    memcpy(pml4 + PT_ENTRIES / 2, kernel_pml4 + PT_ENTRIES / 2,
+           PT_ENTRIES / 2 * sizeof(u64));
+
+    ap_trampoline_data_layout* data = trampoline_data();
+    data->page_table = AP_PML4_ADDR;
+    data->efer = efer_read() & ~EFER_LONG_MODE_ACTIVE;
+    data->entry = (u64) ap_main;
+}
+
+static bool wait_for_ap(u64 timeout_us) {
+    for (u64 waited = 0; waited < timeout_us; waited += AP_STARTUP_POLL_US) {
+        if (ap_started)
+            return true;
+
+        pit_delay_us(AP_STARTUP_POLL_US);
+    }
+
+    return ap_started;
+}
+
+static bool start_ap(u32 apic_id) {
+    u64 cpu = cpus_count;
+    void* stack = kmalloc_aligned(AP_BOOT_STACK_SIZE, PAGE_SIZE);
+    if (!stack)
+        return false;
+
+    ap_trampoline_data_layout* data = trampoline_data();
+    data->stack = (u64) stack + AP_BOOT_STACK_SIZE;
+    data->cpu = cpu;
+
+    cpu_apic_ids[cpu] = apic_id;
+    ap_started = false;
+    smp_mb();
+
+    // INIT-SIPI-SIPI, second startup ipi is sent only if first one was missed
+    lapic_send_init(apic_id);
+    pit_delay_us(AP_INIT_DELAY_US);
+
+    lapic_send_startup(apic_id, AP_TRAMPOLINE_ADDR >> 12);
+    if (!wait_for_ap(AP_STARTUP_DELAY_US)) {
+        lapic_send_startup(apic_id, AP_TRAMPOLINE_ADDR >> 12);
+        if (!wait_for_ap(AP_STARTUP_TIMEOUT_US)) {
+            kfree(stack);
+            return false;
+        }
+    }
+
+    cpus_count++;
+    return true;
+}
+
+void arch_smp_init() {
+    if (!lapic_available())
+        return;
+
+    prepare_trampoline();
+
+    const madt_info* madt = madt_get();
+    for (u64 i = 0; i < madt->cpus_count && cpus_count < MAX_CPUS; i++) {
+        u32 apic_id = madt->cpu_apic_ids[i];
+
+        // cpus with apic ids that don't fit into xapic destination field
+        // can't be started without x2apic
+        if (apic_id == cpu_apic_ids[0] || apic_id > MAX_APIC_ID)
+            continue;
+
+        if (!start_ap(apic_id)) {
+            print("Failed to start cpu with apic id ");
+            print_u64(apic_id);
+            println("");
+        }
+    }
+
+    print("Cpus online: ");
+    print_u64(cpus_count);
+    println("");
+}
@@ -0,0 +1,26 @@
+#ifndef SOS_X86_64_SMP_H
+#define SOS_X86_64_SMP_H
+
+#include "../../../memory/memory_map.h"
+#include "../../common/smp.h"
+
+#define RESCHEDULE_IPI_VECTOR 240
+#define TLB_FLUSH_IPI_VECTOR 241
+
+// Discovers processors listed in ACPI MADT, sets up local apic of boot cpu
+// and moves hardware irqs from 8259 to io apic
+void smp_boot_cpu_init();
+
+u32 smp_cpu_apic_id(u64 cpu);
+
+// Makes cpus from `cpus` mask drop translations of pages in [start, end) and
+// waits until every one of them has done that, so frames that were unmapped
+// before the call can be reused safely afterwards. Large ranges are flushed
+// by reloading whole tlb.
+void smp_tlb_shootdown(u64 cpus, vaddr start, vaddr end);
+// Handles shootdown in progress if current cpu is its target. Called
+// from spin loops, so that cpu waiting for a lock with interrupts disabled
+// doesn't block cpu that holds this lock and waits for shootdown.
+void smp_handle_tlb_flush_request();
+
+#endif // SOS_X86_64_SMP_H
@@ -29,4 +29,41 @@ u64 atomic_decrement_and_get(volatile u64* addr) {
                      : "memory");
 
     return old_value - 1;
+}
+
+void atomic_and(volatile u64* addr, u64 mask) {
+    __asm__ volatile("lock andq %1, %0" : "+m"(*addr) : "r"(mask) : "memory");
+}
+
+void atomic_increment_u32(volatile u32* addr) {
+    __asm__ volatile("lock incl (%0)" : : "r"(addr) : "memory");
+}
+
+u32 atomic_decrement_and_get_u32(volatile u32* addr) {
+    u32 old_value;
+
+    __asm__ volatile("lock xaddl %0, %1"
+                     : "=r"(old_value), "+m"(*addr)
+                     : "0"((u32)-1)
+                     : "memory");
+
+    return old_value - 1;
+}
+
+void atomic_or_u32(volatile u32* addr, u32 mask) {
+    __asm__ volatile("lock orl %1, %0" : "+m"(*addr) : "r"(mask) : "memory");
+}
+
+void atomic_and_u32(volatile u32* addr, u32 mask) {
+    __asm__ volatile("lock andl %1, %0" : "+m"(*addr) : "r"(mask) : "memory");
+}
+
+u32 atomic_compare_exchange_u32(volatile u32* addr, u32 expected,
+                                u32 new_value) {
+    __asm__ volatile("lock cmpxchgl %2, %1"
+                     : "+a"(expected), "+m"(*addr)
+                     : "r"(new_value)
+                     : "memory");
+
+    return expected;
 }
\ No newline at end of file
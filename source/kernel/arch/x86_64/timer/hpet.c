@@ -0,0 +1,77 @@
+#include "hpet.h"
+#include "../../../memory/memory_map.h"
+#include "../../../time/clocksource.h"
+#include "../acpi/acpi.h"
+
+#define HPET_SIGNATURE "HPET"
+
+#define HPET_CAPABILITIES 0x000
+#define HPET_CONFIG 0x010
+#define HPET_MAIN_COUNTER 0x0F0
+
+#define CAPABILITIES_64_BIT_COUNTER (1 << 13)
+#define CAPABILITIES_PERIOD_OFFSET 32
+#define CONFIG_ENABLE (1 << 0)
+
+#define FS_PER_SECOND 1000000000000000UL
+
+// Worse than invariant tsc, but ticks at constant rate on any cpu
+#define HPET_RATING 250
+
+typedef struct __attribute__((__packed__)) {
+    u8 address_space;
+    u8 bit_width;
+    u8 bit_offset;
+    u8 access_size;
+    u64 address;
+} acpi_generic_address;
+
+typedef struct __attribute__((__packed__)) {
+    acpi_sdt_header header;
+    u32 event_timer_block_id;
+    acpi_generic_address address;
+    u8 hpet_number;
+    u16 minimum_tick;
+    u8 page_protection;
+} acpi_hpet;
+
+static volatile u64* hpet_base = NULL;
+static u64 frequency = 0;
+
+static u64 hpet_read_reg(u64 reg) { return hpet_base[reg / sizeof(u64)]; }
+
+static void hpet_write_reg(u64 reg, u64 value) {
+    hpet_base[reg / sizeof(u64)] = value;
+}
+
+static clocksource hpet_clocksource = {
+    .name = "hpet", .read = hpet_read, .rating = HPET_RATING};
+
+bool hpet_init() {
+    const acpi_hpet* table = (const acpi_hpet*) acpi_find_table(HPET_SIGNATURE);
+    if (!table)
+        return false;
+
+    volatile u64* base = (volatile u64*) P2V(table->address.address);
+    u64 capabilities = base[HPET_CAPABILITIES / sizeof(u64)];
+    u64 period_fs = capabilities >> CAPABILITIES_PERIOD_OFFSET;
+
+    // 32 bit counter wraps within minutes, which tickless kernel can sleep
+    // through
+    if (!(capabilities & CAPABILITIES_64_BIT_COUNTER) || !period_fs)
+        return false;
+
+    hpet_base = base;
+    frequency = FS_PER_SECOND / period_fs;
+    hpet_write_reg(HPET_CONFIG, hpet_read_reg(HPET_CONFIG) | CONFIG_ENABLE);
+
+    hpet_clocksource.frequency = frequency;
+    clocksource_register(&hpet_clocksource);
+    return true;
+}
+
+bool hpet_available() { return hpet_base != NULL; }
+
+u64 hpet_read() { return hpet_read_reg(HPET_MAIN_COUNTER); }
+
+u64 hpet_frequency() { return frequency; }
\ No newline at end of file
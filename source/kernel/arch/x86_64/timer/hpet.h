@@ -0,0 +1,14 @@
+#ifndef SOS_HPET_H
+#define SOS_HPET_H
+
+#include "../../../lib/types.h"
+
+// Enables main counter of hpet described by ACPI and registers it as
+// clocksource. Returns false if there is no usable hpet.
+bool hpet_init();
+bool hpet_available();
+
+u64 hpet_read();
+u64 hpet_frequency();
+
+#endif // SOS_HPET_H
\ No newline at end of file
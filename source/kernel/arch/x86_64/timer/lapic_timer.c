@@ -0,0 +1,121 @@
+#include "lapic_timer.h"
+#include "../../../interrupts/irq.h"
+#include "../../../interrupts/irq_chip.h"
+#include "../../../lib/kprint.h"
+#include "../../../synchronization/barriers.h"
+#include "../../../time/clockevent.h"
+#include "../../../time/timer.h"
+#include "../cpu/cpuid.h"
+#include "../cpu/msr.h"
+#include "../interrupts/isrs.h"
+#include "../interrupts/lapic.h"
+#include "pit.h"
+#include "tsc.h"
+
+#define IA32_TSC_DEADLINE_MSR 0x6E0
+
+#define LVT_MASKED (1 << 16)
+#define LVT_TIMER_ONESHOT (0b00 << 17)
+#define LVT_TIMER_TSC_DEADLINE (0b10 << 17)
+
+#define TIMER_DIVIDE_BY_16 0b0011
+
+#define CALIBRATION_US 10000
+#define MIN_DELTA_NS 1000
+#define TSC_DEADLINE_MAX_DELTA_NS 10000000000UL
+
+#define PIT_IRQ 0
+
+// Whether timer fires when tsc reaches deadline msr, rather than counting
+// down from initial count. Deadline mode needs no calibration of its own and
+// is programmed with single msr write.
+static bool tsc_deadline = false;
+static u64 frequency = 0; // of countdown after divider
+
+static void lapic_timer_set_next_event(u64 delta_ns) {
+    if (tsc_deadline) {
+        // msr write isn't ordered with earlier lvt mmio write in xapic mode
+        smp_mb();
+        msr_write(IA32_TSC_DEADLINE_MSR,
+                  tsc_read() + tsc_ns_to_cycles(delta_ns));
+        return;
+    }
+
+    u64 count = delta_ns * frequency / 1000000000UL;
+    lapic_write(LAPIC_TIMER_INITIAL_COUNT, count ? count : 1);
+}
+
+static void lapic_timer_stop() {
+    if (tsc_deadline)
+        msr_write(IA32_TSC_DEADLINE_MSR, 0);
+    else
+        lapic_write(LAPIC_TIMER_INITIAL_COUNT, 0);
+}
+
+static clockevent_device lapic_timer_device = {
+    .name = "lapic timer",
+    .min_delta_ns = MIN_DELTA_NS,
+    .set_next_event = lapic_timer_set_next_event,
+    .stop = lapic_timer_stop};
+
+static struct cpu_context* handle_lapic_timer(struct cpu_context* context) {
+    // acknowledge before schedule, since it may not return for a long time
+    lapic_eoi();
+    return handle_timer_interrupt(context);
+}
+
+static void calibrate() {
+    bool interrupts_enabled = local_irq_save();
+    lapic_write(LAPIC_LVT_TIMER, LVT_MASKED | LVT_TIMER_ONESHOT);
+    lapic_write(LAPIC_TIMER_DIVIDE, TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_TIMER_INITIAL_COUNT, 0xFFFFFFFF);
+    pit_delay_us(CALIBRATION_US);
+    u32 remaining = lapic_read(LAPIC_TIMER_CURRENT_COUNT);
+    lapic_write(LAPIC_TIMER_INITIAL_COUNT, 0);
+    local_irq_restore(interrupts_enabled);
+
+    frequency = (u64) (0xFFFFFFFF - remaining) * (1000000 / CALIBRATION_US);
+}
+
+void lapic_timer_init() {
+    u32 eax;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+    cpuid(CPUID_FEATURES, &eax, &ebx, &ecx, &edx);
+    tsc_deadline = (ecx >> CPUID_TSC_DEADLINE_FEATURE_OFFSET) & 1;
+
+    if (tsc_deadline) {
+        lapic_timer_device.max_delta_ns = TSC_DEADLINE_MAX_DELTA_NS;
+    } else {
+        calibrate();
+        if (!frequency) {
+            println("Local apic timer doesn't count, keeping pit tick");
+            return;
+        }
+
+        lapic_timer_device.max_delta_ns =
+            0xFFFFFFFFUL * 1000000000UL / frequency;
+    }
+
+    mount_irq_handler(LAPIC_TIMER_VECTOR, handle_lapic_timer);
+    clockevent_register(&lapic_timer_device);
+
+    // pit keeps counting for delays, but no longer interrupts
+    irq_mask(PIT_IRQ);
+
+    lapic_timer_init_cpu();
+}
+
+void lapic_timer_init_cpu() {
+    if (!clockevent_oneshot())
+        return;
+
+    u32 mode = tsc_deadline ? LVT_TIMER_TSC_DEADLINE : LVT_TIMER_ONESHOT;
+    lapic_write(LAPIC_TIMER_DIVIDE, TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_LVT_TIMER, mode | LAPIC_TIMER_VECTOR);
+
+    bool interrupts_enabled = local_irq_save();
+    clockevent_program(timer_now_ns());
+    local_irq_restore(interrupts_enabled);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef SOS_LAPIC_TIMER_H
+#define SOS_LAPIC_TIMER_H
+
+#include "../../../lib/types.h"
+
+#define LAPIC_TIMER_VECTOR 236
+
+// Calibrates local apic timer and makes it clock event device of all cpus.
+// Should be called on boot cpu after local apic and tsc are set up, stops
+// periodic pit interrupts.
+void lapic_timer_init();
+
+// Starts timer of current cpu if lapic_timer_init succeeded, first event
+// fires immediately
+void lapic_timer_init_cpu();
+
+#endif // SOS_LAPIC_TIMER_H
\ No newline at end of file
@@ -8,6 +8,7 @@ const u8 MODE_OFFSET = 1;
 const u8 BCD_OFFSET = 0;
 
 typedef enum {
+    LATCH = 0b00,
     LSB = 0b01,
     MSB = 0b10,
     LSB_THEN_MSB = 0b11
@@ -25,8 +26,11 @@ const u16 COUNTER_1_ADDR = 0x41;
 const u16 COUNTER_2_ADDR = 0x42;
 const u16 CONTROL_WORD_ADDR = 0x43;
 
-// frequency = 1193182 Hz / FREQUENCY_DIVIDER
-const u16 FREQUENCY_DIVIDER = (1 << 16) - 1;
+#define PIT_FREQUENCY 1193182
+#define TIMER_FREQUENCY 1000
+
+// frequency = 1193182 Hz / FREQUENCY_DIVIDER ~ 1000 Hz
+const u16 FREQUENCY_DIVIDER = PIT_FREQUENCY / TIMER_FREQUENCY;
 
 void pit_init() {
     outb(CONTROL_WORD_ADDR, gen_control_word(0, LSB_THEN_MSB, 2, false));
@@ -36,4 +40,25 @@ void pit_init() {
     io_wait();
     outb(COUNTER_0_ADDR, (FREQUENCY_DIVIDER >> 8) & 0xFF);
     io_wait();
+}
+
+static u16 pit_read_counter() {
+    outb(CONTROL_WORD_ADDR, gen_control_word(0, LATCH, 0, false));
+    u16 low = inb(COUNTER_0_ADDR);
+    u16 high = inb(COUNTER_0_ADDR);
+    return (high << 8) | low;
+}
+
+void pit_delay_us(u64 us) {
+    u64 target = us * PIT_FREQUENCY / 1000000;
+    u64 elapsed = 0;
+    u16 last = pit_read_counter();
+
+    // counter 0 counts down from FREQUENCY_DIVIDER and reloads when reaching
+    // zero, so it can be polled without relying on timer interrupts
+    while (elapsed < target) {
+        u16 now = pit_read_counter();
+        elapsed += last >= now ? last - now : last + (FREQUENCY_DIVIDER - now);
+        last = now;
+    }
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #ifndef SOS_PIT_H
 #define SOS_PIT_H
 
+#include "../../../lib/types.h"
+
 void pit_init();
 
+// Busy waits for at least `us` microseconds, usable with interrupts disabled
+void pit_delay_us(u64 us);
+
 #endif // SOS_PIT_H
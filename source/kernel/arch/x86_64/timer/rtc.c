@@ -0,0 +1,105 @@
+#include "../../../interrupts/irq.h"
+#include "../../common/timer.h"
+#include "../cpu/io.h"
+
+#define CMOS_ADDRESS 0x70
+#define CMOS_DATA 0x71
+
+#define RTC_SECONDS 0x00
+#define RTC_MINUTES 0x02
+#define RTC_HOURS 0x04
+#define RTC_DAY 0x07
+#define RTC_MONTH 0x08
+#define RTC_YEAR 0x09
+#define RTC_STATUS_A 0x0A
+#define RTC_STATUS_B 0x0B
+
+#define STATUS_A_UPDATE_IN_PROGRESS (1 << 7)
+#define STATUS_B_24_HOUR (1 << 1)
+#define STATUS_B_BINARY (1 << 2)
+#define HOURS_PM (1 << 7)
+
+// Century register is not standard, so two digit year is taken as 20xx
+#define CENTURY_START 2000
+
+typedef struct {
+    u8 seconds;
+    u8 minutes;
+    u8 hours;
+    u8 day;
+    u8 month;
+    u8 year;
+} rtc_time;
+
+static u8 cmos_read(u8 reg) {
+    outb(CMOS_ADDRESS, reg);
+    return inb(CMOS_DATA);
+}
+
+static rtc_time rtc_read_raw() {
+    while (cmos_read(RTC_STATUS_A) & STATUS_A_UPDATE_IN_PROGRESS) {
+    }
+
+    return (rtc_time){.seconds = cmos_read(RTC_SECONDS),
+                      .minutes = cmos_read(RTC_MINUTES),
+                      .hours = cmos_read(RTC_HOURS),
+                      .day = cmos_read(RTC_DAY),
+                      .month = cmos_read(RTC_MONTH),
+                      .year = cmos_read(RTC_YEAR)};
+}
+
+static bool rtc_time_equal(rtc_time a, rtc_time b) {
+    return a.seconds == b.seconds && a.minutes == b.minutes
+           && a.hours == b.hours && a.day == b.day && a.month == b.month
+           && a.year == b.year;
+}
+
+static u8 from_bcd(u8 value) { return (value >> 4) * 10 + (value & 0xF); }
+
+// Days from 1970-01-01 to provided date of proleptic gregorian calendar
+static u64 days_since_epoch(u64 year, u64 month, u64 day) {
+    // year is counted from march, so that leap day is the last one
+    if (month <= 2)
+        year--;
+
+    u64 era = year / 400;
+    u64 year_of_era = year - era * 400;
+    u64 month_from_march = month > 2 ? month - 3 : month + 9;
+    u64 day_of_year = (153 * month_from_march + 2) / 5 + day - 1;
+    u64 day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100
+                     + day_of_year;
+
+    // 719468 is number of days from 0000-03-01 to 1970-01-01
+    return era * 146097 + day_of_era - 719468;
+}
+
+u64 arch_wall_clock_seconds() {
+    bool interrupts_enabled = local_irq_save();
+
+    // registers may change between reads, so read until two reads agree
+    rtc_time time = rtc_read_raw();
+    rtc_time again;
+    while (!rtc_time_equal(time, again = rtc_read_raw())) {
+        time = again;
+    }
+    u8 status = cmos_read(RTC_STATUS_B);
+
+    local_irq_restore(interrupts_enabled);
+
+    bool pm = time.hours & HOURS_PM;
+    time.hours &= ~HOURS_PM;
+    if (!(status & STATUS_B_BINARY)) {
+        time.seconds = from_bcd(time.seconds);
+        time.minutes = from_bcd(time.minutes);
+        time.hours = from_bcd(time.hours);
+        time.day = from_bcd(time.day);
+        time.month = from_bcd(time.month);
+        time.year = from_bcd(time.year);
+    }
+    if (!(status & STATUS_B_24_HOUR))
+        time.hours = time.hours % 12 + (pm ? 12 : 0);
+
+    u64 year = CENTURY_START + time.year;
+    u64 days = days_since_epoch(year, time.month, time.day);
+    return ((days * 24 + time.hours) * 60 + time.minutes) * 60 + time.seconds;
+}
\ No newline at end of file
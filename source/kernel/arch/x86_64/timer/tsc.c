@@ -0,0 +1,129 @@
+#include "tsc.h"
+#include "../../../interrupts/irq.h"
+#include "../../../lib/kprint.h"
+#include "../../../time/clocksource.h"
+#include "../cpu/cpuid.h"
+#include "hpet.h"
+#include "pit.h"
+
+#define CALIBRATION_US 10000
+
+// ns are converted in fixed point: cycles = ns * mult >> shift. Shift keeps
+// multiplier within 64 bits for frequencies up to 1 THz.
+#define NS_TO_CYCLES_SHIFT 24
+
+// Invariant tsc is the cheapest and most precise source there is
+#define TSC_INVARIANT_RATING 300
+#define TSC_RATING 100
+
+static u64 frequency = 0;
+static u64 ns_to_cycles_mult = 0;
+static bool invariant = false;
+
+static clocksource tsc_clocksource = {
+    .name = "tsc", .read = tsc_read, .user_readable = true};
+
+u64 tsc_read() {
+    u32 low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((u64) high << 32) | low;
+}
+
+// Newer cpus report tsc frequency as ratio to crystal clock frequency, or at
+// least their base frequency, which tsc runs at
+static u64 cpuid_frequency() {
+    u32 max_leaf;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+    cpuid(CPUID_VENDOR, &max_leaf, &ebx, &ecx, &edx);
+    if (max_leaf < CPUID_TSC_FREQUENCY)
+        return 0;
+
+    u32 denominator;
+    u32 numerator;
+    u32 crystal_hz;
+    cpuid(CPUID_TSC_FREQUENCY, &denominator, &numerator, &crystal_hz, &edx);
+    if (denominator && numerator && crystal_hz)
+        return (u64) crystal_hz * numerator / denominator;
+
+    if (max_leaf < CPUID_PROCESSOR_FREQUENCY)
+        return 0;
+
+    u32 base_mhz;
+    cpuid(CPUID_PROCESSOR_FREQUENCY, &base_mhz, &ebx, &ecx, &edx);
+    return (u64) (base_mhz & 0xFFFF) * 1000000;
+}
+
+static u64 calibrate_against_hpet() {
+    u64 hpet_cycles = hpet_frequency() * CALIBRATION_US / 1000000;
+
+    u64 hpet_start = hpet_read();
+    u64 start = tsc_read();
+    u64 hpet_end;
+    do {
+        hpet_end = hpet_read();
+    } while (hpet_end - hpet_start < hpet_cycles);
+    u64 end = tsc_read();
+
+    return (end - start) * hpet_frequency() / (hpet_end - hpet_start);
+}
+
+static u64 calibrate_against_pit() {
+    u64 start = tsc_read();
+    pit_delay_us(CALIBRATION_US);
+    u64 end = tsc_read();
+
+    return (end - start) * (1000000 / CALIBRATION_US);
+}
+
+static bool check_invariant() {
+    u32 max_leaf;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+    cpuid(CPUID_EXT_VENDOR, &max_leaf, &ebx, &ecx, &edx);
+    if (max_leaf < CPUID_EXT_POWER_MANAGEMENT)
+        return false;
+
+    cpuid(CPUID_EXT_POWER_MANAGEMENT, &max_leaf, &ebx, &ecx, &edx);
+    return (edx >> CPUID_INVARIANT_TSC_FEATURE_OFFSET) & 1;
+}
+
+void tsc_init() {
+    const char* calibrated_by = "cpuid";
+    frequency = cpuid_frequency();
+
+    bool interrupts_enabled = local_irq_save();
+    if (!frequency && hpet_available()) {
+        calibrated_by = "hpet";
+        frequency = calibrate_against_hpet();
+    }
+    if (!frequency) {
+        calibrated_by = "pit";
+        frequency = calibrate_against_pit();
+    }
+    local_irq_restore(interrupts_enabled);
+
+    ns_to_cycles_mult = (frequency << NS_TO_CYCLES_SHIFT) / 1000000000UL;
+    invariant = check_invariant();
+
+    // tsc that may change its rate is still used if there is no hpet
+    tsc_clocksource.frequency = frequency;
+    tsc_clocksource.rating = invariant ? TSC_INVARIANT_RATING : TSC_RATING;
+    clocksource_register(&tsc_clocksource);
+
+    print("TSC frequency: ");
+    print_u64(frequency);
+    print(" Hz, calibrated by ");
+    print(calibrated_by);
+    println(invariant ? ", invariant" : ", not invariant");
+}
+
+u64 tsc_frequency() { return frequency; }
+
+bool tsc_invariant() { return invariant; }
+
+u64 tsc_ns_to_cycles(u64 ns) {
+    return ((unsigned __int128) ns * ns_to_cycles_mult) >> NS_TO_CYCLES_SHIFT;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef SOS_TSC_H
+#define SOS_TSC_H
+
+#include "../../../lib/types.h"
+
+// Determines tsc frequency from cpuid, or calibrates it against hpet or pit,
+// and registers tsc as clocksource. Should be called on boot cpu after pit and
+// hpet are initialized.
+void tsc_init();
+
+u64 tsc_read();
+u64 tsc_frequency();
+
+// Invariant tsc ticks at constant rate regardless of power states
+bool tsc_invariant();
+
+u64 tsc_ns_to_cycles(u64 ns);
+
+#endif // SOS_TSC_H
\ No newline at end of file
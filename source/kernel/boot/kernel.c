@@ -1,14 +1,24 @@
 #include "../arch/common/init.h"
+#include "../arch/common/smp.h"
 #include "../arch/common/vmm.h"
 #include "../interrupts/irq.h"
+#include "../lib/math.h"
+#include "../lib/panic.h"
 #include "../memory/heap/kheap.h"
+#include "../memory/heap/vmalloc.h"
+#include "../memory/virtual/shm.h"
+#include "../memory/virtual/vm_reaper.h"
 #include "../memory/virtual/vmm.h"
 #include "../threading/kthread.h"
 #include "../threading/scheduler.h"
 #include "../threading/thread_cleaner.h"
 #include "../threading/uthread.h"
+#include "../vdso/vdso.h"
 #include "multiboot.h"
 
+#define USER_IMAGE_VADDR 0x1000
+#define USER_IMAGE_PAGES_COUNT 16
+
 extern process init_process;
 
 void set_up(const multiboot_info* mboot_info) {
@@ -19,6 +29,9 @@ void set_up(const multiboot_info* mboot_info) {
 
     kheap_init();
     vmm_init();
+    vmalloc_init();
+    shm_init();
+    vdso_init();
 
     print("Finished kernel heap initialization! Heap initial size: ");
     print_u64(KHEAP_INITIAL_SIZE);
@@ -28,7 +41,9 @@ void set_up(const multiboot_info* mboot_info) {
     processing_init();
 
     thread_cleaner_init();
+    vm_reaper_init();
     scheduler_init();
+    arch_smp_init();
 
     println("Finished threading initialization!");
 
@@ -40,15 +55,30 @@ void set_up_init_process(module init_module) {
     vm_area_flags flags = {
         .writable = true, .user_access_allowed = true, .executable = true};
 
-    // temporary hardcoded loading of test.bin for test, which code and data are
-    // within single page, start is mapped to 0x1000, entrypoint is 0x1000
-    vm_space_map_page(init_process.vm, 0x1000, flags);
-    void* user_text = vm_space_get_page_view(init_process.vm, 0x1000);
-    memcpy(user_text, (void*) P2V(init_module.mod_start),
-           init_module.mod_end - init_module.mod_start);
+    // temporary hardcoded loading of test.bin for test, start is mapped to
+    // 0x1000, entrypoint is 0x1000. Flat binary doesn't tell its bss size, so
+    // whole image area is reserved, pages that are never touched cost nothing.
+    if (vm_space_map_pages_exactly(init_process.vm, USER_IMAGE_VADDR,
+                                   USER_IMAGE_PAGES_COUNT, flags) != SUCCESS)
+        panic("Can't reserve init process image area");
+
+    u64 size = init_module.mod_end - init_module.mod_start;
+    for (u64 offset = 0; offset < size; offset += PAGE_SIZE) {
+        vaddr page = USER_IMAGE_VADDR + offset;
+        if (!vm_space_resolve_page(init_process.vm, page, true))
+            panic("Can't map init process image");
+
+        // view is only returned for page with present leaf entry
+        void* user_text = vm_space_get_page_view(init_process.vm, page);
+        if (!user_text)
+            panic("Init process image page isn't mapped");
+
+        memcpy(user_text, (void*) P2V(init_module.mod_start + offset),
+               MIN(size - offset, PAGE_SIZE));
+    }
 
     thread_start(uthread_create_orphan(&init_process, "test", NULL,
-                                       (uthread_func*) 0x1000));
+                                       (uthread_func*) USER_IMAGE_VADDR));
 
     vm_space_print(init_process.vm);
 }
@@ -56,6 +56,16 @@ void parse_multiboot_tag(u64 ptr, MULTIBOOT_TAG_TYPE type,
         parse_multiboot_elf_symbols(ptr, dst);
         break;
 
+    case ACPI_NEW_RSDP:
+        dst->acpi_rsdp = (paddr) V2P(ptr + sizeof(tag_header));
+        break;
+
+    case ACPI_OLD_RSDP:
+        // prefer ACPI 2.0+ RSDP, if both are present
+        if (!dst->acpi_rsdp)
+            dst->acpi_rsdp = (paddr) V2P(ptr + sizeof(tag_header));
+        break;
+
     case MODULES:
         dst->modules_count++;
 
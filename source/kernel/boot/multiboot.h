@@ -86,6 +86,7 @@ typedef struct {
     memory_map mmap;
     elf_sections elf_sections;
     u32 modules_count;
+    paddr acpi_rsdp; // NULL if bootloader did not provide copy of RSDP
 } multiboot_info;
 
 multiboot_info parse_multiboot_info(void* multiboot_info_ptr);
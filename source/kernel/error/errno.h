@@ -127,5 +127,8 @@
 #define EISNAM 120         /* Is a named type file */
 #define EREMOTEIO 121      /* Remote I/O error */
 #define EDQUOT 122         /* Quota exceeded */
+#define ENOMEDIUM 123      /* No medium found */
+#define EMEDIUMTYPE 124    /* Wrong medium type */
+#define ECANCELED 125      /* Operation Canceled */
 
 #endif // SOS_ERRNO_H
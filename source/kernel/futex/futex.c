@@ -0,0 +1,353 @@
+#include "futex.h"
+#include "../arch/common/vmm.h"
+#include "../error/errno.h"
+#include "../error/error.h"
+#include "../lib/container/linked_list/linked_list.h"
+#include "../memory/memory_map.h"
+#include "../memory/physical/page.h"
+#include "../memory/physical/pmm.h"
+#include "../memory/virtual/vmm.h"
+#include "../synchronization/atomics.h"
+#include "../synchronization/wait.h"
+#include "../threading/scheduler.h"
+
+#define FUTEX_HASH_BITS 8
+#define FUTEX_BUCKETS_COUNT (1 << FUTEX_HASH_BITS)
+
+// 2^64 / golden ratio, spreads neighbouring words over buckets
+#define FUTEX_HASH_MULTIPLIER 0x9E3779B97F4A7C15
+
+#define WAKE_OP_OP(op) (((op) >> 28) & 0x7)
+#define WAKE_OP_OPARG_SHIFT(op) (((op) >> 28) & FUTEX_OP_OPARG_SHIFT)
+#define WAKE_OP_CMP(op) (((op) >> 24) & 0xF)
+#define WAKE_OP_OPARG(op) (((op) >> 12) & 0xFFF)
+#define WAKE_OP_CMPARG(op) ((op) & 0xFFF)
+
+typedef struct {
+    lock lock;
+    linked_list waiters;
+} futex_bucket;
+
+/*
+ * Waiter lives on stack of sleeping thread. It may be moved to other bucket by
+ * requeue, so bucket it is in is guarded by both bucket locks. Woken flag is
+ * set under bucket lock and own waiter lock, which thread sleeps on, so that
+ * wakeup can't be lost and thread can tell whether it was woken up on timeout
+ * or signal.
+ */
+typedef struct {
+    paddr key;
+    thread* thrd;
+    futex_bucket* volatile bucket;
+    linked_list_node node;
+
+    lock lock;
+    volatile bool woken;
+} futex_waiter;
+
+static futex_bucket buckets[FUTEX_BUCKETS_COUNT] = {
+    [0 ... FUTEX_BUCKETS_COUNT - 1] = {
+        .lock = SPIN_LOCK_STATIC_INITIALIZER,
+        .waiters = LINKED_LIST_STATIC_INITIALIZER}};
+
+static futex_bucket* bucket_of(paddr key) {
+    return &buckets[(key * FUTEX_HASH_MULTIPLIER) >> (64 - FUTEX_HASH_BITS)];
+}
+
+// Translates user address of futex word into physical one. Page is populated
+// for write in writable areas, so that untouched pages don't all share zero
+// frame and so the same key. Frame is referenced until futex_key_put, so that
+// concurrent unmap can't free it while word is accessed through its key.
+static u64 futex_key(u32* uaddr, bool write, paddr* key) {
+    if ((u64) uaddr % sizeof(u32) != 0)
+        return -EINVAL;
+
+    vm_space* space = vmm_current_vm_space();
+    rw_spin_lock_write_irq(&space->lock);
+    vm_area* area =
+        vm_space_get_surrounding_area(space, (vaddr) uaddr, sizeof(u32));
+
+    void* view = NULL;
+    if (area && (!write || area->flags.writable)
+        && vm_space_resolve_page(space, (vaddr) uaddr, area->flags.writable))
+        view = vm_space_get_page_view(space, (vaddr) uaddr);
+
+    page_descriptor* page = view ? frame_to_page(V2P(view)) : NULL;
+    if (page)
+        page_ref(page);
+    rw_spin_unlock_write_irq(&space->lock);
+
+    if (!view)
+        return -EFAULT;
+
+    *key = V2P(view) + (u64) uaddr % PAGE_SIZE;
+    return 0;
+}
+
+static void futex_key_put(paddr key) { pmm_put_frame(key & ~(PAGE_SIZE - 1)); }
+
+// Word is read through kernel mapping, so that it can be done while holding
+// bucket lock
+static volatile u32* futex_word(paddr key) { return (volatile u32*) P2V(key); }
+
+// Should be called with bucket lock held
+static void wake_waiter(futex_waiter* waiter) {
+    linked_list_remove_node(&waiter->bucket->waiters, &waiter->node);
+
+    spin_lock(&waiter->lock);
+    waiter->woken = true;
+    schedule_thread(waiter->thrd);
+    spin_unlock(&waiter->lock);
+}
+
+// Should be called with bucket lock held
+static u64 wake_bucket(futex_bucket* bucket, paddr key, u64 count) {
+    u64 woken = 0;
+    LINKED_LIST_FOR_EACH(&bucket->waiters, node) {
+        if (woken == count)
+            break;
+
+        futex_waiter* waiter = node->value;
+        if (waiter->key == key) {
+            wake_waiter(waiter);
+            woken++;
+        }
+    }
+
+    return woken;
+}
+
+// Buckets are always locked in address order
+static bool lock_buckets(futex_bucket* first, futex_bucket* second) {
+    if (first > second) {
+        futex_bucket* temp = first;
+        first = second;
+        second = temp;
+    }
+
+    bool interrupts_enabled = spin_lock_irq_save(&first->lock);
+    if (second != first)
+        spin_lock(&second->lock);
+
+    return interrupts_enabled;
+}
+
+static void unlock_buckets(futex_bucket* first, futex_bucket* second,
+                           bool interrupts_enabled) {
+    if (second != first)
+        spin_unlock(&second->lock);
+    spin_unlock_irq_restore(&first->lock, interrupts_enabled);
+}
+
+// Locks bucket waiter is currently in, it may change until it is locked
+static futex_bucket* lock_waiter_bucket(futex_waiter* waiter,
+                                        bool* interrupts_enabled) {
+    while (true) {
+        futex_bucket* bucket = waiter->bucket;
+        *interrupts_enabled = spin_lock_irq_save(&bucket->lock);
+        if (bucket == waiter->bucket)
+            return bucket;
+
+        spin_unlock_irq_restore(&bucket->lock, *interrupts_enabled);
+    }
+}
+
+// Caller holds reference to frame of futex word, so it can be read by key
+static u64 futex_wait_key(paddr key, u32 val, u64 deadline_ns) {
+    futex_waiter waiter = {.key = key,
+                           .thrd = get_current_thread(),
+                           .bucket = bucket_of(key),
+                           .node = LINKED_LIST_NODE_OF(&waiter),
+                           .lock = SPIN_LOCK_STATIC_INITIALIZER,
+                           .woken = false};
+
+    // value is compared under bucket lock, so that waker which changes it
+    // before waking either is seen here or sees this waiter in bucket
+    bool interrupts_enabled = spin_lock_irq_save(&waiter.bucket->lock);
+    if (*futex_word(key) != val) {
+        spin_unlock_irq_restore(&waiter.bucket->lock, interrupts_enabled);
+        return -EAGAIN;
+    }
+    linked_list_add_last_node(&waiter.bucket->waiters, &waiter.node);
+    spin_unlock_irq_restore(&waiter.bucket->lock, interrupts_enabled);
+
+    interrupts_enabled = spin_lock_irq_save(&waiter.lock);
+    u64 result = WAIT_FOR_IRQ_INTERRUPTABLE_TIMED(
+        &waiter.lock, interrupts_enabled, waiter.woken, deadline_ns);
+    spin_unlock_irq_restore(&waiter.lock, interrupts_enabled);
+
+    if (!result)
+        return 0;
+
+    // waker could come after timeout or signal, then wakeup is consumed. Once
+    // bucket lock is taken, waker is done with waiter.
+    futex_bucket* bucket = lock_waiter_bucket(&waiter, &interrupts_enabled);
+    if (waiter.woken)
+        result = 0;
+    else
+        linked_list_remove_node(&bucket->waiters, &waiter.node);
+    spin_unlock_irq_restore(&bucket->lock, interrupts_enabled);
+
+    return result;
+}
+
+u64 futex_wait(u32* uaddr, u32 val, u64 deadline_ns) {
+    paddr key;
+    u64 result = futex_key(uaddr, false, &key);
+    if (IS_ERROR(result))
+        return result;
+
+    result = futex_wait_key(key, val, deadline_ns);
+    futex_key_put(key);
+    return result;
+}
+
+u64 futex_wake(u32* uaddr, u64 count) {
+    paddr key;
+    u64 result = futex_key(uaddr, false, &key);
+    if (IS_ERROR(result))
+        return result;
+
+    futex_bucket* bucket = bucket_of(key);
+    bool interrupts_enabled = spin_lock_irq_save(&bucket->lock);
+    u64 woken = wake_bucket(bucket, key, count);
+    spin_unlock_irq_restore(&bucket->lock, interrupts_enabled);
+
+    futex_key_put(key);
+    return woken;
+}
+
+u64 futex_requeue(u32* uaddr, u64 wake_count, u64 requeue_count, u32* uaddr2,
+                  bool check, u32 val) {
+    paddr key;
+    paddr key2;
+    u64 result = futex_key(uaddr, false, &key);
+    if (IS_ERROR(result))
+        return result;
+
+    result = futex_key(uaddr2, false, &key2);
+    if (IS_ERROR(result)) {
+        futex_key_put(key);
+        return result;
+    }
+
+    futex_bucket* bucket = bucket_of(key);
+    futex_bucket* bucket2 = bucket_of(key2);
+    bool interrupts_enabled = lock_buckets(bucket, bucket2);
+
+    if (check && *futex_word(key) != val) {
+        unlock_buckets(bucket, bucket2, interrupts_enabled);
+        futex_key_put(key);
+        futex_key_put(key2);
+        return -EAGAIN;
+    }
+
+    u64 woken = wake_bucket(bucket, key, wake_count);
+
+    u64 requeued = 0;
+    LINKED_LIST_FOR_EACH(&bucket->waiters, node) {
+        if (requeued == requeue_count)
+            break;
+
+        futex_waiter* waiter = node->value;
+        if (waiter->key != key)
+            continue;
+
+        linked_list_remove_node(&bucket->waiters, node);
+        waiter->key = key2;
+        waiter->bucket = bucket2;
+        linked_list_add_last_node(&bucket2->waiters, node);
+        requeued++;
+    }
+
+    unlock_buckets(bucket, bucket2, interrupts_enabled);
+
+    futex_key_put(key);
+    futex_key_put(key2);
+    return woken + requeued;
+}
+
+static u32 apply_op(u32 old, u32 op) {
+    u32 oparg = WAKE_OP_OPARG(op);
+    if (WAKE_OP_OPARG_SHIFT(op))
+        oparg = oparg < 32 ? 1U << oparg : 0;
+
+    switch (WAKE_OP_OP(op)) {
+    case FUTEX_OP_SET:
+        return oparg;
+    case FUTEX_OP_ADD:
+        return old + oparg;
+    case FUTEX_OP_OR:
+        return old | oparg;
+    case FUTEX_OP_ANDN:
+        return old & ~oparg;
+    default: // FUTEX_OP_XOR
+        return old ^ oparg;
+    }
+}
+
+static bool compare(u32 old, u32 op) {
+    i32 value = (i32) old;
+    i32 cmparg = WAKE_OP_CMPARG(op);
+
+    switch (WAKE_OP_CMP(op)) {
+    case FUTEX_OP_CMP_EQ:
+        return value == cmparg;
+    case FUTEX_OP_CMP_NE:
+        return value != cmparg;
+    case FUTEX_OP_CMP_LT:
+        return value < cmparg;
+    case FUTEX_OP_CMP_LE:
+        return value <= cmparg;
+    case FUTEX_OP_CMP_GT:
+        return value > cmparg;
+    default: // FUTEX_OP_CMP_GE
+        return value >= cmparg;
+    }
+}
+
+static bool valid_op(u32 op) {
+    return WAKE_OP_OP(op) <= FUTEX_OP_XOR
+           && WAKE_OP_CMP(op) <= FUTEX_OP_CMP_GE;
+}
+
+u64 futex_wake_op(u32* uaddr, u64 wake_count, u32* uaddr2, u64 wake_count2,
+                  u32 op) {
+    if (!valid_op(op))
+        return -EINVAL;
+
+    paddr key;
+    paddr key2;
+    u64 result = futex_key(uaddr, false, &key);
+    if (IS_ERROR(result))
+        return result;
+
+    result = futex_key(uaddr2, true, &key2);
+    if (IS_ERROR(result)) {
+        futex_key_put(key);
+        return result;
+    }
+
+    futex_bucket* bucket = bucket_of(key);
+    futex_bucket* bucket2 = bucket_of(key2);
+    bool interrupts_enabled = lock_buckets(bucket, bucket2);
+
+    // user space may change word concurrently, so it is updated atomically
+    volatile u32* word = futex_word(key2);
+    u32 old = *word;
+    u32 found;
+    while ((found = atomic_compare_exchange_u32(word, old, apply_op(old, op)))
+           != old) {
+        old = found;
+    }
+
+    u64 woken = wake_bucket(bucket, key, wake_count);
+    if (compare(old, op))
+        woken += wake_bucket(bucket2, key2, wake_count2);
+
+    unlock_buckets(bucket, bucket2, interrupts_enabled);
+
+    futex_key_put(key);
+    futex_key_put(key2);
+    return woken;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef SOS_FUTEX_H
+#define SOS_FUTEX_H
+
+#include "../lib/types.h"
+
+/*
+ * Fast user space mutex support. User space keeps lock state in 32 bit word
+ * and enters kernel only to sleep while word holds value it expects or to wake
+ * threads sleeping on the word. Waiters are hashed by physical address of the
+ * word, so that word mapped into several processes (e.g. shared memory) or at
+ * several addresses is the same futex.
+ */
+
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+#define FUTEX_REQUEUE 3
+#define FUTEX_CMP_REQUEUE 4
+#define FUTEX_WAKE_OP 5
+
+// FUTEX_WAKE_OP operation encoding, oparg and cmparg are 12 bit unsigned:
+// (op << 28) | (cmp << 24) | (oparg << 12) | cmparg
+#define FUTEX_OP_SET 0  // *uaddr2 = oparg
+#define FUTEX_OP_ADD 1  // *uaddr2 += oparg
+#define FUTEX_OP_OR 2   // *uaddr2 |= oparg
+#define FUTEX_OP_ANDN 3 // *uaddr2 &= ~oparg
+#define FUTEX_OP_XOR 4  // *uaddr2 ^= oparg
+
+#define FUTEX_OP_OPARG_SHIFT 8 // use 1 << oparg as operand
+
+#define FUTEX_OP_CMP_EQ 0
+#define FUTEX_OP_CMP_NE 1
+#define FUTEX_OP_CMP_LT 2
+#define FUTEX_OP_CMP_LE 3
+#define FUTEX_OP_CMP_GT 4
+#define FUTEX_OP_CMP_GE 5
+
+// Sleeps while word at uaddr is equal to val, until woken up, signal arrives
+// or monotonic time reaches deadline. Returns 0 if woken up, -EAGAIN if word
+// has different value, -EINTR or -ETIMEDOUT.
+u64 futex_wait(u32* uaddr, u32 val, u64 deadline_ns);
+
+// Wakes up to count waiters, returns count of woken ones
+u64 futex_wake(u32* uaddr, u64 count);
+
+// Wakes up to wake_count waiters of uaddr and moves up to requeue_count of
+// the rest to uaddr2. If check is set, fails with -EAGAIN unless word at
+// uaddr is equal to val. Returns count of woken and moved waiters.
+u64 futex_requeue(u32* uaddr, u64 wake_count, u64 requeue_count, u32* uaddr2,
+                  bool check, u32 val);
+
+// Atomically applies encoded operation to word at uaddr2, wakes up to
+// wake_count waiters of uaddr and, if old value of uaddr2 passes encoded
+// comparison, up to wake_count2 waiters of uaddr2. Returns count of woken.
+u64 futex_wake_op(u32* uaddr, u64 wake_count, u32* uaddr2, u64 wake_count2,
+                  u32 op);
+
+#endif // SOS_FUTEX_H
\ No newline at end of file
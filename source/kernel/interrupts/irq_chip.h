@@ -0,0 +1,29 @@
+#ifndef SOS_IRQ_CHIP_H
+#define SOS_IRQ_CHIP_H
+
+#include "../lib/types.h"
+
+// Interrupt controller that delivers hardware irqs. Irqs are numbered by
+// legacy isa lines, independently of how controller routes them.
+typedef struct {
+    const char* name;
+
+    void (*mask)(u8 irq);
+    void (*unmask)(u8 irq);
+
+    // Acknowledges irq, called before its handler runs
+    void (*eoi)(u8 irq);
+
+    // Delivers irq to provided cpu, returns false if controller can't do that
+    bool (*set_affinity)(u8 irq, u64 cpu);
+} irq_chip;
+
+// Should be called on boot cpu before interrupts are enabled
+void irq_chip_set(const irq_chip* chip);
+const irq_chip* irq_chip_get();
+
+void irq_mask(u8 irq);
+void irq_unmask(u8 irq);
+bool irq_set_affinity(u8 irq, u64 cpu);
+
+#endif // SOS_IRQ_CHIP_H
\ No newline at end of file
@@ -0,0 +1,424 @@
+#include "io_ring.h"
+#include "../arch/common/vmm.h"
+#include "../error/errno.h"
+#include "../error/error.h"
+#include "../lib/alignment.h"
+#include "../lib/kprint.h"
+#include "../lib/math.h"
+#include "../memory/heap/kheap.h"
+#include "../memory/heap/vmalloc.h"
+#include "../memory/memory_map.h"
+#include "../memory/virtual/shm.h"
+#include "../memory/virtual/umem.h"
+#include "../synchronization/barriers.h"
+#include "../synchronization/con_var.h"
+#include "../synchronization/mutex.h"
+#include "../threading/scheduler.h"
+
+// String is copied from user memory and printed by chunks of this size
+#define PRINT_CHUNK_SIZE 128
+
+// Submission consumed by kernel, but not completed yet
+typedef struct {
+    io_ring_sqe sqe;
+    thread* submitter; // only compared to current thread, never dereferenced
+} io_ring_request;
+
+// Header is writable by user space, so kernel keeps its own copy of
+// everything but user owned counters
+typedef struct io_ring {
+    // Immutable data
+    shm_segment* segment;
+    io_ring_header* header;
+    vaddr base;
+    u32 sq_entries;
+    u32 cq_entries;
+    u32 sq_offset;
+    u32 cq_offset;
+    // End of immutable data
+
+    mutex mutex; // guards fields below
+    u32 sq_head;
+    u32 cq_tail;
+    io_ring_request* inflight; // in submission order
+    u64 inflight_count;
+
+    lock lock; // guards fields below
+    u64 events; // bumped whenever in-flight requests may complete
+    con_var events_cvar;
+} io_ring;
+
+static const vm_area_flags IO_RING_FLAGS = {.writable = true,
+                                            .user_access_allowed = true,
+                                            .executable = false,
+                                            .shared = true};
+
+// Segment frames are scattered, but entries never cross page boundary, since
+// queues start at page boundary and entry sizes divide page size
+static void* ring_entry(io_ring* ring, u64 offset, u64 index, u64 size) {
+    u64 position = offset + index * size;
+    return (void*) (P2V(ring->segment->frames[position / PAGE_SIZE])
+                    + position % PAGE_SIZE);
+}
+
+static u64 map_result_to_error(vm_page_mapping_result result) {
+    switch (result) {
+    case SUCCESS:
+        return 0;
+    case ALREADY_MAPPED:
+        return -EEXIST;
+    case INVALID_RANGE:
+    case UNAUTHORIZED:
+        return -EINVAL;
+    case OUT_OF_MEMORY:
+        return -ENOMEM;
+    }
+
+    __builtin_unreachable();
+}
+
+u64 io_ring_setup(u64 entries, vaddr base) {
+    if (!entries || entries > IO_RING_MAX_ENTRIES
+        || (entries & (entries - 1)) != 0 || base % PAGE_SIZE != 0)
+        return -EINVAL;
+
+    process* proc = get_current_thread()->proc;
+    u64 result = -ENOMEM;
+
+    io_ring* ring = kmalloc(sizeof(io_ring));
+    if (!ring)
+        goto failed_to_allocate_ring;
+
+    // completion queue is twice as large, so that requests in flight don't
+    // stop submission queue from being drained
+    ring->sq_entries = entries;
+    ring->cq_entries = entries * 2;
+    ring->sq_offset = PAGE_SIZE;
+    ring->cq_offset =
+        ring->sq_offset
+        + align_to_upper(entries * sizeof(io_ring_sqe), PAGE_SIZE);
+    u64 size = ring->cq_offset
+               + align_to_upper(ring->cq_entries * sizeof(io_ring_cqe),
+                                PAGE_SIZE);
+
+    ring->inflight = kvmalloc(ring->cq_entries * sizeof(io_ring_request));
+    if (!ring->inflight)
+        goto failed_to_allocate_inflight;
+
+    ring->segment = shm_segment_create(size / PAGE_SIZE);
+    if (!ring->segment)
+        goto failed_to_create_segment;
+    shm_segment_ref(ring->segment);
+
+    ring->header = (io_ring_header*) P2V(ring->segment->frames[0]);
+    ring->header->sq_entries = ring->sq_entries;
+    ring->header->cq_entries = ring->cq_entries;
+    ring->header->sq_offset = ring->sq_offset;
+    ring->header->cq_offset = ring->cq_offset;
+
+    ring->base = base;
+    ring->sq_head = 0;
+    ring->cq_tail = 0;
+    ring->inflight_count = 0;
+    ring->events = 0;
+    mutex_init(&ring->mutex);
+    ring->lock = SPIN_LOCK_STATIC_INITIALIZER;
+    con_var_init(&ring->events_cvar);
+
+    rw_spin_lock_write_irq(&proc->vm->lock);
+    result = map_result_to_error(
+        vm_space_map_shared(proc->vm, base, ring->segment, IO_RING_FLAGS));
+    rw_spin_unlock_write_irq(&proc->vm->lock);
+
+    if (IS_ERROR(result))
+        goto failed_to_map;
+
+    bool interrupts_enabled = spin_lock_irq_save(&proc->lock);
+    bool published = !proc->io_ring;
+    if (published)
+        proc->io_ring = ring;
+    spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
+
+    if (published)
+        return 0;
+
+    result = -EBUSY;
+    io_ring_unmap(ring, proc->vm);
+
+failed_to_map:
+    shm_segment_unref(ring->segment);
+
+failed_to_create_segment:
+    kvfree(ring->inflight);
+
+failed_to_allocate_inflight:
+    kfree(ring);
+
+failed_to_allocate_ring:
+    return result;
+}
+
+static u64 ring_events(io_ring* ring) {
+    bool interrupts_enabled = spin_lock_irq_save(&ring->lock);
+    u64 events = ring->events;
+    spin_unlock_irq_restore(&ring->lock, interrupts_enabled);
+
+    return events;
+}
+
+// Completions user space hasn't reaped yet, head is written by user, so it
+// can't be trusted
+static u64 completions_ready(io_ring* ring) {
+    u32 ready = ring->cq_tail - ring->header->cq_head;
+    return MIN(ready, ring->cq_entries);
+}
+
+// Completion queue always has room for every request in flight
+static u64 completions_free(io_ring* ring) {
+    u64 used = completions_ready(ring) + ring->inflight_count;
+    return used < ring->cq_entries ? ring->cq_entries - used : 0;
+}
+
+static void post_completion(io_ring* ring, u64 user_data, u64 result) {
+    u64 slot = ring->cq_tail & (ring->cq_entries - 1);
+    io_ring_cqe* cqe =
+        ring_entry(ring, ring->cq_offset, slot, sizeof(io_ring_cqe));
+    cqe->user_data = user_data;
+    cqe->result = result;
+
+    // entry should be visible before tail that publishes it
+    smp_wb();
+    ring->header->cq_tail = ++ring->cq_tail;
+}
+
+static u64 run_print(u64 str_ptr) {
+    char buffer[PRINT_CHUNK_SIZE];
+    const char* str = (const char*) str_ptr;
+    while (true) {
+        u64 copied = copy_string_from_user(buffer, str, PRINT_CHUNK_SIZE);
+        if (IS_ERROR(copied))
+            return copied;
+
+        print(buffer);
+        if (copied < PRINT_CHUNK_SIZE - 1)
+            return 0;
+
+        str += copied;
+    }
+}
+
+static u64 run_wait(u64 pid, u64 exit_code_ptr) {
+    u64 exit_code;
+    u64 result = process_try_wait(pid, &exit_code);
+    if (IS_ERROR(result))
+        return result;
+
+    if (exit_code_ptr
+        && !copy_to_user((void*) exit_code_ptr, &exit_code, sizeof(u64)))
+        return -EFAULT;
+
+    return result;
+}
+
+// Thread handle comes from user space, so it is only compared to threads of
+// current process and never dereferenced unless one of them matches. Child
+// can't go away meanwhile, since only its parent (current thread) removes it.
+static thread* find_process_thread(u64 handle) {
+    process* proc = get_current_thread()->proc;
+    thread* found = NULL;
+
+    bool interrupts_enabled = spin_lock_irq_save(&proc->lock);
+    ARRAY_LIST_FOR_EACH(&proc->threads, thread * iter) {
+        if ((u64) iter == handle) {
+            found = iter;
+            break;
+        }
+    }
+    spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
+
+    return found;
+}
+
+static u64 run_join(u64 handle, u64 exit_code_ptr) {
+    thread* child = find_process_thread(handle);
+    if (!child)
+        return -ESRCH;
+
+    u64 exit_code;
+    u64 result = thread_try_join(child, &exit_code);
+    if (IS_ERROR(result))
+        return result;
+
+    if (exit_code_ptr
+        && !copy_to_user((void*) exit_code_ptr, &exit_code, sizeof(u64)))
+        return -EFAULT;
+
+    return 0;
+}
+
+// Returns -EAGAIN if request can't complete yet
+static u64 run_request(io_ring_request* request) {
+    u64* args = request->sqe.args;
+
+    switch (request->sqe.opcode) {
+    case IO_OP_NOP:
+        return 0;
+    case IO_OP_PRINT:
+        return run_print(args[0]);
+    case IO_OP_PRINT_U64:
+        print_u64(args[0]);
+        return 0;
+    case IO_OP_WAIT:
+        return run_wait(args[0], args[1]);
+    case IO_OP_PTHREAD_JOIN:
+        // only thread that started child can join it
+        if (request->submitter != get_current_thread())
+            return -EAGAIN;
+        return run_join(args[0], args[1]);
+    default:
+        return -EINVAL;
+    }
+}
+
+// Should be called with ring mutex held
+static u64 submit(io_ring* ring, u64 to_submit) {
+    u32 tail = ring->header->sq_tail;
+    // entries should be read after tail that publishes them
+    smp_rb();
+
+    u64 submitted = 0;
+    while (submitted < to_submit && ring->sq_head != tail
+           && completions_free(ring)) {
+        // copied, since user space may change entry at any moment
+        u64 slot = ring->sq_head & (ring->sq_entries - 1);
+        io_ring_request request = {.submitter = get_current_thread()};
+        request.sqe = *(io_ring_sqe*) ring_entry(ring, ring->sq_offset, slot,
+                                                 sizeof(io_ring_sqe));
+        ring->sq_head++;
+        submitted++;
+
+        u64 result = run_request(&request);
+        if (result == (u64) -EAGAIN)
+            ring->inflight[ring->inflight_count++] = request;
+        else
+            post_completion(ring, request.sqe.user_data, result);
+    }
+
+    ring->header->sq_head = ring->sq_head;
+    return submitted;
+}
+
+// Should be called with ring mutex held, keeps order of requests left
+static void run_inflight(io_ring* ring) {
+    u64 left = 0;
+    for (u64 i = 0; i < ring->inflight_count; i++) {
+        io_ring_request* request = &ring->inflight[i];
+        u64 result = run_request(request);
+        if (result == (u64) -EAGAIN)
+            ring->inflight[left++] = *request;
+        else
+            post_completion(ring, request->sqe.user_data, result);
+    }
+
+    ring->inflight_count = left;
+}
+
+// Should be called with ring mutex held
+static bool should_stop_waiting(io_ring* ring, u64 min_complete) {
+    return completions_ready(ring) >= min_complete || !ring->inflight_count;
+}
+
+// Returns false if interrupted by signal
+static bool wait_for_event(io_ring* ring, u64 seen_events) {
+    bool interrupted = false;
+
+    bool interrupts_enabled = spin_lock_irq_save(&ring->lock);
+    while (ring->events == seen_events && !interrupted) {
+        interrupted = !con_var_wait_interruptable_irq_save(
+            &ring->events_cvar, &ring->lock, &interrupts_enabled);
+    }
+    spin_unlock_irq_restore(&ring->lock, interrupts_enabled);
+
+    return !interrupted;
+}
+
+u64 io_ring_enter(u64 to_submit, u64 min_complete) {
+    io_ring* ring = get_current_thread()->proc->io_ring;
+    if (!ring)
+        return -EINVAL;
+
+    min_complete = MIN(min_complete, ring->cq_entries);
+
+    // events are sampled before requests run, so that completion which
+    // happens meanwhile isn't missed
+    u64 events = ring_events(ring);
+    mutex_lock(&ring->mutex);
+    u64 submitted = submit(ring, to_submit);
+    bool done = should_stop_waiting(ring, min_complete);
+    mutex_unlock(&ring->mutex);
+
+    while (!done) {
+        if (!wait_for_event(ring, events))
+            return submitted ? submitted : (u64) -EINTR;
+
+        events = ring_events(ring);
+        mutex_lock(&ring->mutex);
+        run_inflight(ring);
+        done = should_stop_waiting(ring, min_complete);
+        mutex_unlock(&ring->mutex);
+    }
+
+    return submitted;
+}
+
+void io_ring_notify(process* proc) {
+    io_ring* ring = proc->io_ring;
+    if (!ring)
+        return;
+
+    bool interrupts_enabled = spin_lock_irq_save(&ring->lock);
+    ring->events++;
+    con_var_broadcast(&ring->events_cvar);
+    spin_unlock_irq_restore(&ring->lock, interrupts_enabled);
+}
+
+void io_ring_thread_exit(thread* thrd) {
+    io_ring* ring = thrd->proc->io_ring;
+    if (!ring)
+        return;
+
+    // exiting thread joins its children itself
+    mutex_lock(&ring->mutex);
+    u64 left = 0;
+    for (u64 i = 0; i < ring->inflight_count; i++) {
+        io_ring_request* request = &ring->inflight[i];
+        if (request->submitter == thrd
+            && request->sqe.opcode == IO_OP_PTHREAD_JOIN)
+            post_completion(ring, request->sqe.user_data, -ECANCELED);
+        else
+            ring->inflight[left++] = *request;
+    }
+    ring->inflight_count = left;
+    mutex_unlock(&ring->mutex);
+
+    io_ring_notify(thrd->proc);
+}
+
+void io_ring_unmap(io_ring* ring, vm_space* space) {
+    if (!ring)
+        return;
+
+    rw_spin_lock_write_irq(&space->lock);
+    vm_space_unmap_shared(space, ring->base);
+    rw_spin_unlock_write_irq(&space->lock);
+}
+
+void io_ring_destroy(io_ring* ring) {
+    if (!ring)
+        return;
+
+    // mapping holds its own reference, if it still exists
+    shm_segment_unref(ring->segment);
+    kvfree(ring->inflight);
+    kfree(ring);
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef SOS_IO_RING_H
+#define SOS_IO_RING_H
+
+#include "../lib/types.h"
+#include "../memory/virtual/vm.h"
+#include "../threading/thread.h"
+
+/*
+ * Asynchronous syscall interface. Process shares ring buffers with kernel:
+ * user space queues submissions into submission queue (SQ), kernel consumes
+ * them on io_enter and posts completions into completion queue (CQ), which
+ * user space reaps without entering kernel. Operations that can't complete
+ * right away stay in flight inside kernel and are retried whenever something
+ * they may wait for happens, so one thread can keep many of them in flight.
+ *
+ * Ring is a single shared area: header page, then SQ entries, then CQ entries.
+ * Producer of each queue advances its tail, consumer advances its head. Both
+ * are free running counters, slot index is counter & (entries - 1). Layout is
+ * mirrored by user library.
+ */
+
+#define IO_RING_MAX_ENTRIES 1024
+
+#define IO_OP_NOP 0
+#define IO_OP_PRINT 1        // args[0] - string
+#define IO_OP_PRINT_U64 2    // args[0] - number
+#define IO_OP_WAIT 3         // args[0] - pid, args[1] - exit code pointer
+#define IO_OP_PTHREAD_JOIN 4 // args[0] - thread, args[1] - exit code pointer
+
+typedef struct {
+    volatile u32 sq_head; // written by kernel
+    volatile u32 sq_tail; // written by user
+    volatile u32 cq_head; // written by user
+    volatile u32 cq_tail; // written by kernel
+
+    u32 sq_entries;
+    u32 cq_entries;
+    u32 sq_offset; // of SQ entries from start of ring
+    u32 cq_offset; // of CQ entries from start of ring
+} io_ring_header;
+
+typedef struct {
+    u64 opcode;
+    u64 user_data; // copied into completion as is
+    u64 args[6];
+} io_ring_sqe;
+
+typedef struct {
+    u64 user_data;
+    u64 result; // return value of operation, negative error code on failure
+} io_ring_cqe;
+
+// Creates ring with `entries` submission slots (power of two) and maps it at
+// `base` in current process, returns 0 or negative error code. Process may
+// have only one ring.
+u64 io_ring_setup(u64 entries, vaddr base);
+
+// Consumes up to `to_submit` submissions, then waits until at least
+// `min_complete` completions are ready to be reaped. Returns count of consumed
+// submissions or negative error code if none were consumed.
+u64 io_ring_enter(u64 to_submit, u64 min_complete);
+
+// Something in-flight operations of process may wait for has happened
+void io_ring_notify(process* proc);
+
+// Completes operations only exiting thread could finish, so that they don't
+// stay in flight forever
+void io_ring_thread_exit(thread* thrd);
+
+// Removes ring mapping from vm space, used on fork since ring belongs to
+// parent only
+void io_ring_unmap(struct io_ring* ring, vm_space* space);
+
+// Should be called when process is destroyed, ring may be NULL
+void io_ring_destroy(struct io_ring* ring);
+
+#endif // SOS_IO_RING_H
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "hash_table.h"
 #include "../../../memory/heap/kheap.h"
+#include "../../../memory/heap/vmalloc.h"
 #include "../../kprint.h"
 
 #define INITIAL_BUCKETS_NUM 16
@@ -7,7 +8,7 @@
 static bool hash_table_grow(hash_table* table) {
     u64 new_buckets_num = table->buckets_num * 2;
     linked_list* new_buckets =
-        (linked_list*) kmalloc(new_buckets_num * sizeof(linked_list));
+        (linked_list*) kvmalloc(new_buckets_num * sizeof(linked_list));
 
     if (!new_buckets)
         return false;
@@ -30,7 +31,7 @@ static bool hash_table_grow(hash_table* table) {
         }
     }
 
-    kfree(table->buckets);
+    kvfree(table->buckets);
 
     table->buckets = new_buckets;
     table->buckets_num = new_buckets_num;
@@ -55,7 +56,7 @@ bool hash_table_init(hash_table* table) {
     table->size = 0;
     table->buckets_num = INITIAL_BUCKETS_NUM;
     table->buckets =
-        (linked_list*) kmalloc(table->buckets_num * sizeof(linked_list));
+        (linked_list*) kvmalloc(table->buckets_num * sizeof(linked_list));
 
     if (!table->buckets)
         return false;
@@ -83,7 +84,7 @@ void hash_table_deinit(hash_table* table) {
         }
     }
 
-    kfree(table->buckets);
+    kvfree(table->buckets);
     table->buckets = NULL;
     table->buckets_num = 0;
     table->size = 0;
@@ -0,0 +1,264 @@
+#include "rb_tree.h"
+
+void rb_tree_init(rb_tree* tree, rb_tree_less* less) {
+    tree->root = NULL;
+    tree->leftmost = NULL;
+    tree->size = 0;
+    tree->less = less;
+}
+
+rb_tree_node* rb_tree_first(rb_tree* tree) { return tree->leftmost; }
+
+static rb_tree_node* rb_tree_minimum(rb_tree_node* node) {
+    while (node->left) {
+        node = node->left;
+    }
+
+    return node;
+}
+
+rb_tree_node* rb_tree_next(rb_tree_node* node) {
+    if (node->right)
+        return rb_tree_minimum(node->right);
+
+    rb_tree_node* parent = node->parent;
+    while (parent && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+
+    return parent;
+}
+
+static bool is_red(rb_tree_node* node) { return node && node->red; }
+
+// Puts `new` in place of `old` in old's parent
+static void replace_child(rb_tree* tree, rb_tree_node* old, rb_tree_node* new) {
+    rb_tree_node* parent = old->parent;
+    if (!parent)
+        tree->root = new;
+    else if (old == parent->left)
+        parent->left = new;
+    else
+        parent->right = new;
+
+    if (new)
+        new->parent = parent;
+}
+
+static void rotate_left(rb_tree* tree, rb_tree_node* node) {
+    rb_tree_node* right = node->right;
+
+    node->right = right->left;
+    if (right->left)
+        right->left->parent = node;
+
+    replace_child(tree, node, right);
+    right->left = node;
+    node->parent = right;
+}
+
+static void rotate_right(rb_tree* tree, rb_tree_node* node) {
+    rb_tree_node* left = node->left;
+
+    node->left = left->right;
+    if (left->right)
+        left->right->parent = node;
+
+    replace_child(tree, node, left);
+    left->right = node;
+    node->parent = left;
+}
+
+static void insert_fixup(rb_tree* tree, rb_tree_node* node) {
+    rb_tree_node* parent;
+    while ((parent = node->parent) && parent->red) {
+        // red node is never root, so grandparent exists
+        rb_tree_node* grandparent = parent->parent;
+
+        if (parent == grandparent->left) {
+            rb_tree_node* uncle = grandparent->right;
+            if (is_red(uncle)) {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+                continue;
+            }
+
+            if (node == parent->right) {
+                rotate_left(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+
+            parent->red = false;
+            grandparent->red = true;
+            rotate_right(tree, grandparent);
+        } else {
+            rb_tree_node* uncle = grandparent->left;
+            if (is_red(uncle)) {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+                continue;
+            }
+
+            if (node == parent->left) {
+                rotate_right(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+
+            parent->red = false;
+            grandparent->red = true;
+            rotate_left(tree, grandparent);
+        }
+    }
+
+    tree->root->red = false;
+}
+
+void rb_tree_insert(rb_tree* tree, rb_tree_node* node) {
+    rb_tree_node* parent = NULL;
+    rb_tree_node** link = &tree->root;
+    bool leftmost = true;
+
+    while (*link) {
+        parent = *link;
+        if (tree->less(node, parent)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            leftmost = false;
+        }
+    }
+
+    node->parent = parent;
+    node->left = NULL;
+    node->right = NULL;
+    node->red = true;
+    *link = node;
+
+    if (leftmost)
+        tree->leftmost = node;
+
+    tree->size++;
+    insert_fixup(tree, node);
+}
+
+// Restores black height after black node removal, `node` took its place and
+// may be NULL, hence parent is passed separately
+static void remove_fixup(rb_tree* tree, rb_tree_node* node,
+                         rb_tree_node* parent) {
+
+    while (node != tree->root && !is_red(node)) {
+        if (node == parent->left) {
+            rb_tree_node* sibling = parent->right;
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (!is_red(sibling->right)) {
+                sibling->left->red = false;
+                sibling->red = true;
+                rotate_right(tree, sibling);
+                sibling = parent->right;
+            }
+
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->right->red = false;
+            rotate_left(tree, parent);
+            node = tree->root;
+        } else {
+            rb_tree_node* sibling = parent->left;
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (!is_red(sibling->left)) {
+                sibling->right->red = false;
+                sibling->red = true;
+                rotate_left(tree, sibling);
+                sibling = parent->left;
+            }
+
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->left->red = false;
+            rotate_right(tree, parent);
+            node = tree->root;
+        }
+    }
+
+    if (node)
+        node->red = false;
+}
+
+void rb_tree_remove(rb_tree* tree, rb_tree_node* node) {
+    if (tree->leftmost == node)
+        tree->leftmost = rb_tree_next(node);
+
+    rb_tree_node* child;
+    rb_tree_node* child_parent;
+    bool removed_red = node->red;
+
+    if (!node->left) {
+        child = node->right;
+        child_parent = node->parent;
+        replace_child(tree, node, child);
+    } else if (!node->right) {
+        child = node->left;
+        child_parent = node->parent;
+        replace_child(tree, node, child);
+    } else {
+        // node is replaced with its successor, which has no left child
+        rb_tree_node* successor = rb_tree_minimum(node->right);
+        removed_red = successor->red;
+        child = successor->right;
+
+        if (successor->parent == node) {
+            child_parent = successor;
+        } else {
+            child_parent = successor->parent;
+            replace_child(tree, successor, child);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+
+        replace_child(tree, node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->red = node->red;
+    }
+
+    if (!removed_red)
+        remove_fixup(tree, child, child_parent);
+
+    node->parent = NULL;
+    node->left = NULL;
+    node->right = NULL;
+    tree->size--;
+}
@@ -0,0 +1,40 @@
+#ifndef SOS_RB_TREE_H
+#define SOS_RB_TREE_H
+
+#include "../../types.h"
+
+// Intrusive red-black tree, nodes are embedded into stored values, so tree
+// operations never allocate memory
+typedef struct rb_tree_node {
+    void* value;
+    struct rb_tree_node* parent;
+    struct rb_tree_node* left;
+    struct rb_tree_node* right;
+    bool red;
+} rb_tree_node;
+
+typedef bool rb_tree_less(const rb_tree_node* a, const rb_tree_node* b);
+
+typedef struct {
+    rb_tree_node* root;
+    rb_tree_node* leftmost; // cached minimum
+    u64 size;
+    rb_tree_less* less;
+} rb_tree;
+
+#define RB_TREE_NODE_OF(val)                                                   \
+    { .value = val, .parent = NULL, .left = NULL, .right = NULL, .red = false }
+
+#define RB_TREE_STATIC_INITIALIZER(less_func)                                  \
+    { .root = NULL, .leftmost = NULL, .size = 0, .less = less_func }
+
+void rb_tree_init(rb_tree* tree, rb_tree_less* less);
+
+// Nodes that are equal to already inserted ones are placed after them
+void rb_tree_insert(rb_tree* tree, rb_tree_node* node);
+void rb_tree_remove(rb_tree* tree, rb_tree_node* node);
+
+rb_tree_node* rb_tree_first(rb_tree* tree);
+rb_tree_node* rb_tree_next(rb_tree_node* node);
+
+#endif // SOS_RB_TREE_H
@@ -20,4 +20,16 @@ void memcpy(void* dst, void* src, u64 len) {
     for (u64 i = 0; i < len; i++) {
         _dst[i] = _src[i];
     }
+}
+
+int memcmp(const void* left, const void* right, u64 len) {
+    const u8* _left = (const u8*) left;
+    const u8* _right = (const u8*) right;
+
+    for (u64 i = 0; i < len; i++) {
+        if (_left[i] != _right[i])
+            return _left[i] < _right[i] ? -1 : 1;
+    }
+
+    return 0;
 }
\ No newline at end of file
@@ -5,5 +5,6 @@
 
 void* memset(void* dst, u8 val, u64 len);
 void memcpy(void* dst, void* src, u64 len);
+int memcmp(const void* left, const void* right, u64 len);
 
 #endif // SOS_MEMORY_UTIL_H
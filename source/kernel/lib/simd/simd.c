@@ -0,0 +1,43 @@
+#include "simd.h"
+#include "../../arch/common/fpu.h"
+#include "../../arch/common/vmm.h"
+#include "../memory_util.h"
+#include "simd_kernels.h"
+
+void simd_clear_page(void* page) {
+    if (!kernel_fpu_usable()) {
+        memset(page, 0, PAGE_SIZE);
+        return;
+    }
+
+    bool interrupts_enabled = kernel_fpu_begin();
+    simd_kernel_clear(page, PAGE_SIZE);
+    kernel_fpu_end(interrupts_enabled);
+}
+
+void simd_copy_page(void* dst, void* src) {
+    if (!kernel_fpu_usable()) {
+        memcpy(dst, src, PAGE_SIZE);
+        return;
+    }
+
+    bool interrupts_enabled = kernel_fpu_begin();
+    simd_kernel_copy(dst, src, PAGE_SIZE);
+    kernel_fpu_end(interrupts_enabled);
+}
+
+// Whole blocks are compared with vector registers, then plain memcmp finds
+// differing byte inside mismatching block or compares the tail
+int simd_memcmp(const void* left, const void* right, u64 len) {
+    u64 blocks_len = len & ~(u64) (SIMD_BLOCK_SIZE - 1);
+    u64 offset = 0;
+
+    if (blocks_len && kernel_fpu_usable()) {
+        bool interrupts_enabled = kernel_fpu_begin();
+        offset = simd_kernel_mismatch(left, right, blocks_len);
+        kernel_fpu_end(interrupts_enabled);
+    }
+
+    return memcmp((const u8*) left + offset, (const u8*) right + offset,
+                  len - offset);
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef SOS_SIMD_H
+#define SOS_SIMD_H
+
+#include "../types.h"
+
+// Memory routines which use vector registers inside kernel fpu section. Until
+// fpu of current cpu is set up they fall back to plain ones.
+
+void simd_clear_page(void* page);
+void simd_copy_page(void* dst, void* src);
+
+int simd_memcmp(const void* left, const void* right, u64 len);
+
+#endif // SOS_SIMD_H
\ No newline at end of file
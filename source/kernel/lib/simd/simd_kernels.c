@@ -0,0 +1,52 @@
+#include "simd_kernels.h"
+
+/*
+ * This file is built without -mgeneral-regs-only, so compiler may use vector
+ * registers anywhere in it. Keep nothing here which could run outside of
+ * kernel_fpu_begin/end section.
+ */
+
+typedef u64 vector __attribute__((vector_size(16)));
+typedef u64 unaligned_vector __attribute__((vector_size(16), aligned(1)));
+
+#define VECTORS_PER_BLOCK (SIMD_BLOCK_SIZE / sizeof(vector))
+
+void simd_kernel_clear(void* dst, u64 len) {
+    vector* _dst = (vector*) dst;
+    vector zero = {0, 0};
+
+    for (u64 i = 0; i < len / sizeof(vector); i += VECTORS_PER_BLOCK) {
+        for (u64 j = 0; j < VECTORS_PER_BLOCK; j++) {
+            _dst[i + j] = zero;
+        }
+    }
+}
+
+void simd_kernel_copy(void* dst, const void* src, u64 len) {
+    vector* _dst = (vector*) dst;
+    const vector* _src = (const vector*) src;
+
+    for (u64 i = 0; i < len / sizeof(vector); i += VECTORS_PER_BLOCK) {
+        for (u64 j = 0; j < VECTORS_PER_BLOCK; j++) {
+            _dst[i + j] = _src[i + j];
+        }
+    }
+}
+
+u64 simd_kernel_mismatch(const void* left, const void* right, u64 len) {
+    const unaligned_vector* _left = (const unaligned_vector*) left;
+    const unaligned_vector* _right = (const unaligned_vector*) right;
+
+    for (u64 i = 0; i < len / sizeof(vector); i += VECTORS_PER_BLOCK) {
+        // xor of equal blocks is zero, or-ing lets check whole block at once
+        vector diff = {0, 0};
+        for (u64 j = 0; j < VECTORS_PER_BLOCK; j++) {
+            diff |= _left[i + j] ^ _right[i + j];
+        }
+
+        if (diff[0] | diff[1])
+            return i * sizeof(vector);
+    }
+
+    return len;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef SOS_SIMD_KERNELS_H
+#define SOS_SIMD_KERNELS_H
+
+#include "../types.h"
+
+/*
+ * Loops over vector registers. They must be called only inside
+ * kernel_fpu_begin/end section, see simd.h for wrappers that do it.
+ * Lengths are multiples of SIMD_BLOCK_SIZE.
+ */
+
+#define SIMD_BLOCK_SIZE 64
+
+// dst is SIMD_BLOCK_SIZE aligned
+void simd_kernel_clear(void* dst, u64 len);
+// dst and src are SIMD_BLOCK_SIZE aligned
+void simd_kernel_copy(void* dst, const void* src, u64 len);
+
+// Returns offset of first block which differs or len if none
+u64 simd_kernel_mismatch(const void* left, const void* right, u64 len);
+
+#endif // SOS_SIMD_KERNELS_H
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "vmalloc.h"
+#include "../../arch/common/vmm.h"
+#include "../../lib/alignment.h"
+#include "../../lib/container/array_list/array_list.h"
+#include "../../lib/panic.h"
+#include "../../synchronization/spin_lock.h"
+#include "../virtual/vmm.h"
+#include "kheap.h"
+
+// Each allocation is followed by unmapped guard page, so that overflows fault
+// instead of silently corrupting neighbour allocation
+#define VMALLOC_GUARD_PAGES 1
+#define VMALLOC_AREAS_INITIAL_CAPACITY 16
+
+typedef struct {
+    vaddr base;
+    u64 pages;
+} vmalloc_area;
+
+static const vm_area_flags VMALLOC_FLAGS = {.writable = true};
+
+static lock vmalloc_lock = SPIN_LOCK_STATIC_INITIALIZER;
+static array_list areas; // sorted by base address
+
+void vmalloc_init() {
+    if (!array_list_init(&areas, VMALLOC_AREAS_INITIAL_CAPACITY))
+        panic("Can't init vmalloc areas list");
+}
+
+// Returns index where area of provided size should be inserted to keep areas
+// sorted, and sets base of free range of that size, or returns false if
+// vmalloc area is exhausted
+static bool vmalloc_find_free_range(u64 pages, vaddr* base, u64* idx) {
+    u64 span = (pages + VMALLOC_GUARD_PAGES) * PAGE_SIZE;
+    vaddr candidate = VMALLOC_START_VADDR;
+
+    u64 i = 0;
+    for (; i < areas.size; i++) {
+        vmalloc_area* area = array_list_get(&areas, i);
+        if (candidate + span <= area->base)
+            break;
+
+        candidate =
+            area->base + (area->pages + VMALLOC_GUARD_PAGES) * PAGE_SIZE;
+    }
+
+    if (candidate + span - 1 > VMALLOC_END_VADDR)
+        return false;
+
+    *base = candidate;
+    *idx = i;
+    return true;
+}
+
+void* vmalloc(u64 size) {
+    if (!size)
+        return NULL;
+
+    u64 pages = align_to_upper(size, PAGE_SIZE) / PAGE_SIZE;
+    vmalloc_area* area = (vmalloc_area*) kmalloc(sizeof(vmalloc_area));
+    if (!area)
+        return NULL;
+
+    vm_space* kernel_space = vmm_kernel_vm_space();
+    bool interrupts_enabled = spin_lock_irq_save(&vmalloc_lock);
+
+    u64 idx;
+    if (!vmalloc_find_free_range(pages, &area->base, &idx))
+        goto failed;
+
+    area->pages = pages;
+
+    rw_spin_lock_write_irq(&kernel_space->lock);
+    vm_page_mapping_result mapped = vm_space_map_pages_exactly(
+        kernel_space, area->base, pages, VMALLOC_FLAGS);
+    rw_spin_unlock_write_irq(&kernel_space->lock);
+
+    if (mapped != SUCCESS)
+        goto failed;
+
+    if (!array_list_insert(&areas, idx, area)) {
+        rw_spin_lock_write_irq(&kernel_space->lock);
+        vm_space_unmap_pages(kernel_space, area->base, pages);
+        rw_spin_unlock_write_irq(&kernel_space->lock);
+        goto failed;
+    }
+
+    spin_unlock_irq_restore(&vmalloc_lock, interrupts_enabled);
+    return (void*) area->base;
+
+failed:
+    spin_unlock_irq_restore(&vmalloc_lock, interrupts_enabled);
+    kfree(area);
+    return NULL;
+}
+
+void vfree(void* addr) {
+    vm_space* kernel_space = vmm_kernel_vm_space();
+    bool interrupts_enabled = spin_lock_irq_save(&vmalloc_lock);
+
+    vmalloc_area* area = NULL;
+    u64 idx = 0;
+    for (; idx < areas.size; idx++) {
+        vmalloc_area* iter = array_list_get(&areas, idx);
+        if (iter->base == (vaddr) addr) {
+            area = iter;
+            break;
+        }
+    }
+
+    if (!area)
+        panic("Invalid address passed to vfree");
+
+    rw_spin_lock_write_irq(&kernel_space->lock);
+    vm_space_unmap_pages(kernel_space, area->base, area->pages);
+    rw_spin_unlock_write_irq(&kernel_space->lock);
+
+    array_list_remove_idx(&areas, idx);
+    spin_unlock_irq_restore(&vmalloc_lock, interrupts_enabled);
+
+    kfree(area);
+}
+
+void* kvmalloc(u64 size) {
+    return size >= VMALLOC_THRESHOLD ? vmalloc(size) : kmalloc(size);
+}
+
+void kvfree(void* addr) {
+    vaddr address = (vaddr) addr;
+    if (address >= VMALLOC_START_VADDR && address <= VMALLOC_END_VADDR)
+        vfree(addr);
+    else
+        kfree(addr);
+}
@@ -0,0 +1,27 @@
+#ifndef SOS_VMALLOC_H
+#define SOS_VMALLOC_H
+
+#include "../../lib/types.h"
+
+/*
+ * Allocator for large, long-lived kernel allocations. Memory is virtually
+ * contiguous inside vmalloc area, but is backed by scattered physical frames,
+ * so it does not require large contiguous free block inside kernel heap.
+ * Allocation granularity is one page, so it should not be used for small
+ * objects.
+ */
+
+// allocations of this size and above are served by vmalloc in kvmalloc
+#define VMALLOC_THRESHOLD 0x4000 // 16KiB
+
+void vmalloc_init();
+
+void* vmalloc(u64 size);
+void vfree(void* addr);
+
+// Chooses kmalloc or vmalloc depending on requested size
+void* kvmalloc(u64 size);
+// Frees memory allocated either by kmalloc or by vmalloc
+void kvfree(void* addr);
+
+#endif // SOS_VMALLOC_H
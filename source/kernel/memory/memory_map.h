@@ -22,7 +22,9 @@
 // ffff800000000000 | -128  TB | ffff87ffffffffff | Kernel code
 // ffff888000000000 | -119.5TB | ffffc87fffffffff | Direct mapping of all
 //                  |          |                  | physical memory
-// ffffc88000000000 | -55.5 TB |                  | Kernel heap
+// ffffc88000000000 | -55.5 TB | ffffc97fffffffff | Kernel heap
+// ffffca0000000000 | -54   TB | ffffcaffffffffff | Vmalloc area (virtually
+//                  |          |                  | contiguous allocations)
 //__________________|__________|__________________|_____________________________
 
 #define paddr u64
@@ -36,6 +38,8 @@
 #define KERNEL_VMAPPED_RAM_START_VADDR 0XFFFF888000000000 // 273 entry in p4
 #define KERNEL_VMAPPED_RAM_END_VADDR 0XFFFFC87FFFFFFFFF   // 401 entry in p4
 #define KHEAP_START_VADDR 0xffffc88000000000
+#define VMALLOC_START_VADDR 0xffffca0000000000
+#define VMALLOC_END_VADDR 0xffffcaffffffffff
 
 #define NON_CANONICAL_START (USER_SPACE_END_VADDR + 1)
 #define NON_CANONICAL_END (KERNEL_START_VADDR - 1)
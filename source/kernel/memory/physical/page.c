@@ -0,0 +1,76 @@
+#include "page.h"
+#include "../../arch/common/vmm.h"
+#include "../../lib/panic.h"
+#include "../../synchronization/atomics.h"
+
+static page_descriptor* descriptors = NULL;
+static u64 descriptors_count = 0;
+
+u64 page_descriptors_table_size(paddr memory_end) {
+    return (memory_end / PAGE_SIZE + 1) * sizeof(page_descriptor);
+}
+
+void page_descriptors_init(paddr table, paddr memory_end) {
+    descriptors = (page_descriptor*) P2V(table);
+    descriptors_count = memory_end / PAGE_SIZE + 1;
+
+    for (u64 pfn = 0; pfn < descriptors_count; pfn++) {
+        descriptors[pfn] = (page_descriptor){.next = NULL,
+                                             .prev = NULL,
+                                             .refcount = 0,
+                                             .mapcount = 0,
+                                             .flags = PAGE_RESERVED,
+                                             .private = 0};
+    }
+}
+
+u64 page_descriptors_count() { return descriptors_count; }
+
+page_descriptor* pfn_to_page(u64 pfn) {
+    if (pfn >= descriptors_count)
+        return NULL;
+
+    return &descriptors[pfn];
+}
+
+page_descriptor* frame_to_page(paddr frame) {
+    return pfn_to_page(frame / PAGE_SIZE);
+}
+
+u64 page_to_pfn(const page_descriptor* page) { return page - descriptors; }
+
+paddr page_to_frame(const page_descriptor* page) {
+    return page_to_pfn(page) * PAGE_SIZE;
+}
+
+void page_ref(page_descriptor* page) { atomic_increment_u32(&page->refcount); }
+
+bool page_unref(page_descriptor* page) {
+    if (page->refcount == 0)
+        panic("Page refcount is less than 0");
+
+    return atomic_decrement_and_get_u32(&page->refcount) == 0;
+}
+
+void page_mapped(page_descriptor* page) {
+    atomic_increment_u32(&page->mapcount);
+}
+
+u32 page_unmapped(page_descriptor* page) {
+    if (page->mapcount == 0)
+        panic("Page mapcount is less than 0");
+
+    return atomic_decrement_and_get_u32(&page->mapcount);
+}
+
+void page_set_flags(page_descriptor* page, u32 flags) {
+    atomic_or_u32(&page->flags, flags);
+}
+
+void page_clear_flags(page_descriptor* page, u32 flags) {
+    atomic_and_u32(&page->flags, ~flags);
+}
+
+bool page_has_flags(const page_descriptor* page, u32 flags) {
+    return (page->flags & flags) == flags;
+}
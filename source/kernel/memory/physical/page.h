@@ -0,0 +1,61 @@
+#ifndef SOS_PAGE_H
+#define SOS_PAGE_H
+
+#include "../memory_map.h"
+
+// frame is not managed by pmm (kernel image, boot data, holes, this table)
+#define PAGE_RESERVED (1 << 0)
+// frame is inside pmm free list
+#define PAGE_FREE (1 << 1)
+// frame must never be freed or reclaimed (e.g. shared zero frame)
+#define PAGE_PINNED (1 << 2)
+// frame is owned by shared object rather than by page tables mapping it
+#define PAGE_SHARED (1 << 3)
+
+/*
+ * Descriptor of single physical frame. Descriptors are kept in one array
+ * indexed by page frame number (PFN) and are 32 bytes long, so that two of
+ * them share single cache line.
+ *
+ * refcount counts owners of frame (pmm hands out frames with refcount of 1),
+ * mapcount counts page table entries that map frame. Both of them and flags
+ * are updated atomically. List linkage and `private` belong to current owner
+ * of frame.
+ */
+typedef struct page_descriptor {
+    struct page_descriptor* next;
+    struct page_descriptor* prev;
+    volatile u32 refcount;
+    volatile u32 mapcount;
+    volatile u32 flags;
+    u32 private;
+} page_descriptor;
+
+// Returns size in bytes of descriptor table covering memory up to
+// `memory_end` (inclusive)
+u64 page_descriptors_table_size(paddr memory_end);
+// Places descriptor table at `table` frames, all descriptors start reserved
+void page_descriptors_init(paddr table, paddr memory_end);
+
+u64 page_descriptors_count();
+
+// These return NULL for frames outside of physical memory
+page_descriptor* pfn_to_page(u64 pfn);
+page_descriptor* frame_to_page(paddr frame);
+
+u64 page_to_pfn(const page_descriptor* page);
+paddr page_to_frame(const page_descriptor* page);
+
+void page_ref(page_descriptor* page);
+// Returns true if last reference was dropped
+bool page_unref(page_descriptor* page);
+
+void page_mapped(page_descriptor* page);
+// Returns number of page table entries that still map frame
+u32 page_unmapped(page_descriptor* page);
+
+void page_set_flags(page_descriptor* page, u32 flags);
+void page_clear_flags(page_descriptor* page, u32 flags);
+bool page_has_flags(const page_descriptor* page, u32 flags);
+
+#endif // SOS_PAGE_H
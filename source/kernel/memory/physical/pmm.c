@@ -2,13 +2,31 @@
 #include "../../arch/common/vmm.h"
 #include "../../boot/multiboot.h"
 #include "../../lib/memory_util.h"
+#include "../../lib/panic.h"
+#include "../../lib/simd/simd.h"
 #include "../../synchronization/spin_lock.h"
+#include "page.h"
 
 lock pmm_lock = SPIN_LOCK_STATIC_INITIALIZER;
 
 volatile paddr last_available_frame = NULL;
 volatile u64 available = 0;
 
+// Called with frame not yet visible to other cpus (or with pmm lock held)
+static void pmm_mark_frame_free(paddr frame) {
+    page_descriptor* page = frame_to_page(frame);
+    if (!page)
+        panic("Freeing frame outside of physical memory");
+    if (page->flags & PAGE_FREE)
+        panic("Double free of physical frame");
+    if (page->flags & PAGE_PINNED)
+        panic("Freeing pinned physical frame");
+
+    page->flags = PAGE_FREE;
+    page->refcount = 0;
+    page->mapcount = 0;
+}
+
 paddr pmm_allocate_frame() {
     bool interrupts_enabled = spin_lock_irq_save(&pmm_lock);
     if (!last_available_frame) {
@@ -20,6 +38,10 @@ paddr pmm_allocate_frame() {
     last_available_frame = *(paddr*) P2V(last_available_frame);
     available--;
 
+    page_descriptor* page = frame_to_page(allocated);
+    page->flags = 0;
+    page->refcount = 1;
+
     spin_unlock_irq_restore(&pmm_lock, interrupts_enabled);
     return allocated;
 }
@@ -29,19 +51,60 @@ paddr pmm_allocate_zeroed_frame() {
     if (!frame)
         return NULL;
 
-    memset((void*) P2V(frame), 0, PAGE_SIZE);
+    simd_clear_page((void*) P2V(frame));
     return frame;
 }
 
 void pmm_free_frame(paddr frame) {
     frame &= ~(PAGE_SIZE - 1);
     bool interrupts_enabled = spin_lock_irq_save(&pmm_lock);
+    pmm_mark_frame_free(frame);
     *(paddr*) P2V(frame) = last_available_frame;
     last_available_frame = frame;
     available++;
     spin_unlock_irq_restore(&pmm_lock, interrupts_enabled);
 }
 
+void pmm_frame_batch_add(pmm_frame_batch* batch, paddr frame) {
+    frame &= ~(PAGE_SIZE - 1);
+    pmm_mark_frame_free(frame);
+    *(paddr*) P2V(frame) = batch->first;
+    batch->first = frame;
+    if (!batch->last)
+        batch->last = frame;
+
+    batch->count++;
+}
+
+// Returns true if caller dropped last reference to frame managed by pmm
+static bool pmm_unref_frame(paddr frame) {
+    page_descriptor* page = frame_to_page(frame);
+    return page && !(page->flags & PAGE_RESERVED) && page_unref(page);
+}
+
+void pmm_put_frame(paddr frame) {
+    if (pmm_unref_frame(frame))
+        pmm_free_frame(frame);
+}
+
+void pmm_frame_batch_put(pmm_frame_batch* batch, paddr frame) {
+    if (pmm_unref_frame(frame))
+        pmm_frame_batch_add(batch, frame);
+}
+
+void pmm_free_frame_batch(pmm_frame_batch* batch) {
+    if (!batch->count)
+        return;
+
+    bool interrupts_enabled = spin_lock_irq_save(&pmm_lock);
+    *(paddr*) P2V(batch->last) = last_available_frame;
+    last_available_frame = batch->first;
+    available += batch->count;
+    spin_unlock_irq_restore(&pmm_lock, interrupts_enabled);
+
+    *batch = (pmm_frame_batch) PMM_FRAME_BATCH_STATIC_INITIALIZER;
+}
+
 u64 pmm_frames_available() {
     bool interrupts_enabled = spin_lock_irq_save(&pmm_lock);
     u64 result = available;
@@ -3,9 +3,36 @@
 
 #include "../memory_map.h"
 
+#define PMM_FRAME_BATCH_SIZE 512
+
+/*
+ * Chain of frames that are going to be freed. Frames are linked through their
+ * own memory (same way as free frames are), so batch can be returned to pmm
+ * with single lock acquisition regardless of its size.
+ */
+typedef struct {
+    paddr first;
+    paddr last;
+    u64 count;
+} pmm_frame_batch;
+
+#define PMM_FRAME_BATCH_STATIC_INITIALIZER                                     \
+    { .first = NULL, .last = NULL, .count = 0 }
+
 paddr pmm_allocate_frame();
 paddr pmm_allocate_zeroed_frame();
 void pmm_free_frame(paddr frame);
 u64 pmm_frames_available();
 
+// Drops one reference to frame (see page_ref) and frees it once last one is
+// gone. Frames that are not managed by pmm are never freed.
+void pmm_put_frame(paddr frame);
+
+// Does not take pmm lock, since batch is owned by caller
+void pmm_frame_batch_add(pmm_frame_batch* batch, paddr frame);
+// Same as pmm_put_frame, except frame goes to batch once last reference is gone
+void pmm_frame_batch_put(pmm_frame_batch* batch, paddr frame);
+// Returns all frames of batch to pmm and leaves batch empty
+void pmm_free_frame_batch(pmm_frame_batch* batch);
+
 #endif // SOS_PHYSICAL_MEMORY_MANAGER_H
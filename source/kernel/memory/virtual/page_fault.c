@@ -1,5 +1,6 @@
 #include "page_fault.h"
 #include "../../arch/common/context.h"
+#include "../../arch/common/vmm.h"
 #include "../../threading/scheduler.h"
 
 struct cpu_context* handle_page_fault(struct cpu_context* context) {
@@ -9,9 +10,36 @@ struct cpu_context* handle_page_fault(struct cpu_context* context) {
 
         arch_print_cpu_context(context);
         panic("Unhandled page fault");
-    } else {
-        thread_signal(current, SIGSEGV);
     }
 
+    vaddr address = arch_get_page_fault_address(context);
+    bool write = arch_is_page_fault_on_write(context);
+    bool present = arch_is_page_fault_on_present_page(context);
+    bool fetch = arch_is_page_fault_on_instruction_fetch(context);
+    vm_space* vm = current->proc->vm;
+
+    rw_spin_lock_write_irq(&vm->lock);
+    vm_area_flags flags = arch_get_page_flags(vm->table, address);
+
+    // Write to page that was made writable by other cpu meanwhile faults
+    // on translation this cpu has cached before, dropping it is enough
+    bool spurious = present && write && !fetch && flags.writable
+                    && flags.user_access_allowed;
+    if (spurious)
+        arch_flush_local_tlb_page(address);
+
+    // Only missing pages and writes to pages mapped read-only until first
+    // write are resolved, other faults on present pages (e.g. executing
+    // non-executable page) would repeat forever
+    bool demand_fault = !present || (write && !fetch && !flags.writable);
+    bool resolved = spurious
+                    || (demand_fault
+                        && vm_space_resolve_page(vm, address, write));
+
+    rw_spin_unlock_write_irq(&vm->lock);
+
+    if (!resolved)
+        thread_signal(current, SIGSEGV);
+
     return context;
 }
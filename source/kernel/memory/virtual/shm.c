@@ -0,0 +1,179 @@
+#include "shm.h"
+#include "../../arch/common/vmm.h"
+#include "../../error/errno.h"
+#include "../../lib/alignment.h"
+#include "../../lib/container/hash_table/hash_table.h"
+#include "../../lib/id_generator.h"
+#include "../../lib/panic.h"
+#include "../heap/kheap.h"
+#include "../heap/vmalloc.h"
+#include "../physical/page.h"
+#include "../physical/pmm.h"
+
+static lock shm_lock = SPIN_LOCK_STATIC_INITIALIZER;
+static hash_table segments; // id -> segment, guarded by shm lock
+static id_generator shm_id_gen;
+
+void shm_init() {
+    if (!hash_table_init(&segments))
+        panic("Can't init shared memory segments table");
+    if (!id_generator_init(&shm_id_gen))
+        panic("Can't init shared memory id generator");
+}
+
+static void shm_segment_free(shm_segment* segment) {
+    pmm_frame_batch batch = PMM_FRAME_BATCH_STATIC_INITIALIZER;
+
+    for (u64 i = 0; i < segment->pages; i++) {
+        if (segment->frames[i])
+            pmm_frame_batch_put(&batch, segment->frames[i]);
+    }
+
+    pmm_free_frame_batch(&batch);
+    kvfree(segment->frames);
+    kfree(segment);
+}
+
+shm_segment* shm_segment_create(u64 pages) {
+    shm_segment* segment = (shm_segment*) kmalloc(sizeof(shm_segment));
+    if (!segment)
+        return NULL;
+
+    segment->frames = (paddr*) kvmalloc(pages * sizeof(paddr));
+    if (!segment->frames) {
+        kfree(segment);
+        return NULL;
+    }
+
+    segment->pages = pages;
+    segment->refc = (ref_count) REF_COUNT_STATIC_INITIALIZER;
+
+    for (u64 i = 0; i < pages; i++) {
+        segment->frames[i] = NULL;
+    }
+
+    for (u64 i = 0; i < pages; i++) {
+        segment->frames[i] = pmm_allocate_zeroed_frame();
+        if (!segment->frames[i]) {
+            shm_segment_free(segment);
+            return NULL;
+        }
+
+        page_set_flags(frame_to_page(segment->frames[i]), PAGE_SHARED);
+    }
+
+    return segment;
+}
+
+u64 shm_create(u64 size) {
+    if (!size)
+        return -EINVAL;
+
+    u64 pages = align_to_upper(size, PAGE_SIZE) / PAGE_SIZE;
+    if (pages > pmm_frames_available())
+        return -ENOMEM;
+
+    shm_segment* segment = shm_segment_create(pages);
+    if (!segment)
+        return -ENOMEM;
+
+    if (!id_generator_get_id(&shm_id_gen, &segment->id))
+        goto failed_to_allocate_id;
+
+    // registry reference
+    ref_acquire(&segment->refc);
+
+    bool interrupts_enabled = spin_lock_irq_save(&shm_lock);
+    bool inserted = hash_table_put(&segments, segment->id, segment, NULL);
+    spin_unlock_irq_restore(&shm_lock, interrupts_enabled);
+
+    if (!inserted)
+        goto failed_to_insert;
+
+    return segment->id;
+
+failed_to_insert:
+    id_generator_free_id(&shm_id_gen, segment->id);
+
+failed_to_allocate_id:
+    shm_segment_free(segment);
+    return -ENOMEM;
+}
+
+u64 shm_attach(vm_space* space, u64 id, vaddr base, bool writable) {
+    if (base % PAGE_SIZE != 0)
+        return -EINVAL;
+
+    bool interrupts_enabled = spin_lock_irq_save(&shm_lock);
+    shm_segment* segment = hash_table_get(&segments, id);
+    if (segment)
+        ref_acquire(&segment->refc); // keeps segment alive while it is mapped
+    spin_unlock_irq_restore(&shm_lock, interrupts_enabled);
+
+    if (!segment)
+        return -EINVAL;
+
+    vm_area_flags flags = {.writable = writable,
+                           .user_access_allowed = true,
+                           .executable = false,
+                           .shared = true};
+
+    rw_spin_lock_write_irq(&space->lock);
+    vm_page_mapping_result result =
+        vm_space_map_shared(space, base, segment, flags);
+    rw_spin_unlock_write_irq(&space->lock);
+
+    shm_segment_unref(segment);
+
+    switch (result) {
+    case SUCCESS:
+        return 0;
+    case ALREADY_MAPPED:
+        return -EEXIST;
+    case INVALID_RANGE:
+    case UNAUTHORIZED:
+        return -EINVAL;
+    case OUT_OF_MEMORY:
+        return -ENOMEM;
+    }
+
+    __builtin_unreachable();
+}
+
+u64 shm_detach(vm_space* space, vaddr base) {
+    rw_spin_lock_write_irq(&space->lock);
+    bool detached = vm_space_unmap_shared(space, base);
+    rw_spin_unlock_write_irq(&space->lock);
+
+    return detached ? 0 : -EINVAL;
+}
+
+u64 shm_remove(u64 id) {
+    bool interrupts_enabled = spin_lock_irq_save(&shm_lock);
+    shm_segment* segment = hash_table_remove(&segments, id);
+    spin_unlock_irq_restore(&shm_lock, interrupts_enabled);
+
+    if (!segment)
+        return -EINVAL;
+
+    id_generator_free_id(&shm_id_gen, id);
+    shm_segment_unref(segment);
+
+    return 0;
+}
+
+void shm_segment_ref(shm_segment* segment) {
+    bool interrupts_enabled = spin_lock_irq_save(&shm_lock);
+    ref_acquire(&segment->refc);
+    spin_unlock_irq_restore(&shm_lock, interrupts_enabled);
+}
+
+void shm_segment_unref(shm_segment* segment) {
+    bool interrupts_enabled = spin_lock_irq_save(&shm_lock);
+    ref_release(&segment->refc);
+    bool dead = segment->refc.count == 0;
+    spin_unlock_irq_restore(&shm_lock, interrupts_enabled);
+
+    if (dead)
+        shm_segment_free(segment);
+}
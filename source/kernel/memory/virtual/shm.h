@@ -0,0 +1,39 @@
+#ifndef SOS_SHM_H
+#define SOS_SHM_H
+
+#include "../../lib/ref_count/ref_count.h"
+#include "../memory_map.h"
+#include "vm.h"
+
+/*
+ * Shared memory segment is a set of frames that can be mapped into several
+ * vm spaces at once. Segment is referenced by shm registry (until it is
+ * removed) and by every vm area it is mapped into, its frames are freed when
+ * last reference is dropped.
+ */
+typedef struct shm_segment {
+    // Immutable data
+    u64 id;
+    u64 pages;
+    paddr* frames;
+    // End of immutable data
+
+    ref_count refc; // guarded by shm lock
+} shm_segment;
+
+void shm_init();
+
+// These return negative error code on failure
+u64 shm_create(u64 size);
+u64 shm_attach(vm_space* space, u64 id, vaddr base, bool writable);
+u64 shm_detach(vm_space* space, vaddr base);
+u64 shm_remove(u64 id);
+
+// Creates segment that is not registered in shm registry, so it can't be
+// attached by id. Segment has no references, caller should acquire one.
+shm_segment* shm_segment_create(u64 pages);
+
+void shm_segment_ref(shm_segment* segment);
+void shm_segment_unref(shm_segment* segment);
+
+#endif // SOS_SHM_H
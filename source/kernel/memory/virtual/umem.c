@@ -1,4 +1,6 @@
 #include "umem.h"
+#include "../../arch/common/vmm.h"
+#include "../../error/errno.h"
 
 bool copy_to_user(void* __user dst, void* src, u64 length) {
     vm_space* current_vm = vmm_current_vm_space();
@@ -6,7 +8,10 @@ bool copy_to_user(void* __user dst, void* src, u64 length) {
     vm_area* surrounding_area =
         vm_space_get_surrounding_area(current_vm, (u64) dst, length);
 
-    if (!surrounding_area || !surrounding_area->flags.writable) {
+    // pages are populated upfront, since kernel can't handle faults on user
+    // memory while holding vm lock
+    if (!surrounding_area || !surrounding_area->flags.writable
+        || !vm_space_resolve_pages(current_vm, (u64) dst, length, true)) {
         rw_spin_unlock_write_irq(&current_vm->lock);
         return false;
     }
@@ -22,7 +27,8 @@ bool copy_from_user(void* dst, void* __user src, u64 length) {
     vm_area* surrounding_area =
         vm_space_get_surrounding_area(current_vm, (u64) src, length);
 
-    if (!surrounding_area) {
+    if (!surrounding_area
+        || !vm_space_resolve_pages(current_vm, (u64) src, length, false)) {
         rw_spin_unlock_write_irq(&current_vm->lock);
         return false;
     }
@@ -30,4 +36,30 @@ bool copy_from_user(void* dst, void* __user src, u64 length) {
     memcpy(dst, src, length);
     rw_spin_unlock_write_irq(&current_vm->lock);
     return true;
+}
+
+u64 copy_string_from_user(char* dst, const char* __user src, u64 size) {
+    vm_space* current_vm = vmm_current_vm_space();
+    rw_spin_lock_write_irq(&current_vm->lock);
+
+    // length isn't known upfront, so every page is checked once string
+    // reaches it
+    u64 copied = 0;
+    for (; copied + 1 < size; copied++) {
+        vaddr address = (vaddr) src + copied;
+        if ((!copied || address % PAGE_SIZE == 0)
+            && (!vm_space_get_surrounding_area(current_vm, address, 1)
+                || !vm_space_resolve_page(current_vm, address, false))) {
+            rw_spin_unlock_write_irq(&current_vm->lock);
+            return -EFAULT;
+        }
+
+        dst[copied] = src[copied];
+        if (!dst[copied])
+            break;
+    }
+
+    dst[copied] = '\0';
+    rw_spin_unlock_write_irq(&current_vm->lock);
+    return copied;
 }
\ No newline at end of file
@@ -14,4 +14,8 @@ bool copy_to_user(void* __user dst, void* src, u64 length);
 
 bool copy_from_user(void* dst, void* __user src, u64 length);
 
+// Copies NUL terminated string, at most `size` - 1 characters of it, and
+// terminates dst. Returns number of copied characters or -EFAULT.
+u64 copy_string_from_user(char* dst, const char* __user src, u64 size);
+
 #endif // SOS_UMEM_H
@@ -3,6 +3,9 @@
 #include "../../lib/kprint.h"
 #include "../../lib/math.h"
 #include "../heap/kheap.h"
+#include "shm.h"
+#include "vm_reaper.h"
+#include "vmm.h"
 
 #define PAGE(base) (base & ~((u64) PAGE_SIZE - 1))
 
@@ -20,10 +23,19 @@ static vm_area* vm_area_clone(const vm_area* area) {
         return NULL;
 
     *clone = *area;
+    if (clone->shm)
+        shm_segment_ref(clone->shm);
 
     return clone;
 }
 
+static void vm_area_free(vm_area* area) {
+    if (area->shm)
+        shm_segment_unref(area->shm);
+
+    kfree(area);
+}
+
 static void vm_area_validate(const vm_area* area) {
     if (area->base % PAGE_SIZE != 0)
         panic("Area of non-page-aligned base");
@@ -70,7 +82,9 @@ static bool vm_areas_can_merge(const vm_area* left, const vm_area* right) {
     bool intersect = vm_areas_intersect(left, right);
     bool flags_equal = vm_area_flags_equal(left, right);
     bool can_merge = intersect || vm_areas_next_to_each_other(left, right);
-    return can_merge && flags_equal;
+    // every shared area represents single attachment of its segment
+    bool anonymous = !left->shm && !right->shm;
+    return can_merge && flags_equal && anonymous;
 }
 
 static void vm_areas_merge(vm_area* left, vm_area* right) {
@@ -182,6 +196,7 @@ static bool vm_space_cut_area_unsafe(vm_space* space, const vm_area* to_cut) {
         right_remainder->base = cut_end;
         right_remainder->length = curr->base + curr->length - cut_end;
         right_remainder->flags = curr->flags;
+        right_remainder->shm = NULL; // shared areas are never cut
 
         if (!array_list_insert(&space->areas, idx + 1, right_remainder)) {
             kfree(right_remainder);
@@ -205,6 +220,7 @@ vm_space* vm_space_fork(vm_space* space) {
     forked->is_kernel_space = false;
     forked->lock = (rw_spin_lock) RW_LOCK_STATIC_INITIALIZER;
     forked->refc = (ref_count) REF_COUNT_STATIC_INITIALIZER;
+    forked->reaper_node = (linked_list_node) LINKED_LIST_NODE_OF(forked);
     ref_acquire(&forked->refc);
 
     // don't clone areas if we are forking kernel space, since we don't own them
@@ -237,7 +253,7 @@ vm_space* vm_space_fork(vm_space* space) {
 page_table_fork_failed:
 area_clone_failed:
     while (forked->areas.size != 0) {
-        kfree(array_list_remove_last(&forked->areas));
+        vm_area_free(array_list_remove_last(&forked->areas));
     }
 
     array_list_deinit(&forked->areas);
@@ -261,10 +277,17 @@ void vm_space_destroy(vm_space* space) {
         return;
     }
 
-    ARRAY_LIST_FOR_EACH(&space->areas, vm_area * area) kfree(area);
+    vm_reaper_mark(space);
+}
+
+void vm_space_free(vm_space* space) {
+    // table goes first, so that shared frames are released by segments only
+    // after they are not mapped anymore
+    arch_destroy_page_table(space->table);
+
+    ARRAY_LIST_FOR_EACH(&space->areas, vm_area * area) vm_area_free(area);
 
     array_list_deinit(&space->areas);
-    arch_destroy_page_table(space->table);
     kfree(space);
 }
 
@@ -277,7 +300,10 @@ static vm_page_mapping_result vm_space_map_page_unsafe(vm_space* space,
     if (!new)
         return OUT_OF_MEMORY;
 
-    if (!arch_map_page(space->table, base, flags)) {
+    // User space pages are anonymous and are populated lazily on first access
+    // (see vm_space_resolve_page), kernel space pages are populated eagerly,
+    // since kernel can't fault on its own memory
+    if (space->is_kernel_space && !arch_map_page(space->table, base, flags)) {
         kfree(new);
         return OUT_OF_MEMORY;
     }
@@ -285,10 +311,13 @@ static vm_page_mapping_result vm_space_map_page_unsafe(vm_space* space,
     new->base = base;
     new->length = PAGE_SIZE;
     new->flags = flags;
+    new->shm = NULL;
 
     if (!vm_space_insert_area_unsafe(space, new)) {
         kfree(new);
-        arch_unmap_page(space->table, base);
+        unmap_batch batch = UNMAP_BATCH_INITIALIZER(space);
+        arch_unmap_page(space->table, base, &batch);
+        arch_finish_unmap(&batch);
         return OUT_OF_MEMORY;
     }
 
@@ -348,26 +377,31 @@ vm_page_mapping_result vm_space_map_page(vm_space* space, vaddr base,
     return vm_space_map_pages(space, base, 1, flags).status;
 }
 
-static bool vm_space_unmap_page_unsafe(vm_space* space, vaddr base) {
+static bool vm_space_unmap_page_unsafe(vm_space* space, vaddr base,
+                                       unmap_batch* batch) {
     vm_area to_cut = {.base = PAGE(base), .length = PAGE_SIZE};
     return vm_space_cut_area_unsafe(space, &to_cut)
-           && arch_unmap_page(space->table, base);
+           && arch_unmap_page(space->table, base, batch);
 }
 
 bool vm_space_unmap_pages(vm_space* space, vaddr base, u64 count) {
     base = PAGE(base);
     vm_area to_unmap = {.base = base, .length = PAGE_SIZE * count};
 
-    if (!vm_space_surrounding_area_unsafe(space, &to_unmap)
+    vm_area* surrounding = vm_space_surrounding_area_unsafe(space, &to_unmap);
+    if (!surrounding || surrounding->shm
         || vm_areas_intersect(&to_unmap, &non_canonical_area)
         || (vm_areas_intersect(&to_unmap, &kernel_space_area)
-            && space->is_kernel_space))
+            && !space->is_kernel_space))
         return false;
 
+    // frames are freed only after tlb of every cpu is flushed
+    unmap_batch batch = UNMAP_BATCH_INITIALIZER(space);
     for (u64 i = 0; i < count; i++) {
-        vm_space_unmap_page_unsafe(space, base + i * PAGE_SIZE);
+        vm_space_unmap_page_unsafe(space, base + i * PAGE_SIZE, &batch);
     }
 
+    arch_finish_unmap(&batch);
     return true;
 }
 
@@ -375,6 +409,81 @@ bool vm_space_unmap_page(vm_space* space, vaddr base) {
     return vm_space_unmap_pages(space, base, 1);
 }
 
+vm_page_mapping_result vm_space_map_shared(vm_space* space, vaddr base,
+                                           struct shm_segment* segment,
+                                           vm_area_flags flags) {
+
+    vm_area to_map = {.base = PAGE(base),
+                      .length = PAGE_SIZE * segment->pages,
+                      .flags = flags};
+
+    if (vm_areas_intersect(&to_map, &non_canonical_area))
+        return INVALID_RANGE;
+
+    if (space->is_kernel_space
+        || vm_areas_intersect(&to_map, &kernel_space_area))
+        return UNAUTHORIZED;
+
+    if (vm_space_intersecting_area_unsafe(space, &to_map))
+        return ALREADY_MAPPED;
+
+    vm_area* new = vm_area_clone(&to_map);
+    if (!new)
+        return OUT_OF_MEMORY;
+
+    new->flags.shared = true;
+
+    u64 mapped = 0;
+    for (; mapped < segment->pages; mapped++) {
+        vaddr page = new->base + PAGE_SIZE * mapped;
+        if (!arch_map_page_to_shared_frame(space->table, page,
+                                           segment->frames[mapped], new->flags))
+            goto failed;
+    }
+
+    // segment has to be set before insertion, so that area is not merged
+    new->shm = segment;
+    if (!vm_space_insert_area_unsafe(space, new))
+        goto failed;
+
+    shm_segment_ref(segment);
+
+    return SUCCESS;
+
+failed:
+    // shared frames are not freed on unmap, they stay owned by segment
+    unmap_batch batch = UNMAP_BATCH_INITIALIZER(space);
+    for (u64 i = 0; i < mapped; i++) {
+        arch_unmap_page(space->table, new->base + PAGE_SIZE * i, &batch);
+    }
+    arch_finish_unmap(&batch);
+
+    kfree(new);
+    return OUT_OF_MEMORY;
+}
+
+bool vm_space_unmap_shared(vm_space* space, vaddr base) {
+    for (u64 idx = 0; idx < space->areas.size; idx++) {
+        vm_area* area = array_list_get(&space->areas, idx);
+        if (area->base != base || !area->shm)
+            continue;
+
+        // segment may be freed along with area, so translations to its
+        // frames are dropped by every cpu first
+        unmap_batch batch = UNMAP_BATCH_INITIALIZER(space);
+        for (u64 i = 0; i < area->length / PAGE_SIZE; i++) {
+            arch_unmap_page(space->table, area->base + PAGE_SIZE * i, &batch);
+        }
+        arch_finish_unmap(&batch);
+
+        array_list_remove_idx(&space->areas, idx);
+        vm_area_free(area);
+        return true;
+    }
+
+    return false;
+}
+
 vm_area* vm_space_get_surrounding_area(vm_space* space, vaddr base,
                                        u64 length) {
 
@@ -382,6 +491,54 @@ vm_area* vm_space_get_surrounding_area(vm_space* space, vaddr base,
     return vm_space_surrounding_area_unsafe(space, &temp);
 }
 
+bool vm_space_resolve_page(vm_space* space, vaddr base, bool write) {
+    base = PAGE(base);
+    vm_area temp = {.base = base, .length = PAGE_SIZE};
+
+    vm_area* area = vm_space_surrounding_area_unsafe(space, &temp);
+    if (!area || (write && !area->flags.writable))
+        return false;
+
+    // shared areas are mapped entirely on attach and must never be unshared
+    if (area->shm)
+        return arch_is_page_mapped(space->table, base);
+
+    if (!arch_is_page_mapped(space->table, base)) {
+        if (write)
+            return arch_map_page(space->table, base, area->flags);
+
+        // Pages that are only read from share single zero frame, private frame
+        // is allocated on first write
+        vm_area_flags zero_page_flags = area->flags;
+        zero_page_flags.writable = false;
+        return arch_map_page_to_shared_frame(space->table, base,
+                                             vmm_zero_frame(), zero_page_flags);
+    }
+
+    if (!write || !arch_get_page_flags(space->table, base).shared)
+        return true;
+
+    if (!arch_unshare_page(space->table, base, area->flags))
+        return false;
+
+    // Other threads of process may still read zero frame through stale
+    // translation, only cpus that run this vm space are interrupted
+    arch_flush_tlb_range(space, base, base + PAGE_SIZE);
+    return true;
+}
+
+bool vm_space_resolve_pages(vm_space* space, vaddr base, u64 length,
+                            bool write) {
+
+    vaddr end = base + length;
+    for (vaddr page = PAGE(base); page < end; page += PAGE_SIZE) {
+        if (!vm_space_resolve_page(space, page, write))
+            return false;
+    }
+
+    return true;
+}
+
 void* vm_space_get_page_view(vm_space* space, vaddr base) {
     base = PAGE(base);
     vm_area temp = {.base = base, .length = PAGE_SIZE};
@@ -2,12 +2,14 @@
 #define SOS_VM_SPACE_H
 
 #include "../../lib/container/array_list/array_list.h"
+#include "../../lib/container/linked_list/linked_list.h"
 #include "../../lib/ref_count/ref_count.h"
 #include "../../synchronization/rw_spin_lock.h"
 #include "../../synchronization/spin_lock.h"
 #include "../memory_map.h"
 
 struct page_table;
+struct shm_segment;
 
 typedef struct {
     bool writable : 1;
@@ -23,6 +25,8 @@ typedef struct {
     vaddr base;
     u64 length;
     vm_area_flags flags;
+    struct shm_segment* shm; // shared memory segment backing this area, area
+                             // holds reference to it
 } vm_area;
 
 /*
@@ -37,6 +41,11 @@ typedef struct {
  * (table hierarchy underlying pages). In the future, this may be changed in
  * favor of reference counting and Copy on write, so that we don't copy shared
  * physical pages that are only read from, but not written to.
+ *
+ * User space pages are populated on demand: mapping only reserves area, first
+ * read maps shared zero frame and first write maps private zeroed frame.
+ * Exception are areas backed by shared memory segments, whose frames are
+ * mapped on attach and are shared (not copied) between forked spaces.
  */
 typedef struct {
     bool is_kernel_space;
@@ -44,6 +53,8 @@ typedef struct {
     array_list areas;
     ref_count refc;
     rw_spin_lock lock;
+
+    linked_list_node reaper_node; // used by vm reaper to queue dead vm space
 } vm_space;
 
 typedef enum {
@@ -67,8 +78,14 @@ bool vm_space_insert_area_unsafe(vm_space* space, vm_area* to_insert);
 
 // these functions take write lock of provided vm_space
 vm_space* vm_space_fork(vm_space* space);
+// Releases reference to vm space. Last reference hands vm space over to vm
+// reaper, so that caller does not pay for tearing down its page tables.
 void vm_space_destroy(vm_space* space);
 
+// Frees underlying page table hierarchy, areas and vm space itself. Should be
+// called only on dead vm space that is not used by any cpu.
+void vm_space_free(vm_space* space);
+
 // these functions should be called with vm_space lock held for write
 vm_page_mapping_result vm_space_map_page(vm_space* space, vaddr base,
                                          vm_area_flags flags);
@@ -81,11 +98,30 @@ vm_page_mapping_result vm_space_map_pages_exactly(vm_space* space, vaddr base,
                                                   u64 count,
                                                   vm_area_flags flags);
 
+// Areas backed by shared memory segments can't be unmapped partially by
+// these two, see vm_space_unmap_shared
 bool vm_space_unmap_page(vm_space* space, vaddr base);
 bool vm_space_unmap_pages(vm_space* space, vaddr base, u64 count);
 
+// Maps all frames of shared memory segment starting at `base`. Created area
+// acquires its own reference to segment, so segment outlives its removal
+// while it is mapped anywhere. Shared areas are inherited on fork.
+vm_page_mapping_result vm_space_map_shared(vm_space* space, vaddr base,
+                                           struct shm_segment* segment,
+                                           vm_area_flags flags);
+// Unmaps entire shared area that starts at `base`
+bool vm_space_unmap_shared(vm_space* space, vaddr base);
+
 vm_area* vm_space_get_surrounding_area(vm_space* space, vaddr base, u64 length);
 
+// Makes sure that page is backed by frame, so it can be accessed without
+// faulting. Read access maps shared zero frame, write access maps private one.
+// Returns false if access is not allowed by surrounding area or memory is
+// exhausted.
+bool vm_space_resolve_page(vm_space* space, vaddr base, bool write);
+bool vm_space_resolve_pages(vm_space* space, vaddr base, u64 length,
+                            bool write);
+
 // these functions should be called with vm_space lock held for read
 void* vm_space_get_page_view(vm_space* space, vaddr base);
 void vm_space_print(vm_space* space);
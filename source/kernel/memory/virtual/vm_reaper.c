@@ -0,0 +1,41 @@
+#include "vm_reaper.h"
+#include "../../synchronization/con_var.h"
+#include "../../threading/kthread.h"
+
+static lock dead_lock = SPIN_LOCK_STATIC_INITIALIZER;
+static con_var dead_cvar = CON_VAR_STATIC_INITIALIZER;
+
+static linked_list dead_list = LINKED_LIST_STATIC_INITIALIZER;
+
+_Noreturn void vm_reaper_daemon();
+
+void vm_reaper_init() {
+    kthread_run("kernel-vm-reaper-daemon", vm_reaper_daemon);
+}
+
+_Noreturn void vm_reaper_daemon() {
+    while (true) {
+        bool interrupts_enabled = spin_lock_irq_save(&dead_lock);
+        CON_VAR_WAIT_FOR_IRQ(&dead_cvar, &dead_lock, interrupts_enabled,
+                             dead_list.size != 0);
+
+        linked_list_node* cur = linked_list_remove_first_node(&dead_list);
+        while (cur) {
+            spin_unlock_irq_restore(&dead_lock, interrupts_enabled);
+
+            vm_space_free((vm_space*) cur->value);
+
+            interrupts_enabled = spin_lock_irq_save(&dead_lock);
+            cur = linked_list_remove_first_node(&dead_list);
+        }
+
+        spin_unlock_irq_restore(&dead_lock, interrupts_enabled);
+    }
+}
+
+void vm_reaper_mark(vm_space* space) {
+    bool interrupts_enabled = spin_lock_irq_save(&dead_lock);
+    linked_list_add_last_node(&dead_list, &space->reaper_node);
+    con_var_broadcast(&dead_cvar);
+    spin_unlock_irq_restore(&dead_lock, interrupts_enabled);
+}
@@ -0,0 +1,17 @@
+#ifndef SOS_VM_REAPER_H
+#define SOS_VM_REAPER_H
+
+#include "vm.h"
+
+/*
+ * Vm reaper is a kernel daemon that tears down address spaces of exited
+ * processes, so that exiting thread (and parent waiting for it) does not wait
+ * for whole page table hierarchy to be walked and freed.
+ */
+
+void vm_reaper_init();
+
+// Vm space should be dead and not used by any cpu at this point
+void vm_reaper_mark(vm_space* space);
+
+#endif // SOS_VM_REAPER_H
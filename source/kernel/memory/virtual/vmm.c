@@ -1,36 +1,51 @@
 #include "vmm.h"
+#include "../../arch/common/smp.h"
 #include "../../arch/common/vmm.h"
+#include "../../interrupts/irq.h"
+#include "../../synchronization/barriers.h"
+#include "../../threading/percpu.h"
+#include "../physical/page.h"
+#include "../physical/pmm.h"
 #include "vm.h"
 
 vm_space kernel_vm_space;
 
-// TODO: make this percpu
-// can be changed without locking as this is confined to current cpu
-static vm_space* current_vm_space = NULL;
-static lock vmm_lock = SPIN_LOCK_STATIC_INITIALIZER;
+// each entry is confined to its cpu, so it is enough to disable interrupts
+// while accessing it
+static vm_space* current_vm_spaces[MAX_CPUS] = {0};
+
+static paddr zero_frame = NULL;
 
 void vmm_init() {
     arch_init_kernel_vm(&kernel_vm_space);
     kernel_vm_space.is_kernel_space = true;
     kernel_vm_space.refc = (ref_count) REF_COUNT_STATIC_INITIALIZER;
     kernel_vm_space.lock = (rw_spin_lock) RW_LOCK_STATIC_INITIALIZER;
-    current_vm_space = &kernel_vm_space;
+    current_vm_spaces[this_cpu_id()] = &kernel_vm_space;
+
+    zero_frame = pmm_allocate_zeroed_frame();
+    if (!zero_frame)
+        panic("Can't allocate zero frame");
+
+    page_set_flags(frame_to_page(zero_frame), PAGE_PINNED | PAGE_SHARED);
 }
 
 vm_space* vmm_kernel_vm_space() { return &kernel_vm_space; }
 
+paddr vmm_zero_frame() { return zero_frame; }
+
 vm_space* vmm_current_vm_space() {
-    bool interrupts_enabled = spin_lock_irq_save(&vmm_lock);
-    vm_space* result = current_vm_space;
-    spin_unlock_irq_restore(&vmm_lock, interrupts_enabled);
+    bool interrupts_enabled = local_irq_save();
+    vm_space* result = current_vm_spaces[this_cpu_id()];
+    local_irq_restore(interrupts_enabled);
     return result;
 }
 
 void vmm_set_vm_space(vm_space* space) {
-    bool interrupts_enabled = spin_lock_irq_save(&vmm_lock);
-    current_vm_space = space;
+    bool interrupts_enabled = local_irq_save();
+    current_vm_spaces[this_cpu_id()] = space;
     arch_set_vm_space(space);
-    spin_unlock_irq_restore(&vmm_lock, interrupts_enabled);
+    local_irq_restore(interrupts_enabled);
     // no need to call notify here, since arch already knows that vm space has
     // changed
 }
@@ -38,7 +53,23 @@ void vmm_set_vm_space(vm_space* space) {
 void vmm_switch_to_kernel_vm_space() { vmm_set_vm_space(&kernel_vm_space); }
 
 void vmm_notify_vm_space_changed() {
-    // TODO: when implementing support for SMP make this to send IPI to check
-    //       whether other CPUs need to also get notified
+    // arch is responsible for notifying other cpus that may cache translations
     arch_notify_vm_space_changed();
+}
+
+u64 vmm_vm_space_cpus(vm_space* space) {
+    // Cpu publishes its vm space before loading its table, so page table
+    // changes made before this are seen by cpus that aren't in the mask
+    smp_mb();
+
+    u64 cpus = 0;
+    u64 this_cpu = this_cpu_id();
+    for (u64 cpu = 0; cpu < arch_cpus_count(); cpu++) {
+        // kernel half of address space is shared by all of them
+        if (cpu != this_cpu
+            && (space->is_kernel_space || current_vm_spaces[cpu] == space))
+            cpus |= 1ull << cpu;
+    }
+
+    return cpus;
 }
\ No newline at end of file
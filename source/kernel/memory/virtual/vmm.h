@@ -9,10 +9,18 @@ void vmm_init();
 vm_space* vmm_kernel_vm_space();
 vm_space* vmm_current_vm_space();
 
+// Single read-only frame filled with zeroes, shared by all untouched anonymous
+// pages
+paddr vmm_zero_frame();
+
 void vmm_set_vm_space(vm_space* space);
 void vmm_switch_to_kernel_vm_space();
 void vmm_notify_vm_space_changed();
 
+// Returns mask of cpus other than current one that have space loaded and so
+// may cache its translations. Should be called with interrupts disabled.
+u64 vmm_vm_space_cpus(vm_space* space);
+
 bool vmm_invalidate_range(vaddr base, u64 len);
 
 #endif // SOS_VIRTUAL_MEMORY_MANAGER_H
@@ -0,0 +1,126 @@
+#include "rseq.h"
+#include "../arch/common/context.h"
+#include "../error/errno.h"
+#include "../memory/virtual/umem.h"
+#include "../signal/signal.h"
+#include "../threading/percpu.h"
+#include "../threading/scheduler.h"
+#include "../threading/thread.h"
+
+// cpu_id_start and cpu_id are adjacent, so both are stored at once
+static bool store_cpu_id(u64 area, u32 cpu) {
+    u32 ids[2] = {cpu, cpu};
+    return copy_to_user((void*) area, ids, sizeof(ids));
+}
+
+static bool clear_critical_section(u64 area) {
+    u64 none = 0;
+    return copy_to_user(&((rseq_area*) area)->rseq_cs, &none, sizeof(u64));
+}
+
+static bool valid_critical_section(const rseq_cs* cs) {
+    return !cs->version && cs->start_ip + cs->post_commit_offset >= cs->start_ip
+           && cs->abort_ip - cs->start_ip >= cs->post_commit_offset;
+}
+
+// Moves context to abort handler if it is inside active critical section,
+// returns false if user memory or descriptor is broken
+static bool abort_critical_section(thread* current,
+                                   struct cpu_context* context) {
+    u64 cs_address;
+    if (!copy_from_user(&cs_address, &((rseq_area*) current->rseq)->rseq_cs,
+                        sizeof(u64)))
+        return false;
+    if (!cs_address)
+        return true;
+
+    rseq_cs cs;
+    if (!copy_from_user(&cs, (void*) cs_address, sizeof(rseq_cs))
+        || !valid_critical_section(&cs))
+        return false;
+
+    // unsigned subtraction also rejects ip below start of section
+    u64 ip = arch_get_instruction_pointer(context);
+    if (ip - cs.start_ip >= cs.post_commit_offset)
+        return clear_critical_section(current->rseq);
+
+    // signature guards against jumping to arbitrary code with forged
+    // descriptor
+    u32 signature;
+    if (!copy_from_user(&signature, (void*) (cs.abort_ip - sizeof(u32)),
+                        sizeof(u32))
+        || signature != current->rseq_signature)
+        return false;
+
+    if (!clear_critical_section(current->rseq))
+        return false;
+
+    arch_set_instruction_pointer(context, cs.abort_ip);
+    return true;
+}
+
+static u64 rseq_unregister(thread* current, u64 area, u64 length,
+                           u32 signature) {
+    if (current->rseq != area || length != sizeof(rseq_area))
+        return -EINVAL;
+    if (current->rseq_signature != signature)
+        return -EPERM;
+
+    u32 cpu_id = RSEQ_CPU_ID_UNINITIALIZED;
+    if (!copy_to_user(&((rseq_area*) area)->cpu_id, &cpu_id, sizeof(u32)))
+        return -EFAULT;
+
+    current->rseq = 0;
+    current->rseq_signature = 0;
+    current->rseq_resume = false;
+    return 0;
+}
+
+u64 rseq_register(u64 area, u64 length, u64 flags, u32 signature) {
+    thread* current = get_current_thread();
+
+    if (flags == RSEQ_FLAG_UNREGISTER)
+        return rseq_unregister(current, area, length, signature);
+    if (flags)
+        return -EINVAL;
+
+    // like linux, repeated registration of the same area is reported as busy
+    if (current->rseq) {
+        if (current->rseq != area || length != sizeof(rseq_area))
+            return -EINVAL;
+        return current->rseq_signature == signature ? -EBUSY : -EPERM;
+    }
+
+    if (!area || area % _Alignof(rseq_area) || length != sizeof(rseq_area))
+        return -EINVAL;
+
+    // syscalls run with interrupts disabled, so cpu can't change until return
+    if (!store_cpu_id(area, this_cpu_id()))
+        return -EFAULT;
+
+    current->rseq = area;
+    current->rseq_signature = signature;
+    return 0;
+}
+
+void rseq_preempt(thread* thread) {
+    if (thread->rseq)
+        thread->rseq_resume = true;
+}
+
+void rseq_handle_resume(struct cpu_context* context) {
+    thread* current = get_current_thread();
+    if (!current->rseq_resume)
+        return;
+
+    current->rseq_resume = false;
+    if (!store_cpu_id(current->rseq, this_cpu_id())
+        || !abort_critical_section(current, context))
+        process_exit(128 + SIGSEGV);
+}
+
+void rseq_signal_deliver(struct cpu_context* context) {
+    thread* current = get_current_thread();
+    if (current->rseq && !abort_critical_section(current, context))
+        process_exit(128 + SIGSEGV);
+}
\ No newline at end of file
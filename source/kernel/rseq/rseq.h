@@ -0,0 +1,57 @@
+#ifndef SOS_RSEQ_H
+#define SOS_RSEQ_H
+
+#include "../lib/types.h"
+
+/*
+ * Restartable sequences let user space update per-cpu data without atomic
+ * instructions. Thread registers rseq area, where kernel keeps id of cpu the
+ * thread runs on, and before entering critical section stores pointer to its
+ * descriptor in the area. If thread is preempted, migrated or gets a signal
+ * while its instruction pointer is inside critical section, it is resumed at
+ * abort handler of the section instead, so that the sequence is restarted.
+ *
+ * Layouts follow linux.
+ */
+
+#define RSEQ_FLAG_UNREGISTER (1 << 0)
+
+#define RSEQ_CPU_ID_UNINITIALIZED ((u32) -1)
+
+typedef struct {
+    u32 cpu_id_start; // always valid cpu id, may be read before registration
+    u32 cpu_id;       // cpu id or RSEQ_CPU_ID_UNINITIALIZED
+    u64 rseq_cs;      // user address of active critical section or 0
+    u32 flags;
+    u32 padding[3];
+} __attribute__((aligned(32))) rseq_area;
+
+typedef struct {
+    u32 version;
+    u32 flags;
+    u64 start_ip;
+    u64 post_commit_offset; // section is [start_ip, start_ip + offset)
+    u64 abort_ip;           // preceded by 32 bit signature in user code
+} __attribute__((aligned(32))) rseq_cs;
+
+struct _thread;
+struct cpu_context;
+
+// Registers or with RSEQ_FLAG_UNREGISTER unregisters rseq area of current
+// thread. Returns 0, -EINVAL, -EBUSY if area is already registered, -EPERM if
+// signature doesn't match on unregistering or -EFAULT.
+u64 rseq_register(u64 area, u64 length, u64 flags, u32 signature);
+
+// Called by scheduler when thread leaves cpu, user memory is only touched
+// once thread returns to user space
+void rseq_preempt(struct _thread* thread);
+
+// Called before returning to user space, refreshes cpu id and aborts critical
+// section if thread was preempted or migrated since last return
+void rseq_handle_resume(struct cpu_context* context);
+
+// Called before signal frame is set up, so that frame holds abort handler
+// address instead of critical section one
+void rseq_signal_deliver(struct cpu_context* context);
+
+#endif // SOS_RSEQ_H
\ No newline at end of file
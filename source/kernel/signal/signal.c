@@ -3,6 +3,7 @@
 #include "../arch/common/signal.h"
 #include "../lib/kprint.h"
 #include "../lib/math.h"
+#include "../rseq/rseq.h"
 #include "../threading/scheduler.h"
 
 signal_disposition default_dispositions[SIGNALS_COUNT + 1] = {
@@ -14,7 +15,7 @@ signal_disposition default_dispositions[SIGNALS_COUNT + 1] = {
     CORE_DUMP, // Signal not supported for now
     [SIGABRT] = CORE_DUMP,
     CORE_DUMP, // Signal not supported for now
-    CORE_DUMP, // Signal not supported for now
+    [SIGFPE] = CORE_DUMP,
     [SIGKILL] = TERMINATE,
     CORE_DUMP, // Signal not supported for now
     [SIGSEGV] = CORE_DUMP,
@@ -99,6 +100,7 @@ void handle_signal(signal sig, struct cpu_context* context) {
     signal_handler* handler = action.handler;
 
     if (handler) {
+        rseq_signal_deliver(context);
         arch_enter_signal_handler(context, handler);
         return;
     }
@@ -133,6 +135,8 @@ void handle_pending_signals(struct cpu_context* context) {
         return;
     }
 
+    rseq_handle_resume(context);
+
     signal sig = get_and_clear_signal_to_handle();
     if (sig)
         handle_signal(sig, context);
@@ -13,4 +13,20 @@ extern void atomic_increment(volatile u64* addr);
 
 extern u64 atomic_decrement_and_get(volatile u64* addr);
 
+extern void atomic_and(volatile u64* addr, u64 mask);
+
+// 32 bit variants, used by compact structures (e.g. page descriptors)
+extern void atomic_increment_u32(volatile u32* addr);
+
+extern u32 atomic_decrement_and_get_u32(volatile u32* addr);
+
+extern void atomic_or_u32(volatile u32* addr, u32 mask);
+
+extern void atomic_and_u32(volatile u32* addr, u32 mask);
+
+// Stores new value only if current one is equal to expected, returns value
+// found at addr
+extern u32 atomic_compare_exchange_u32(volatile u32* addr, u32 expected,
+                                       u32 new_value);
+
 #endif
\ No newline at end of file
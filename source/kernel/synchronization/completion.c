@@ -1,4 +1,5 @@
 #include "completion.h"
+#include "../time/timer.h"
 
 void completion_init(completion* completion) {
     init_lock(&completion->lock);
@@ -23,6 +24,35 @@ void completion_wait_irq(completion* completion) {
     spin_unlock_irq_restore(&completion->lock, interrupts_enabled);
 }
 
+bool completion_wait_timeout(completion* completion, u64 timeout_ns) {
+    u64 deadline = timer_deadline_ns(timeout_ns);
+
+    spin_lock(&completion->lock);
+    while (!completion->completed) {
+        if (!con_var_timedwait(&completion->cvar, &completion->lock, deadline))
+            break;
+    }
+    bool completed = completion->completed;
+    spin_unlock(&completion->lock);
+
+    return completed;
+}
+
+bool completion_wait_irq_timeout(completion* completion, u64 timeout_ns) {
+    u64 deadline = timer_deadline_ns(timeout_ns);
+
+    bool interrupts_enabled = spin_lock_irq_save(&completion->lock);
+    while (!completion->completed) {
+        if (!con_var_timedwait_irq_save(&completion->cvar, &completion->lock,
+                                        &interrupts_enabled, deadline))
+            break;
+    }
+    bool completed = completion->completed;
+    spin_unlock_irq_restore(&completion->lock, interrupts_enabled);
+
+    return completed;
+}
+
 void completion_complete(completion* completion) {
     spin_lock(&completion->lock);
     completion->completed = true;
@@ -31,6 +31,10 @@ void completion_init(completion* completion);
 void completion_wait(completion* completion);
 void completion_wait_irq(completion* completion);
 
+// Return false if not completed within timeout
+bool completion_wait_timeout(completion* completion, u64 timeout_ns);
+bool completion_wait_irq_timeout(completion* completion, u64 timeout_ns);
+
 void completion_complete(completion* completion);
 void completion_complete_irq(completion* completion);
 
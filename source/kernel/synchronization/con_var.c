@@ -2,6 +2,7 @@
 #include "../threading/scheduler.h"
 #include "barriers.h"
 #include "spin_lock.h"
+#include "wait.h"
 
 void con_var_init(con_var* var) {
     var->wait_queue = (queue) QUEUE_STATIC_INITIALIZER;
@@ -48,6 +49,74 @@ bool con_var_wait_irq_save(con_var* var, lock* lock, bool interrupts_enabled) {
     return interrupts_enabled;
 }
 
+bool con_var_timedwait(con_var* var, lock* lock, u64 deadline_ns) {
+    thread* current = get_current_thread();
+    queue_node waiter_node = QUEUE_NODE_OF(current);
+    queue_push(&var->wait_queue, &waiter_node);
+
+    wait_timeout timeout;
+    wait_timeout_start(&timeout, deadline_ns);
+    current->state = BLOCKED;
+    // timer doesn't take guarding lock, so it could fire before state was set
+    if (wait_timeout_expired(&timeout))
+        current->state = RUNNING;
+
+    spin_unlock(lock);
+    schedule();
+
+    spin_lock(lock);
+    queue_remove(&var->wait_queue, &waiter_node);
+    wait_timeout_stop(&timeout);
+    return !timeout.expired;
+}
+
+bool con_var_timedwait_irq_save(con_var* var, lock* lock,
+                                bool* interrupts_enabled, u64 deadline_ns) {
+    thread* current = get_current_thread();
+    queue_node waiter_node = QUEUE_NODE_OF(current);
+    queue_push(&var->wait_queue, &waiter_node);
+
+    wait_timeout timeout;
+    wait_timeout_start(&timeout, deadline_ns);
+    current->state = BLOCKED;
+    // timer doesn't take guarding lock, so it could fire before state was set
+    if (wait_timeout_expired(&timeout))
+        current->state = RUNNING;
+
+    spin_unlock_irq_restore(lock, *interrupts_enabled);
+    schedule();
+
+    *interrupts_enabled = spin_lock_irq_save(lock);
+    queue_remove(&var->wait_queue, &waiter_node);
+    wait_timeout_stop(&timeout);
+    return !timeout.expired;
+}
+
+bool con_var_wait_interruptable_irq_save(con_var* var, lock* lock,
+                                         bool* interrupts_enabled) {
+    thread* current = get_current_thread();
+    queue_node waiter_node = QUEUE_NODE_OF(current);
+    queue_push(&var->wait_queue, &waiter_node);
+
+    current->state = BLOCKED;
+    // signal could come before state was set, its wakeup would be overridden
+    bool interrupted =
+        thread_any_pending_signals() || process_any_pending_signals();
+    if (interrupted) {
+        current->state = RUNNING;
+    } else {
+        spin_unlock_irq_restore(lock, *interrupts_enabled);
+        schedule();
+
+        *interrupts_enabled = spin_lock_irq_save(lock);
+        interrupted =
+            thread_any_pending_signals() || process_any_pending_signals();
+    }
+
+    queue_remove(&var->wait_queue, &waiter_node);
+    return !interrupted;
+}
+
 void con_var_signal(con_var* var) {
     if (var->wait_queue.size != 0) {
         queue_node* waiter = queue_pop(&var->wait_queue);
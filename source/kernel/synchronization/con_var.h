@@ -41,6 +41,17 @@ void con_var_init(con_var* var);
 void con_var_wait(con_var* var, lock* lock);
 bool con_var_wait_irq_save(con_var* var, lock* lock, bool interrupts_enabled);
 
+// Same as above, but also wake up once monotonic time reaches deadline, return
+// false in that case
+bool con_var_timedwait(con_var* var, lock* lock, u64 deadline_ns);
+bool con_var_timedwait_irq_save(con_var* var, lock* lock,
+                                bool* interrupts_enabled, u64 deadline_ns);
+
+// Same as con_var_wait_irq_save, but also wakes up if signal is pending,
+// returns false in that case
+bool con_var_wait_interruptable_irq_save(con_var* var, lock* lock,
+                                         bool* interrupts_enabled);
+
 void con_var_signal(con_var* var);
 void con_var_broadcast(con_var* var);
 
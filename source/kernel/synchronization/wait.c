@@ -0,0 +1,31 @@
+#include "wait.h"
+#include "../threading/scheduler.h"
+#include "../time/clockevent.h"
+#include "../time/timer.h"
+#include "barriers.h"
+
+static void wake_up_waiter(ktimer* timer) {
+    wait_timeout* timeout = timer->data;
+    timeout->expired = true;
+    schedule_thread(timeout->waiter);
+}
+
+void wait_timeout_start(wait_timeout* timeout, u64 deadline_ns) {
+    timeout->waiter = get_current_thread();
+    timeout->expired = deadline_ns <= timer_now_ns();
+    ktimer_init(&timeout->timer, wake_up_waiter, timeout);
+
+    if (!timeout->expired && deadline_ns != TIME_NEVER)
+        ktimer_add(&timeout->timer, deadline_ns);
+}
+
+bool wait_timeout_expired(wait_timeout* timeout) {
+    // either timer sees BLOCKED state and wakes thread up, or thread sees
+    // expired flag here
+    smp_mb();
+    return timeout->expired;
+}
+
+void wait_timeout_stop(wait_timeout* timeout) {
+    ktimer_cancel(&timeout->timer);
+}
\ No newline at end of file
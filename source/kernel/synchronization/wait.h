@@ -1,8 +1,24 @@
 #ifndef SOS_WAIT_H
 #define SOS_WAIT_H
 
+#include "../error/errno.h"
 #include "../threading/process.h"
 #include "../threading/thread.h"
+#include "../time/timer_wheel.h"
+
+// Wakes up waiting thread once monotonic time reaches deadline
+typedef struct {
+    ktimer timer;
+    thread* waiter;
+    volatile bool expired;
+} wait_timeout;
+
+// TIME_NEVER deadline never expires
+void wait_timeout_start(wait_timeout* timeout, u64 deadline_ns);
+// Should be checked after waiting thread state is set to BLOCKED
+bool wait_timeout_expired(wait_timeout* timeout);
+// Waits for timer callback if it is running, so that timeout can go away
+void wait_timeout_stop(wait_timeout* timeout);
 
 #define WAIT_FOR_IRQ(lock, flags, cond)                                        \
     do {                                                                       \
@@ -53,4 +69,66 @@
         !___condition_met&& ___interrupted;                                    \
     })
 
+// Same as WAIT_FOR_IRQ, but gives up once monotonic time reaches deadline,
+// evaluates to true if condition is met
+#define WAIT_FOR_IRQ_TIMED(lock, flags, cond, deadline_ns)                     \
+    ({                                                                         \
+        wait_timeout ___timeout;                                               \
+        wait_timeout_start(&___timeout, (deadline_ns));                        \
+        bool ___condition_met;                                                 \
+        while (!(___condition_met = (cond))) {                                 \
+            get_current_thread()->state = BLOCKED;                             \
+                                                                               \
+            /* timer could fire before state was set to BLOCKED, its wakeup    \
+             * would be overridden, so recheck it here */                      \
+            if (wait_timeout_expired(&___timeout)) {                           \
+                get_current_thread()->state = RUNNING;                         \
+                break;                                                         \
+            }                                                                  \
+                                                                               \
+            spin_unlock_irq_restore((lock), (flags));                          \
+                                                                               \
+            schedule();                                                        \
+                                                                               \
+            (flags) = spin_lock_irq_save((lock));                              \
+        }                                                                      \
+        wait_timeout_stop(&___timeout);                                        \
+                                                                               \
+        ___condition_met;                                                      \
+    })
+
+// Same as WAIT_FOR_IRQ_INTERRUPTABLE, but gives up once monotonic time reaches
+// deadline, evaluates to 0 if condition is met, -EINTR if interrupted and
+// -ETIMEDOUT on timeout
+#define WAIT_FOR_IRQ_INTERRUPTABLE_TIMED(lock, flags, cond, deadline_ns)       \
+    ({                                                                         \
+        wait_timeout ___timeout;                                               \
+        wait_timeout_start(&___timeout, (deadline_ns));                        \
+        u64 ___result = 0;                                                     \
+        while (!(cond)) {                                                      \
+            get_current_thread()->state = BLOCKED;                             \
+                                                                               \
+            /* same as in WAIT_FOR_IRQ_INTERRUPTABLE, signal or timer could    \
+             * come before state was set to BLOCKED */                         \
+            if (thread_any_pending_signals() || process_any_pending_signals()) \
+                ___result = -EINTR;                                            \
+            else if (wait_timeout_expired(&___timeout))                        \
+                ___result = -ETIMEDOUT;                                        \
+                                                                               \
+            if (___result) {                                                   \
+                get_current_thread()->state = RUNNING;                         \
+                break;                                                         \
+            }                                                                  \
+                                                                               \
+            spin_unlock_irq_restore((lock), (flags));                          \
+                                                                               \
+            schedule();                                                        \
+                                                                               \
+            (flags) = spin_lock_irq_save((lock));                              \
+        }                                                                      \
+        wait_timeout_stop(&___timeout);                                        \
+                                                                               \
+        ___result;                                                             \
+    })
+
 #endif // SOS_WAIT_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "../arch/common/tls.h"
+#include "../error/errno.h"
+#include "../lib/util.h"
+#include "../memory/memory_map.h"
+#include "../memory/virtual/umem.h"
+#include "../threading/scheduler.h"
+#include "syscall.h"
+
+// Codes follow linux, only thread pointer ones are supported
+#define ARCH_SET_FS 0x1002
+#define ARCH_GET_FS 0x1003
+
+static u64 set_fs(u64 base) {
+    if (base > USER_SPACE_END_VADDR)
+        return -EPERM;
+
+    // syscalls run with interrupts disabled, so thread can't leave cpu
+    // between these two
+    get_current_thread()->tls = base;
+    arch_tls_write(base);
+    return 0;
+}
+
+static u64 get_fs(u64 address) {
+    u64 base = arch_tls_read();
+    if (!copy_to_user((void*) address, &base, sizeof(u64)))
+        return -EFAULT;
+
+    return 0;
+}
+
+u64 sys_arch_prctl(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    switch (arg0) {
+    case ARCH_SET_FS:
+        return set_fs(arg1);
+    case ARCH_GET_FS:
+        return get_fs(arg1);
+    default:
+        return -EINVAL;
+    }
+}
\ No newline at end of file
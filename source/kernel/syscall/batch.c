@@ -0,0 +1,75 @@
+#include "../error/errno.h"
+#include "../error/error.h"
+#include "../lib/util.h"
+#include "../memory/heap/kheap.h"
+#include "../memory/virtual/umem.h"
+#include "syscall.h"
+
+// Keeps kernel buffer for records bounded
+#define SYSCALL_BATCH_MAX_ENTRIES 256
+
+#define SYSCALL_BATCH_STOP_ON_ERROR 0x1
+
+typedef struct {
+    u64 number;
+    u64 args[6];
+    u64 result;
+} syscall_batch_entry;
+
+// Syscalls that don't return to caller or replace its context can't be part
+// of batch, as rest of batch has nowhere to continue
+static bool batchable(u64 syscall_number) {
+    switch (syscall_number) {
+    case SYS_SIGRET:
+    case SYS_PTHREAD_EXIT:
+    case SYS_EXIT:
+    case SYS_FORK:
+    case SYS_BATCH:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Runs entries in order and stores their results, returns count of entries
+// executed. Whole array is copied in once and results are copied out once.
+u64 sys_batch(u64 arg0, u64 arg1, u64 arg2, struct cpu_context* context) {
+    u64 count = arg1;
+    if (!count)
+        return 0;
+
+    if (count > SYSCALL_BATCH_MAX_ENTRIES
+        || arg2 & ~(u64) SYSCALL_BATCH_STOP_ON_ERROR)
+        return -EINVAL;
+
+    u64 size = count * sizeof(syscall_batch_entry);
+    syscall_batch_entry* entries = kmalloc(size);
+    if (!entries)
+        return -ENOMEM;
+
+    if (!copy_from_user(entries, (void*) arg0, size)) {
+        kfree(entries);
+        return -EFAULT;
+    }
+
+    u64 executed = 0;
+    while (executed < count) {
+        syscall_batch_entry* entry = &entries[executed++];
+        u64* args = entry->args;
+
+        entry->result =
+            batchable(entry->number)
+                ? handle_syscall(args[0], args[1], args[2], args[3], args[4],
+                                 args[5], entry->number, context)
+                : (u64) -EINVAL;
+
+        if (IS_ERROR(entry->result) && arg2 & SYSCALL_BATCH_STOP_ON_ERROR)
+            break;
+    }
+
+    bool copied = copy_to_user((void*) arg0, entries,
+                               executed * sizeof(syscall_batch_entry));
+    kfree(entries);
+
+    return copied ? executed : (u64) -EFAULT;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "../error/errno.h"
+#include "../futex/futex.h"
+#include "../lib/util.h"
+#include "../memory/virtual/umem.h"
+#include "../time/clock.h"
+#include "../time/clockevent.h"
+#include "../time/timer.h"
+#include "syscall.h"
+
+// Timeout of FUTEX_WAIT is relative, no timeout stands for waiting forever
+static u64 futex_wait_timeout(u64 timeout_ptr, u64* deadline) {
+    *deadline = TIME_NEVER;
+    if (!timeout_ptr)
+        return 0;
+
+    timespec timeout;
+    if (!copy_from_user(&timeout, (void*) timeout_ptr, sizeof(timespec)))
+        return -EFAULT;
+
+    u64 duration;
+    if (!timespec_to_ns(&timeout, &duration))
+        return -EINVAL;
+
+    *deadline = timer_deadline_ns(duration);
+    return 0;
+}
+
+// Arguments follow linux: arg2 is value or wake count, arg3 is timeout or
+// second count, arg4 is second futex and arg5 is value to compare or encoded
+// operation
+u64 sys_futex(u64 arg0, u64 arg1, u64 arg2, u64 arg3, u64 arg4, u64 arg5,
+              struct cpu_context* context) {
+    UNUSED(context);
+
+    u32* uaddr = (u32*) arg0;
+    u32* uaddr2 = (u32*) arg4;
+
+    switch (arg1) {
+    case FUTEX_WAIT: {
+        u64 deadline;
+        u64 result = futex_wait_timeout(arg3, &deadline);
+        return result ? result : futex_wait(uaddr, arg2, deadline);
+    }
+    case FUTEX_WAKE:
+        return futex_wake(uaddr, arg2);
+    case FUTEX_REQUEUE:
+        return futex_requeue(uaddr, arg2, arg3, uaddr2, false, 0);
+    case FUTEX_CMP_REQUEUE:
+        return futex_requeue(uaddr, arg2, arg3, uaddr2, true, arg5);
+    case FUTEX_WAKE_OP:
+        return futex_wake_op(uaddr, arg2, uaddr2, arg3, arg5);
+    default:
+        return -EINVAL;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include "../io_ring/io_ring.h"
+#include "../lib/util.h"
+#include "syscall.h"
+
+u64 sys_io_ring_setup(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    return io_ring_setup(arg0, arg1);
+}
+
+u64 sys_io_enter(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    return io_ring_enter(arg0, arg1);
+}
\ No newline at end of file
@@ -1,13 +1,29 @@
+#include "../error/error.h"
 #include "../lib/kprint.h"
 #include "../lib/util.h"
+#include "../memory/virtual/umem.h"
+
+// String is copied and printed by chunks of this size
+#define PRINT_CHUNK_SIZE 128
 
 struct cpu_context;
 
 u64 sys_print(u64 arg0, struct cpu_context* context) {
     UNUSED(context);
-    print((string) arg0);
 
-    return 0;
+    char chunk[PRINT_CHUNK_SIZE];
+    const char* str = (const char*) arg0;
+    while (true) {
+        u64 copied = copy_string_from_user(chunk, str, PRINT_CHUNK_SIZE);
+        if (IS_ERROR(copied))
+            return copied;
+
+        print(chunk);
+        if (copied < PRINT_CHUNK_SIZE - 1)
+            return 0;
+
+        str += copied;
+    }
 }
 
 u64 sys_print_u64(u64 arg0, struct cpu_context* context) {
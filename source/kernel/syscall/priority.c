@@ -0,0 +1,36 @@
+#include "../error/errno.h"
+#include "../error/error.h"
+#include "../lib/types.h"
+#include "../lib/util.h"
+#include "../threading/process.h"
+#include "syscall.h"
+
+// Only per process priorities are supported
+#define PRIO_PROCESS 0
+
+// Nice value is returned biased by 20 (as Linux does), so that it can't be
+// confused with error code
+#define NICE_RETURN_BIAS 20
+
+u64 sys_setpriority(u64 arg0, u64 arg1, u64 arg2, struct cpu_context* context) {
+    UNUSED(context);
+
+    if (arg0 != PRIO_PROCESS)
+        return -EINVAL;
+
+    return process_set_nice(arg1, (i32) arg2);
+}
+
+u64 sys_getpriority(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    if (arg0 != PRIO_PROCESS)
+        return -EINVAL;
+
+    i32 nice;
+    u64 result = process_get_nice(arg1, &nice);
+    if (IS_ERROR(result))
+        return result;
+
+    return NICE_RETURN_BIAS - nice;
+}
@@ -0,0 +1,11 @@
+#include "../lib/util.h"
+#include "../rseq/rseq.h"
+#include "syscall.h"
+
+// Arguments follow linux: area, its length, flags and abort signature
+u64 sys_rseq(u64 arg0, u64 arg1, u64 arg2, u64 arg3,
+             struct cpu_context* context) {
+    UNUSED(context);
+
+    return rseq_register(arg0, arg1, arg2, (u32) arg3);
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "../error/errno.h"
+#include "../error/error.h"
+#include "../lib/types.h"
+#include "../lib/util.h"
+#include "../memory/virtual/umem.h"
+#include "../threading/process.h"
+#include "../threading/scheduler.h"
+#include "syscall.h"
+
+u64 sys_sched_setscheduler(u64 arg0, u64 arg1, u64 arg2,
+                           struct cpu_context* context) {
+    UNUSED(context);
+
+    if (arg1 > 0xFF || arg2 > 0xFF)
+        return -EINVAL;
+
+    // deadline policy needs parameters, which only sched_setattr passes
+    sched_attr attr = {.policy = arg1, .priority = arg2};
+    return process_set_scheduler(arg0, &attr);
+}
+
+u64 sys_sched_getscheduler(u64 arg0, struct cpu_context* context) {
+    UNUSED(context);
+
+    sched_attr attr;
+    u64 result = process_get_scheduler(arg0, &attr);
+    return IS_ERROR(result) ? result : attr.policy;
+}
+
+u64 sys_sched_setattr(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    sched_attr attr;
+    if (!copy_from_user(&attr, (void*) arg1, sizeof(sched_attr)))
+        return -EFAULT;
+
+    return process_set_scheduler(arg0, &attr);
+}
+
+u64 sys_sched_getattr(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    sched_attr attr;
+    u64 result = process_get_scheduler(arg0, &attr);
+    if (IS_ERROR(result))
+        return result;
+
+    return copy_to_user((void*) arg1, &attr, sizeof(sched_attr)) ? 0 : -EFAULT;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "../lib/types.h"
+#include "../lib/util.h"
+#include "../memory/virtual/shm.h"
+#include "../threading/scheduler.h"
+#include "syscall.h"
+
+u64 sys_shm_create(u64 arg0, struct cpu_context* context) {
+    UNUSED(context);
+
+    return shm_create(arg0);
+}
+
+u64 sys_shm_attach(u64 arg0, u64 arg1, u64 arg2, struct cpu_context* context) {
+    UNUSED(context);
+
+    return shm_attach(get_current_thread()->proc->vm, arg0, arg1, arg2 != 0);
+}
+
+u64 sys_shm_detach(u64 arg0, struct cpu_context* context) {
+    UNUSED(context);
+
+    return shm_detach(get_current_thread()->proc->vm, arg0);
+}
+
+u64 sys_shm_remove(u64 arg0, struct cpu_context* context) {
+    UNUSED(context);
+
+    return shm_remove(arg0);
+}
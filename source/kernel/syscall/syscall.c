@@ -53,6 +53,29 @@ static syscall_descriptor syscall_handlers[1024] = {
     [SYS_WAIT] = SYSCALL2(sys_wait),
     [SYS_GETPID] = SYSCALL0(sys_getpid),
 
+    [SYS_SHM_CREATE] = SYSCALL1(sys_shm_create),
+    [SYS_SHM_ATTACH] = SYSCALL3(sys_shm_attach),
+    [SYS_SHM_DETACH] = SYSCALL1(sys_shm_detach),
+    [SYS_SHM_REMOVE] = SYSCALL1(sys_shm_remove),
+
+    [SYS_SETPRIORITY] = SYSCALL3(sys_setpriority),
+    [SYS_GETPRIORITY] = SYSCALL2(sys_getpriority),
+    [SYS_SCHED_SETSCHEDULER] = SYSCALL3(sys_sched_setscheduler),
+    [SYS_SCHED_GETSCHEDULER] = SYSCALL1(sys_sched_getscheduler),
+    [SYS_SCHED_SETATTR] = SYSCALL2(sys_sched_setattr),
+    [SYS_SCHED_GETATTR] = SYSCALL2(sys_sched_getattr),
+    [SYS_CLOCK_GETTIME] = SYSCALL2(sys_clock_gettime),
+    [SYS_CLOCK_GETRES] = SYSCALL2(sys_clock_getres),
+    [SYS_NANOSLEEP] = SYSCALL2(sys_nanosleep),
+
+    [SYS_BATCH] = SYSCALL3(sys_batch),
+    [SYS_IO_RING_SETUP] = SYSCALL2(sys_io_ring_setup),
+    [SYS_IO_ENTER] = SYSCALL2(sys_io_enter),
+
+    [SYS_FUTEX] = SYSCALL6(sys_futex),
+    [SYS_RSEQ] = SYSCALL4(sys_rseq),
+    [SYS_ARCH_PRCTL] = SYSCALL2(sys_arch_prctl),
+
     [SYSCALLS_IMPLEMENTED_COUNT + 1 ... SYSCALLS_MAX_COUNT - 1] = {0}};
 
 u64 handle_syscall(u64 arg0, u64 arg1, u64 arg2, u64 arg3, u64 arg4, u64 arg5,
@@ -20,7 +20,28 @@
 #define SYS_WAIT 10
 #define SYS_GETPID 11
 
-#define SYSCALLS_IMPLEMENTED_COUNT 12
+#define SYS_SHM_CREATE 12
+#define SYS_SHM_ATTACH 13
+#define SYS_SHM_DETACH 14
+#define SYS_SHM_REMOVE 15
+
+#define SYS_SETPRIORITY 16
+#define SYS_GETPRIORITY 17
+#define SYS_SCHED_SETSCHEDULER 18
+#define SYS_SCHED_GETSCHEDULER 19
+#define SYS_SCHED_SETATTR 20
+#define SYS_SCHED_GETATTR 21
+#define SYS_CLOCK_GETTIME 22
+#define SYS_CLOCK_GETRES 23
+#define SYS_NANOSLEEP 24
+#define SYS_BATCH 25
+#define SYS_IO_RING_SETUP 26
+#define SYS_IO_ENTER 27
+#define SYS_FUTEX 28
+#define SYS_RSEQ 29
+#define SYS_ARCH_PRCTL 30
+
+#define SYSCALLS_IMPLEMENTED_COUNT 31
 #define SYSCALLS_MAX_COUNT 1024
 
 struct cpu_context;
@@ -49,4 +70,35 @@ u64 sys_fork(struct cpu_context* context);
 u64 sys_wait(u64 arg0, u64 arg1, struct cpu_context* context);
 u64 sys_getpid(struct cpu_context* context);
 
+u64 sys_shm_create(u64 arg0, struct cpu_context* context);
+u64 sys_shm_attach(u64 arg0, u64 arg1, u64 arg2, struct cpu_context* context);
+u64 sys_shm_detach(u64 arg0, struct cpu_context* context);
+u64 sys_shm_remove(u64 arg0, struct cpu_context* context);
+
+u64 sys_setpriority(u64 arg0, u64 arg1, u64 arg2, struct cpu_context* context);
+u64 sys_getpriority(u64 arg0, u64 arg1, struct cpu_context* context);
+
+u64 sys_sched_setscheduler(u64 arg0, u64 arg1, u64 arg2,
+                           struct cpu_context* context);
+u64 sys_sched_getscheduler(u64 arg0, struct cpu_context* context);
+u64 sys_sched_setattr(u64 arg0, u64 arg1, struct cpu_context* context);
+u64 sys_sched_getattr(u64 arg0, u64 arg1, struct cpu_context* context);
+
+u64 sys_clock_gettime(u64 arg0, u64 arg1, struct cpu_context* context);
+u64 sys_clock_getres(u64 arg0, u64 arg1, struct cpu_context* context);
+u64 sys_nanosleep(u64 arg0, u64 arg1, struct cpu_context* context);
+
+u64 sys_batch(u64 arg0, u64 arg1, u64 arg2, struct cpu_context* context);
+
+u64 sys_io_ring_setup(u64 arg0, u64 arg1, struct cpu_context* context);
+u64 sys_io_enter(u64 arg0, u64 arg1, struct cpu_context* context);
+
+u64 sys_futex(u64 arg0, u64 arg1, u64 arg2, u64 arg3, u64 arg4, u64 arg5,
+              struct cpu_context* context);
+
+u64 sys_rseq(u64 arg0, u64 arg1, u64 arg2, u64 arg3,
+             struct cpu_context* context);
+
+u64 sys_arch_prctl(u64 arg0, u64 arg1, struct cpu_context* context);
+
 #endif // SOS_SYSCALL_H
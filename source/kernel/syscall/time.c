@@ -0,0 +1,60 @@
+#include "../error/errno.h"
+#include "../lib/util.h"
+#include "../memory/virtual/umem.h"
+#include "../threading/thread.h"
+#include "../time/clock.h"
+#include "../time/timer.h"
+#include "syscall.h"
+
+u64 sys_clock_gettime(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    timespec time;
+    if (!clock_gettime(arg0, &time))
+        return -EINVAL;
+
+    return copy_to_user((void*) arg1, &time, sizeof(timespec)) ? 0 : -EFAULT;
+}
+
+u64 sys_clock_getres(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    timespec resolution;
+    if (!clock_getres(arg0, &resolution))
+        return -EINVAL;
+
+    // as in posix, resolution may be discarded
+    if (!arg1)
+        return 0;
+
+    return copy_to_user((void*) arg1, &resolution, sizeof(timespec))
+               ? 0
+               : -EFAULT;
+}
+
+u64 sys_nanosleep(u64 arg0, u64 arg1, struct cpu_context* context) {
+    UNUSED(context);
+
+    timespec request;
+    if (!copy_from_user(&request, (void*) arg0, sizeof(timespec)))
+        return -EFAULT;
+
+    u64 duration;
+    if (!timespec_to_ns(&request, &duration))
+        return -EINVAL;
+
+    u64 deadline = timer_deadline_ns(duration);
+    if (thread_sleep_until(deadline))
+        return 0;
+
+    // interrupted sleep reports time left, so that it can be resumed
+    if (arg1) {
+        u64 now = timer_now_ns();
+        timespec remaining = timespec_from_ns(deadline > now ? deadline - now
+                                                             : 0);
+        if (!copy_to_user((void*) arg1, &remaining, sizeof(timespec)))
+            return -EFAULT;
+    }
+
+    return -EINTR;
+}
\ No newline at end of file
@@ -50,6 +50,7 @@ bool kthread_init(kthread* thrd, string name, kthread_func* func) {
     thrd->finish_cvar = (con_var) CON_VAR_STATIC_INITIALIZER;
     thrd->lock = SPIN_LOCK_STATIC_INITIALIZER;
     thrd->scheduler_node = (linked_list_node) LINKED_LIST_NODE_OF(thrd);
+    scheduler_thread_init(thrd);
 
     // Each kernel thread runs as separate thread group inside kernel process
     if (!process_add_thread(&kernel_process, (struct thread*) thrd))
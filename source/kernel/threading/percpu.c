@@ -0,0 +1,13 @@
+#include "percpu.h"
+
+static percpu cpus_data[MAX_CPUS];
+
+void percpu_init(u64 cpu) {
+    percpu* area = &cpus_data[cpu];
+    area->self = area;
+    area->id = cpu;
+
+    arch_percpu_set(area);
+}
+
+percpu* percpu_of(u64 cpu) { return &cpus_data[cpu]; }
@@ -0,0 +1,59 @@
+#ifndef SOS_PERCPU_H
+#define SOS_PERCPU_H
+
+#include "../arch/common/percpu.h"
+#include "../arch/common/smp.h"
+
+struct _thread;
+
+typedef struct {
+    u64 context_switches;
+    u64 interrupts;
+} percpu_stats;
+
+// Data owned by single cpu. Every field is 8 bytes wide, so that it can be
+// accessed with this_cpu_* accessors.
+typedef struct percpu {
+    struct percpu* self;
+    u64 id;
+
+    struct _thread* current; // changed only by owning cpu under scheduler lock
+    struct _thread* idle;    // runs when there is nothing else to do
+    struct run_queue* run_queue;
+
+    void* tss; // arch specific task state, if any
+
+    // Top of kernel stack of current thread and scratch slot for user stack
+    // pointer, used by arch syscall entry that starts on user stack
+    u64 kernel_stack;
+    u64 user_stack;
+
+    percpu_stats stats;
+} percpu;
+
+#define PERCPU_OFFSET(field) __builtin_offsetof(percpu, field)
+#define PERCPU_FIELD_TYPE(field) __typeof__(((percpu*) 0)->field)
+
+#define this_cpu_read(field)                                                   \
+    ((PERCPU_FIELD_TYPE(field)) arch_this_cpu_read(PERCPU_OFFSET(field)))
+
+#define this_cpu_write(field, value)                                           \
+    arch_this_cpu_write(PERCPU_OFFSET(field), (u64) (value))
+
+#define this_cpu_add(field, value)                                             \
+    arch_this_cpu_add(PERCPU_OFFSET(field), (u64) (value))
+
+#define this_cpu_inc(field) this_cpu_add(field, 1)
+
+// Pointer to area of current cpu, is only meaningful while thread can't
+// migrate (interrupts disabled)
+#define this_cpu() this_cpu_read(self)
+#define this_cpu_id() this_cpu_read(id)
+
+// Sets up area of provided cpu and makes it current cpu area, should be
+// called once on every cpu right after its gdt is loaded
+void percpu_init(u64 cpu);
+
+percpu* percpu_of(u64 cpu);
+
+#endif // SOS_PERCPU_H
@@ -1,9 +1,14 @@
 #include "process.h"
 #include "../arch/common/context.h"
+#include "../arch/common/fpu.h"
+#include "../arch/common/tls.h"
 #include "../error/errno.h"
+#include "../error/error.h"
+#include "../io_ring/io_ring.h"
 #include "../lib/container/hash_table/hash_table.h"
 #include "../memory/virtual/vmm.h"
 #include "../synchronization/wait.h"
+#include "../vdso/vdso.h"
 #include "scheduler.h"
 #include "thread_cleaner.h"
 #include "uthread.h"
@@ -53,12 +58,16 @@ static bool process_init(process* proc, bool is_kernel_process) {
     if (!proc->vm)
         goto failed_to_fork_vm_space;
 
+    if (!is_kernel_process && !vdso_install(proc->vm, proc->id))
+        goto failed_to_install_vdso;
+
     if (!id_generator_init(&proc->tgid_generator))
         goto failed_to_init_tgid_generator;
 
     proc->process_node = (linked_list_node) LINKED_LIST_NODE_OF(proc);
 
     proc->kernel_process = is_kernel_process;
+    proc->io_ring = NULL;
     proc->lock = SPIN_LOCK_STATIC_INITIALIZER;
     proc->refc = (ref_count) REF_COUNT_STATIC_INITIALIZER;
     proc->exiting = false;
@@ -70,6 +79,7 @@ static bool process_init(process* proc, bool is_kernel_process) {
     return true;
 
 failed_to_init_tgid_generator:
+failed_to_install_vdso:
     vm_space_destroy(proc->vm);
 
 failed_to_fork_vm_space:
@@ -96,6 +106,7 @@ static process* create_user_process() {
 }
 
 void process_destroy(process* proc) {
+    io_ring_destroy(proc->io_ring);
     vm_space_destroy(proc->vm);
     id_generator_free_id(&pid_gen, proc->id);
     id_generator_deinit(&proc->tgid_generator);
@@ -125,6 +136,16 @@ u64 process_fork(struct cpu_context* context) {
     if (!start_thread)
         goto failed_to_create_start_process_thread;
 
+    io_ring_unmap(proc->io_ring, created->vm);
+
+    // address space is copied, so registration stays valid in child
+    start_thread->rseq = current->rseq;
+    start_thread->rseq_signature = current->rseq_signature;
+    start_thread->rseq_resume = current->rseq != 0;
+    start_thread->tls = arch_tls_read();
+    start_thread->tls_aux = arch_tls_user_writable() ? arch_tls_aux_read() : 0;
+    arch_fpu_clone(start_thread);
+
     bool interrupts_enabled = spin_lock_irq_save(&proc->siginfo_lock);
     memcpy(&created->siginfo, &proc->siginfo, sizeof(process_siginfo));
     created->siginfo.pending_signals = PENDING_SIGNALS_CLEAR;
@@ -165,40 +186,33 @@ static bool process_is_finished(process* proc) {
     return finished;
 }
 
-u64 process_wait(u64 pid, u64* exit_code) {
-    process* proc = get_current_thread()->proc;
-    linked_list_node* exited_node = NULL;
-    bool interrupted;
+// Looks for finished child with provided pid (0 stands for any child),
+// assumes that process lock is held. Returns 0 if child is found, -EAGAIN if
+// it is still running, -ECHILD if there are no children and -EINVAL if there
+// is no such child.
+static u64 process_find_finished_child_unsafe(process* proc, u64 pid,
+                                              linked_list_node** exited_node) {
+    if (proc->children.size == 0)
+        return -ECHILD;
 
-    bool interrupts_enabled = spin_lock_irq_save(&proc->lock);
     if (!pid) {
-        interrupted = WAIT_FOR_IRQ_INTERRUPTABLE(
-            &proc->lock, interrupts_enabled,
-            proc->children.size == 0
-                || (exited_node = LINKED_LIST_FIND(
-                        &proc->children, child_node,
-                        process_is_finished(child_node->value))));
-    } else {
-        interrupted = WAIT_FOR_IRQ_INTERRUPTABLE(
-            &proc->lock, interrupts_enabled,
-            proc->children.size == 0
-                || !(exited_node = LINKED_LIST_FIND(
-                         &proc->children, child_node,
-                         ((process*) child_node->value)->id == pid))
-                || process_is_finished(exited_node->value));
+        *exited_node =
+            LINKED_LIST_FIND(&proc->children, child_node,
+                             process_is_finished(child_node->value));
+        return *exited_node ? 0 : -EAGAIN;
     }
 
-    if (!interrupted && proc->children.size == 0) {
-        spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
-        return -ECHILD;
-    } else if (!interrupted && !exited_node) {
-        spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
+    *exited_node = LINKED_LIST_FIND(&proc->children, child_node,
+                                    ((process*) child_node->value)->id == pid);
+    if (!*exited_node)
         return -EINVAL;
-    } else if (interrupted) {
-        spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
-        return -EINTR;
-    }
 
+    return process_is_finished((*exited_node)->value) ? 0 : -EAGAIN;
+}
+
+// Frees finished child, assumes that process lock is held
+static u64 process_reap_child_unsafe(linked_list_node* exited_node,
+                                     u64* exit_code) {
     process* exited = exited_node->value;
     spin_lock(&exited->lock);
     u64 exit_pid = exited->id;
@@ -206,11 +220,43 @@ u64 process_wait(u64 pid, u64* exit_code) {
     spin_unlock(&exited->lock);
 
     process_remove_child_unsafe(exited);
-    spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
 
     return exit_pid;
 }
 
+u64 process_wait(u64 pid, u64* exit_code) {
+    process* proc = get_current_thread()->proc;
+    linked_list_node* exited_node = NULL;
+    u64 result;
+
+    bool interrupts_enabled = spin_lock_irq_save(&proc->lock);
+    bool interrupted = WAIT_FOR_IRQ_INTERRUPTABLE(
+        &proc->lock, interrupts_enabled,
+        (result = process_find_finished_child_unsafe(proc, pid, &exited_node))
+            != (u64) -EAGAIN);
+
+    if (interrupted)
+        result = -EINTR;
+    else if (!IS_ERROR(result))
+        result = process_reap_child_unsafe(exited_node, exit_code);
+    spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
+
+    return result;
+}
+
+u64 process_try_wait(u64 pid, u64* exit_code) {
+    process* proc = get_current_thread()->proc;
+    linked_list_node* exited_node = NULL;
+
+    bool interrupts_enabled = spin_lock_irq_save(&proc->lock);
+    u64 result = process_find_finished_child_unsafe(proc, pid, &exited_node);
+    if (!IS_ERROR(result))
+        result = process_reap_child_unsafe(exited_node, exit_code);
+    spin_unlock_irq_restore(&proc->lock, interrupts_enabled);
+
+    return result;
+}
+
 static void process_transfer_child_to_init(process* child) {
     process* proc = get_current_thread()->proc;
     if (proc == &init_process)
@@ -277,8 +323,10 @@ static void process_finalize() {
     // current process to init), but we should not bother signaling exact
     // parent, since if current thread has been moved to init as child, it
     // will be signaled anyway.
-    if (parent)
+    if (parent) {
         process_signal(parent, SIGCHLD);
+        io_ring_notify(parent);
+    }
     spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
 
     process_transfer_children_to_init();
@@ -395,6 +443,90 @@ bool process_signal(process* proc, signal sig) {
     return true;
 }
 
+// Should be called with process table lock held, which keeps found process
+// alive
+static process* process_find_unsafe(u64 pid) {
+    if (!pid)
+        return get_current_thread()->proc;
+
+    return hash_table_get(&process_table, pid);
+}
+
+u64 process_set_nice(u64 pid, i32 nice) {
+    bool interrupts_enabled = spin_lock_irq_save(&process_table_lock);
+    process* proc = process_find_unsafe(pid);
+    if (!proc || proc->kernel_process) {
+        spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+        return proc ? -EPERM : -ESRCH;
+    }
+
+    spin_lock(&proc->lock);
+    ARRAY_LIST_FOR_EACH(&proc->threads, thread * iter) {
+        scheduler_set_nice(iter, nice);
+    }
+    spin_unlock(&proc->lock);
+
+    spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+    return 0;
+}
+
+u64 process_get_nice(u64 pid, i32* nice) {
+    bool interrupts_enabled = spin_lock_irq_save(&process_table_lock);
+    process* proc = process_find_unsafe(pid);
+    if (!proc) {
+        spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+        return -ESRCH;
+    }
+
+    spin_lock(&proc->lock);
+    bool found = proc->threads.size != 0;
+    if (found)
+        *nice = scheduler_get_nice(array_list_get(&proc->threads, 0));
+    spin_unlock(&proc->lock);
+
+    spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+    return found ? 0 : -ESRCH;
+}
+
+u64 process_set_scheduler(u64 pid, const sched_attr* attr) {
+    bool interrupts_enabled = spin_lock_irq_save(&process_table_lock);
+    process* proc = process_find_unsafe(pid);
+    if (!proc || proc->kernel_process) {
+        spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+        return proc ? -EPERM : -ESRCH;
+    }
+
+    u64 result = 0;
+    spin_lock(&proc->lock);
+    ARRAY_LIST_FOR_EACH(&proc->threads, thread * iter) {
+        result = scheduler_set_policy(iter, attr);
+        if (IS_ERROR(result))
+            break;
+    }
+    spin_unlock(&proc->lock);
+
+    spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+    return result;
+}
+
+u64 process_get_scheduler(u64 pid, sched_attr* attr) {
+    bool interrupts_enabled = spin_lock_irq_save(&process_table_lock);
+    process* proc = process_find_unsafe(pid);
+    if (!proc) {
+        spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+        return -ESRCH;
+    }
+
+    spin_lock(&proc->lock);
+    bool found = proc->threads.size != 0;
+    if (found)
+        scheduler_get_attr(array_list_get(&proc->threads, 0), attr);
+    spin_unlock(&proc->lock);
+
+    spin_unlock_irq_restore(&process_table_lock, interrupts_enabled);
+    return found ? 0 : -ESRCH;
+}
+
 bool process_set_sigaction(signal sig, sigaction action) {
     process* proc = get_current_thread()->proc;
 
@@ -9,6 +9,8 @@
 #include "../synchronization/spin_lock.h"
 
 struct thread;
+struct sched_attr;
+struct io_ring;
 
 typedef struct {
     sigpending pending_signals;
@@ -27,6 +29,7 @@ typedef struct _process {
     // End of immutable data
 
     vm_space* vm;
+    struct io_ring* io_ring; // set once under process lock, may be NULL
 
     process_siginfo siginfo;
     lock siginfo_lock; // guards siginfo
@@ -55,6 +58,8 @@ void processing_init();
 
 u64 process_fork(struct cpu_context* context);
 u64 process_wait(u64 pid, u64* exit_code);
+// Same as process_wait, but returns -EAGAIN instead of waiting for child
+u64 process_try_wait(u64 pid, u64* exit_code);
 
 bool process_signal(process* proc, signal sig);
 bool process_add_thread(process* proc, struct thread* thrd);
@@ -64,6 +69,20 @@ void process_kill(process* proc);
 _Noreturn void process_exit_thread();
 _Noreturn void process_exit(u64 exit_code);
 
+// Sets nice value of every thread of process with provided pid (0 stands for
+// current process), returns 0 or negative error code
+u64 process_set_nice(u64 pid, i32 nice);
+// Nice value of process is nice value of its first thread
+u64 process_get_nice(u64 pid, i32* nice);
+
+// Sets scheduling policy of every thread of process with provided pid (0
+// stands for current process), see scheduler_set_policy. Deadline bandwidth
+// is reserved for every thread, on failure threads already changed keep new
+// policy.
+u64 process_set_scheduler(u64 pid, const struct sched_attr* attr);
+// Scheduling policy of process is policy of its first thread
+u64 process_get_scheduler(u64 pid, struct sched_attr* attr);
+
 bool process_set_sigaction(signal sig, sigaction action);
 sigaction process_get_sigaction(signal sig);
 bool process_any_pending_signals();
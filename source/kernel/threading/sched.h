@@ -0,0 +1,129 @@
+#ifndef SOS_SCHED_H
+#define SOS_SCHED_H
+
+// Internal interface between scheduler core and scheduling classes
+
+#include "../lib/container/linked_list/linked_list.h"
+#include "../lib/container/rb_tree/rb_tree.h"
+#include "../time/clockevent.h"
+#include "percpu.h"
+#include "scheduler.h"
+#include "thread.h"
+
+#define RT_PRIORITIES (RT_PRIORITY_MAX + 1)
+#define RT_BITMAP_WORDS ((RT_PRIORITIES + 63) / 64)
+
+typedef struct {
+    rb_tree threads;  // queued threads ordered by vruntime
+    u64 load;         // sum of weights of queued threads
+    u64 min_vruntime; // monotonic, tracks smallest vruntime on this cpu
+} fair_run_queue;
+
+typedef struct {
+    rb_tree ready;     // threads with budget left, ordered by deadline
+    rb_tree throttled; // threads waiting for replenishment at their deadline
+} dl_run_queue;
+
+typedef struct {
+    linked_list queues[RT_PRIORITIES]; // fifo of threads for each priority
+    u64 bitmap[RT_BITMAP_WORDS]; // non empty queues
+    u64 size;
+
+    u64 period_start; // start of current throttling period
+    u64 time;         // time spent running rt threads within period
+    bool throttled;
+} rt_run_queue;
+
+/*
+ * Each cpu has its own run queue. Thread belongs to run queue of thread->cpu,
+ * which can be changed only with that run queue locked. Run queue lock also
+ * guards scheduler fields of threads that belong to it.
+ *
+ * Locking order: run queues with lower cpu index go first. Cpu which already
+ * holds its run queue lock may only try-lock others.
+ */
+typedef struct run_queue {
+    lock lock;
+    u64 size; // queued threads of all classes
+    u64 cpu;
+    u64 next_balance; // time this cpu should balance run queues at
+
+    dl_run_queue dl;
+    rt_run_queue rt;
+    fair_run_queue fair;
+} run_queue;
+
+typedef enum {
+    ENQUEUE_NEW,       // thread has never run
+    ENQUEUE_WAKEUP,    // thread was blocked
+    ENQUEUE_PREEMPTED, // thread was running and got preempted
+    ENQUEUE_RESTORE    // thread is requeued after migration or param change
+} enqueue_reason;
+
+/*
+ * Scheduling class implements one family of policies. Classes are consulted
+ * in priority order, thread of higher class always runs before threads of
+ * lower classes. All operations are called with run queue locked.
+ */
+typedef struct sched_class {
+    void (*enqueue)(run_queue* rq, thread* thrd, enqueue_reason reason);
+    void (*dequeue)(run_queue* rq, thread* thrd);
+
+    // Thread that should run next, without removing it from run queue
+    thread* (*peek)(run_queue* rq);
+
+    // Charges current thread for time it spent on cpu
+    void (*update_current)(run_queue* rq, thread* current, u64 delta);
+
+    // Called on every scheduling decision with current time
+    void (*refresh)(run_queue* rq, u64 now);
+
+    // Whether current thread of this class should give up cpu, while queued
+    // threads of same or lower classes exist
+    bool (*check_preempt)(run_queue* rq, thread* current);
+
+    // Whether woken thread of this class should preempt current thread of
+    // same class
+    bool (*wakeup_preempt)(thread* current, thread* woken);
+
+    // Time current thread should be reconsidered at, or other deadline of
+    // this class on this run queue, TIME_NEVER if there is none. Current
+    // thread may be of other class or NULL if cpu is idle.
+    u64 (*next_event)(run_queue* rq, thread* current, u64 now);
+
+    // Rebases thread data relative to run queue, thread is not queued
+    void (*migrate)(run_queue* from, run_queue* to, thread* thrd);
+} sched_class;
+
+extern const sched_class dl_sched_class;
+extern const sched_class rt_sched_class;
+extern const sched_class fair_sched_class;
+
+bool dl_deadline_less(const rb_tree_node* a, const rb_tree_node* b);
+
+#define DL_RUN_QUEUE_STATIC_INITIALIZER                                        \
+    {                                                                          \
+        .ready = RB_TREE_STATIC_INITIALIZER(dl_deadline_less),                 \
+        .throttled = RB_TREE_STATIC_INITIALIZER(dl_deadline_less)              \
+    }
+
+// Longest deadline period, keeps budget arithmetic from overflowing
+#define DL_PERIOD_MAX_NS 4000000000UL
+
+// Reserves bandwidth for deadline thread with provided parameters, replacing
+// its previous reservation. Zero runtime releases reservation. Returns false
+// if total reserved bandwidth would exceed limit.
+bool dl_reserve_bandwidth(thread* thrd, u64 runtime, u64 period);
+
+bool fair_vruntime_less(const rb_tree_node* a, const rb_tree_node* b);
+
+#define FAIR_RUN_QUEUE_STATIC_INITIALIZER                                      \
+    {                                                                          \
+        .threads = RB_TREE_STATIC_INITIALIZER(fair_vruntime_less), .load = 0,  \
+        .min_vruntime = 0                                                      \
+    }
+
+// Recomputes weight of fair thread from its nice value
+void fair_set_weight(thread* thrd);
+
+#endif // SOS_SCHED_H
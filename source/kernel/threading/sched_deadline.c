@@ -0,0 +1,168 @@
+#include "../arch/common/smp.h"
+#include "../lib/math.h"
+#include "../lib/util.h"
+#include "../synchronization/spin_lock.h"
+#include "../time/timer.h"
+#include "sched.h"
+
+/*
+ * Deadline class runs thread with earliest absolute deadline first (EDF).
+ * Every thread is served by constant bandwidth server (CBS): it may consume
+ * dl_runtime of cpu time before its deadline, after that it is throttled until
+ * deadline, when its budget is replenished and deadline is moved one period
+ * forward. So thread which overruns its reservation can't hurt others.
+ *
+ * Budget is charged on every scheduling decision, which timer interrupt
+ * triggers on every cpu, so it is enforced with timer tick precision.
+ */
+
+#define BANDWIDTH_SHIFT 20
+#define BANDWIDTH_ONE (1UL << BANDWIDTH_SHIFT)
+
+// Part of each cpu deadline threads may reserve, the rest is left to others
+#define BANDWIDTH_LIMIT_PER_CPU (BANDWIDTH_ONE * 95 / 100)
+
+static lock bandwidth_lock = SPIN_LOCK_STATIC_INITIALIZER;
+static u64 total_bandwidth = 0;
+
+bool dl_reserve_bandwidth(thread* thrd, u64 runtime, u64 period) {
+    u64 bandwidth = runtime ? (runtime << BANDWIDTH_SHIFT) / period : 0;
+    u64 limit = arch_cpus_count() * BANDWIDTH_LIMIT_PER_CPU;
+
+    bool interrupts_enabled = spin_lock_irq_save(&bandwidth_lock);
+    u64 new_total = total_bandwidth - thrd->sched.dl_bandwidth + bandwidth;
+    bool reserved = new_total <= limit;
+    if (reserved) {
+        total_bandwidth = new_total;
+        thrd->sched.dl_bandwidth = bandwidth;
+    }
+    spin_unlock_irq_restore(&bandwidth_lock, interrupts_enabled);
+
+    return reserved;
+}
+
+bool dl_deadline_less(const rb_tree_node* a, const rb_tree_node* b) {
+    return ((thread*) a->value)->sched.deadline
+           < ((thread*) b->value)->sched.deadline;
+}
+
+// Starts new period for thread whose budget is exhausted
+static void replenish(thread* thrd, u64 now) {
+    while (thrd->sched.dl_budget <= 0) {
+        thrd->sched.deadline += thrd->sched.dl_period;
+        thrd->sched.dl_budget += thrd->sched.dl_runtime;
+    }
+
+    // thread lagged too far behind, e.g. after migration to busy cpu
+    if (thrd->sched.deadline < now) {
+        thrd->sched.deadline = now + thrd->sched.dl_deadline;
+        thrd->sched.dl_budget = thrd->sched.dl_runtime;
+    }
+
+    thrd->sched.dl_throttled = false;
+}
+
+// CBS wakeup rule: if thread can't consume its remaining budget before its
+// deadline without exceeding reserved bandwidth, it gets new period
+static void update_deadline(thread* thrd, u64 now) {
+    u64 deadline = thrd->sched.deadline;
+    u64 budget = thrd->sched.dl_budget;
+
+    if (deadline <= now
+        || budget * thrd->sched.dl_period
+               > (deadline - now) * thrd->sched.dl_runtime) {
+        thrd->sched.deadline = now + thrd->sched.dl_deadline;
+        thrd->sched.dl_budget = thrd->sched.dl_runtime;
+    }
+}
+
+static rb_tree* thread_tree(run_queue* rq, thread* thrd) {
+    return thrd->sched.dl_throttled ? &rq->dl.throttled : &rq->dl.ready;
+}
+
+static void dl_enqueue(run_queue* rq, thread* thrd, enqueue_reason reason) {
+    u64 now = timer_now_ns();
+
+    if (thrd->sched.dl_throttled && thrd->sched.deadline <= now)
+        replenish(thrd, now);
+    else if (!thrd->sched.dl_throttled && reason != ENQUEUE_PREEMPTED)
+        update_deadline(thrd, now);
+
+    rb_tree_insert(thread_tree(rq, thrd), &thrd->sched.run_node);
+}
+
+static void dl_dequeue(run_queue* rq, thread* thrd) {
+    rb_tree_remove(thread_tree(rq, thrd), &thrd->sched.run_node);
+}
+
+static thread* dl_peek(run_queue* rq) {
+    rb_tree_node* node = rb_tree_first(&rq->dl.ready);
+    return node ? (thread*) node->value : NULL;
+}
+
+static void dl_update_current(run_queue* rq, thread* current, u64 delta) {
+    UNUSED(rq);
+
+    current->sched.dl_budget -= (i64) delta;
+    if (current->sched.dl_budget <= 0)
+        current->sched.dl_throttled = true;
+}
+
+static void dl_refresh(run_queue* rq, u64 now) {
+    rb_tree_node* node;
+    while ((node = rb_tree_first(&rq->dl.throttled))) {
+        thread* thrd = node->value;
+        if (thrd->sched.deadline > now)
+            break;
+
+        rb_tree_remove(&rq->dl.throttled, node);
+        replenish(thrd, now);
+        rb_tree_insert(&rq->dl.ready, node);
+    }
+}
+
+static bool dl_check_preempt(run_queue* rq, thread* current) {
+    if (current->sched.dl_throttled)
+        return true;
+
+    thread* first = dl_peek(rq);
+    return first && first->sched.deadline < current->sched.deadline;
+}
+
+static bool dl_wakeup_preempt(thread* current, thread* woken) {
+    return woken->sched.deadline < current->sched.deadline;
+}
+
+// Budget of current thread runs out or throttled thread gets replenished
+static u64 dl_next_event(run_queue* rq, thread* current, u64 now) {
+    u64 next = TIME_NEVER;
+    if (current && current->sched.class == &dl_sched_class) {
+        i64 budget = current->sched.dl_budget;
+        next = budget > 0 ? now + budget : now;
+    }
+
+    rb_tree_node* throttled = rb_tree_first(&rq->dl.throttled);
+    if (throttled) {
+        u64 replenish_at = ((thread*) throttled->value)->sched.deadline;
+        next = MIN(next, replenish_at);
+    }
+
+    return next;
+}
+
+// Deadlines are absolute, so nothing to rebase
+static void dl_migrate(run_queue* from, run_queue* to, thread* thrd) {
+    UNUSED(from);
+    UNUSED(to);
+    UNUSED(thrd);
+}
+
+const sched_class dl_sched_class = {.enqueue = dl_enqueue,
+                                    .dequeue = dl_dequeue,
+                                    .peek = dl_peek,
+                                    .update_current = dl_update_current,
+                                    .refresh = dl_refresh,
+                                    .check_preempt = dl_check_preempt,
+                                    .wakeup_preempt = dl_wakeup_preempt,
+                                    .next_event = dl_next_event,
+                                    .migrate = dl_migrate};
\ No newline at end of file
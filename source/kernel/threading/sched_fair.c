@@ -0,0 +1,165 @@
+#include "../lib/math.h"
+#include "../lib/util.h"
+#include "sched.h"
+
+#define NICE_0_WEIGHT 1024
+
+/*
+ * Fair class orders runnable threads by virtual runtime - time spent on cpu
+ * scaled inversely to thread weight, and the one with smallest virtual
+ * runtime runs next. Virtual runtime of thread is only meaningful relatively
+ * to min_vruntime of its run queue, so it is rebased on migration.
+ */
+
+// Each nice level changes cpu share by roughly 10%
+static const u32 nice_to_weight[NICE_MAX - NICE_MIN + 1] = {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */ 9548,  7620,  6100,  4904,  3906,
+    /*  -5 */ 3121,  2501,  1991,  1586,  1277,
+    /*   0 */ 1024,  820,   655,   526,   423,
+    /*   5 */ 335,   272,   215,   172,   137,
+    /*  10 */ 110,   87,    70,    56,    45,
+    /*  15 */ 36,    29,    23,    18,    15,
+};
+
+// Every runnable thread should get on cpu once within this period, unless
+// there are too many of them to respect min granularity
+static u64 sched_latency_ns = 12000000;
+static u64 sched_min_granularity_ns = 3000000;
+// Woken up thread preempts current one only if it is ahead by this much
+static u64 sched_wakeup_granularity_ns = 2000000;
+
+void scheduler_set_timeslice_us(u64 us) {
+    sched_min_granularity_ns = us * 1000;
+}
+
+u64 scheduler_get_timeslice_us() { return sched_min_granularity_ns / 1000; }
+
+// Sleepers get credit of half of latency, so that interactive threads run soon
+// after waking up, but can't accumulate unbounded credit
+static u64 sleeper_credit() { return sched_latency_ns / 2; }
+
+void fair_set_weight(thread* thrd) {
+    thrd->sched.weight = nice_to_weight[thrd->sched.nice - NICE_MIN];
+}
+
+bool fair_vruntime_less(const rb_tree_node* a, const rb_tree_node* b) {
+    return ((thread*) a->value)->sched.vruntime
+           < ((thread*) b->value)->sched.vruntime;
+}
+
+static thread* fair_peek(run_queue* rq) {
+    rb_tree_node* node = rb_tree_first(&rq->fair.threads);
+    return node ? (thread*) node->value : NULL;
+}
+
+static void update_min_vruntime(run_queue* rq, thread* current) {
+    thread* first = fair_peek(rq);
+    u64 vruntime = rq->fair.min_vruntime;
+
+    if (current && first)
+        vruntime = MIN(current->sched.vruntime, first->sched.vruntime);
+    else if (current)
+        vruntime = current->sched.vruntime;
+    else if (first)
+        vruntime = first->sched.vruntime;
+
+    rq->fair.min_vruntime = MAX(rq->fair.min_vruntime, vruntime);
+}
+
+// Puts thread that is about to be queued relatively to other threads of run
+// queue
+static void place_thread(run_queue* rq, thread* thrd, enqueue_reason reason) {
+    if (reason == ENQUEUE_NEW) {
+        // new threads start from the current minimum, so that spawning
+        // threads doesn't allow to get more than fair share
+        thrd->sched.vruntime = rq->fair.min_vruntime;
+    } else if (reason == ENQUEUE_WAKEUP) {
+        u64 credit = sleeper_credit();
+        u64 min = rq->fair.min_vruntime;
+        u64 floor = min > credit ? min - credit : 0;
+        thrd->sched.vruntime = MAX(thrd->sched.vruntime, floor);
+    }
+}
+
+static void fair_enqueue(run_queue* rq, thread* thrd, enqueue_reason reason) {
+    place_thread(rq, thrd, reason);
+    rb_tree_insert(&rq->fair.threads, &thrd->sched.run_node);
+    rq->fair.load += thrd->sched.weight;
+}
+
+static void fair_dequeue(run_queue* rq, thread* thrd) {
+    rb_tree_remove(&rq->fair.threads, &thrd->sched.run_node);
+    rq->fair.load -= thrd->sched.weight;
+}
+
+static void fair_update_current(run_queue* rq, thread* current, u64 delta) {
+    current->sched.vruntime += delta * NICE_0_WEIGHT / current->sched.weight;
+    update_min_vruntime(rq, current->state == RUNNING ? current : NULL);
+}
+
+static void fair_refresh(run_queue* rq, u64 now) {
+    UNUSED(rq);
+    UNUSED(now);
+}
+
+// Share of scheduling period thread gets, proportional to its weight
+static u64 ideal_slice(run_queue* rq, thread* thrd) {
+    u64 running = rq->fair.threads.size + 1;
+    u64 period = MAX(sched_latency_ns, running * sched_min_granularity_ns);
+
+    return period * thrd->sched.weight / (rq->fair.load + thrd->sched.weight);
+}
+
+static bool fair_check_preempt(run_queue* rq, thread* current) {
+    thread* first = fair_peek(rq);
+    if (!first)
+        return false;
+
+    u64 ran = current->sched.sum_exec_runtime - current->sched.slice_start;
+    if (ran < sched_min_granularity_ns)
+        return false;
+
+    if (ran >= ideal_slice(rq, current))
+        return true;
+
+    return first->sched.vruntime + sched_wakeup_granularity_ns
+           < current->sched.vruntime;
+}
+
+static bool fair_wakeup_preempt(thread* current, thread* woken) {
+    return woken->sched.vruntime + sched_wakeup_granularity_ns
+           < current->sched.vruntime;
+}
+
+// Current thread runs until end of its slice, unless it is alone
+static u64 fair_next_event(run_queue* rq, thread* current, u64 now) {
+    if (!current || current->sched.class != &fair_sched_class
+        || !rq->fair.threads.size)
+        return TIME_NEVER;
+
+    u64 ran = current->sched.sum_exec_runtime - current->sched.slice_start;
+    u64 slice = MAX(ideal_slice(rq, current), sched_min_granularity_ns);
+    return ran < slice ? now + (slice - ran) : now;
+}
+
+static void fair_migrate(run_queue* from, run_queue* to, thread* thrd) {
+    // woken thread may be behind min_vruntime by its sleeper credit, so lag is
+    // signed, and it never carries more credit than new run queue would give
+    i64 lag = (i64) (thrd->sched.vruntime - from->fair.min_vruntime);
+    lag = MAX(lag, -(i64) sleeper_credit());
+
+    u64 min = to->fair.min_vruntime;
+    thrd->sched.vruntime = lag < 0 && (u64) -lag > min ? 0 : min + lag;
+}
+
+const sched_class fair_sched_class = {.enqueue = fair_enqueue,
+                                      .dequeue = fair_dequeue,
+                                      .peek = fair_peek,
+                                      .update_current = fair_update_current,
+                                      .refresh = fair_refresh,
+                                      .check_preempt = fair_check_preempt,
+                                      .wakeup_preempt = fair_wakeup_preempt,
+                                      .next_event = fair_next_event,
+                                      .migrate = fair_migrate};
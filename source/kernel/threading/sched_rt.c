@@ -0,0 +1,154 @@
+#include "../lib/math.h"
+#include "../lib/util.h"
+#include "sched.h"
+
+/*
+ * Real-time class, runs thread of highest priority first. SCHED_FIFO threads
+ * run until they block or get preempted by higher priority, SCHED_RR threads
+ * additionally rotate with threads of same priority every timeslice.
+ *
+ * Queue of priority p is queues[RT_PRIORITY_MAX - p], so that lowest set bit
+ * of bitmap corresponds to highest priority.
+ */
+
+#define RR_TIMESLICE_NS 100000000
+
+// Rt threads may use at most this much of every period on each cpu, so that
+// runaway rt thread can't starve normal threads (e.g. thread cleaner)
+#define RT_PERIOD_NS 1000000000
+#define RT_RUNTIME_NS 950000000
+
+static u64 queue_index(thread* thrd) {
+    return RT_PRIORITY_MAX - thrd->sched.rt_priority;
+}
+
+static void rt_enqueue(run_queue* rq, thread* thrd, enqueue_reason reason) {
+    u64 idx = queue_index(thrd);
+    linked_list* queue = &rq->rt.queues[idx];
+
+    bool slice_left = thrd->sched.policy == SCHED_FIFO
+                      || thrd->sched.rt_time_slice > 0;
+
+    // preempted thread that didn't use up its timeslice keeps its position
+    if (reason == ENQUEUE_PREEMPTED && slice_left) {
+        linked_list_add_first_node(queue, &thrd->scheduler_node);
+    } else {
+        thrd->sched.rt_time_slice = RR_TIMESLICE_NS;
+        linked_list_add_last_node(queue, &thrd->scheduler_node);
+    }
+
+    rq->rt.bitmap[idx / 64] |= 1UL << (idx % 64);
+    rq->rt.size++;
+}
+
+static void rt_dequeue(run_queue* rq, thread* thrd) {
+    u64 idx = queue_index(thrd);
+    linked_list* queue = &rq->rt.queues[idx];
+
+    linked_list_remove_node(queue, &thrd->scheduler_node);
+    if (!queue->size)
+        rq->rt.bitmap[idx / 64] &= ~(1UL << (idx % 64));
+
+    rq->rt.size--;
+}
+
+static thread* rt_first(run_queue* rq) {
+    for (u64 i = 0; i < RT_BITMAP_WORDS; i++) {
+        u64 word = rq->rt.bitmap[i];
+        if (!word)
+            continue;
+
+        u64 idx = i * 64 + __builtin_ctzl(word);
+        return (thread*) rq->rt.queues[idx].head->value;
+    }
+
+    return NULL;
+}
+
+static thread* rt_peek(run_queue* rq) {
+    return rq->rt.throttled ? NULL : rt_first(rq);
+}
+
+static void rt_update_current(run_queue* rq, thread* current, u64 delta) {
+    if (current->sched.policy == SCHED_RR) {
+        current->sched.rt_time_slice =
+            current->sched.rt_time_slice > delta
+                ? current->sched.rt_time_slice - delta
+                : 0;
+    }
+
+    rq->rt.time += delta;
+    if (rq->rt.time >= RT_RUNTIME_NS)
+        rq->rt.throttled = true;
+}
+
+static void rt_refresh(run_queue* rq, u64 now) {
+    if (now - rq->rt.period_start < RT_PERIOD_NS)
+        return;
+
+    rq->rt.period_start = now;
+    rq->rt.time = 0;
+    rq->rt.throttled = false;
+}
+
+static bool rt_check_preempt(run_queue* rq, thread* current) {
+    if (rq->rt.throttled)
+        return true;
+
+    thread* first = rt_first(rq);
+    if (!first)
+        return false;
+
+    if (first->sched.rt_priority > current->sched.rt_priority)
+        return true;
+
+    return current->sched.policy == SCHED_RR
+           && !current->sched.rt_time_slice
+           && first->sched.rt_priority == current->sched.rt_priority;
+}
+
+static bool rt_wakeup_preempt(thread* current, thread* woken) {
+    return woken->sched.rt_priority > current->sched.rt_priority;
+}
+
+static u64 rt_next_event(run_queue* rq, thread* current, u64 now) {
+    // throttled threads wait for next period
+    if (rq->rt.throttled)
+        return rq->rt.size ? rq->rt.period_start + RT_PERIOD_NS : TIME_NEVER;
+
+    if (!current || current->sched.class != &rt_sched_class)
+        return TIME_NEVER;
+
+    u64 next = TIME_NEVER;
+
+    // round robin rotation matters only if there is thread to rotate with
+    thread* first = rt_first(rq);
+    if (current->sched.policy == SCHED_RR && first
+        && first->sched.rt_priority == current->sched.rt_priority)
+        next = now + current->sched.rt_time_slice;
+
+    // throttling matters only if threads of other classes wait
+    if (rq->size > rq->rt.size) {
+        u64 runtime_left =
+            rq->rt.time < RT_RUNTIME_NS ? RT_RUNTIME_NS - rq->rt.time : 0;
+        next = MIN(next, now + runtime_left);
+    }
+
+    return next;
+}
+
+static void rt_migrate(run_queue* from, run_queue* to, thread* thrd) {
+    UNUSED(from);
+    UNUSED(to);
+    UNUSED(thrd);
+}
+
+const sched_class rt_sched_class = {.enqueue = rt_enqueue,
+                                    .dequeue = rt_dequeue,
+                                    .peek = rt_peek,
+                                    .update_current = rt_update_current,
+                                    .refresh = rt_refresh,
+                                    .check_preempt = rt_check_preempt,
+                                    .wakeup_preempt = rt_wakeup_preempt,
+                                    .next_event = rt_next_event,
+                                    .migrate = rt_migrate};
@@ -1,13 +1,37 @@
 #include "scheduler.h"
+#include "../arch/common/fpu.h"
 #include "../arch/common/idle.h"
+#include "../arch/common/tls.h"
+#include "../error/errno.h"
+#include "../interrupts/irq.h"
+#include "../lib/math.h"
+#include "../lib/panic.h"
 #include "../memory/virtual/vmm.h"
+#include "../rseq/rseq.h"
+#include "../time/clockevent.h"
+#include "../time/timer.h"
+#include "../time/timer_wheel.h"
 #include "kthread.h"
+#include "sched.h"
 
-static lock schedule_lock = SPIN_LOCK_STATIC_INITIALIZER;
-static queue run_queue = QUEUE_STATIC_INITIALIZER;
+// Cpu that has threads waiting for it balances run queues this often
+#define BALANCE_INTERVAL_NS 4000000
 
-static thread* current_thread = NULL;
-static kthread* kernel_wait_thread; // shouldn't enter run queue
+// In pick order, thread of earlier class always runs before later ones
+static const sched_class* const sched_classes[] = {
+    &dl_sched_class, &rt_sched_class, &fair_sched_class};
+
+#define SCHED_CLASSES_COUNT (sizeof(sched_classes) / sizeof(sched_class*))
+
+#define RUN_QUEUE_STATIC_INITIALIZER                                           \
+    {                                                                          \
+        .lock = SPIN_LOCK_STATIC_INITIALIZER, .size = 0,                       \
+        .dl = DL_RUN_QUEUE_STATIC_INITIALIZER,                                 \
+        .fair = FAIR_RUN_QUEUE_STATIC_INITIALIZER                              \
+    }
+
+static run_queue run_queues[MAX_CPUS] = {[0 ... MAX_CPUS - 1] =
+                                             RUN_QUEUE_STATIC_INITIALIZER};
 
 _Noreturn void kernel_wait_thread_func() {
     while (true) {
@@ -15,24 +39,231 @@ _Noreturn void kernel_wait_thread_func() {
     }
 }
 
-void scheduler_init() {
-    kernel_wait_thread =
+void scheduler_init() { scheduler_init_cpu(); }
+
+void scheduler_init_cpu() {
+    // kernel wait thread shouldn't enter run queue
+    kthread* wait_thread =
         kthread_create("kernel-wait-thread", kernel_wait_thread_func);
+    if (!wait_thread)
+        panic("Can't create kernel wait thread");
+
+    wait_thread->cpu = this_cpu_id();
+    run_queues[this_cpu_id()].cpu = this_cpu_id();
+    this_cpu_write(idle, wait_thread);
+    this_cpu_write(run_queue, &run_queues[this_cpu_id()]);
+}
+
+void scheduler_thread_init(thread* thrd) {
+    thread* current = get_current_thread();
+    bool inherit = !thrd->kernel_thread && current && !current->kernel_thread;
+
+    // scheduling policy is not inherited, so that user can't escape rt
+    // throttling by forking
+    thrd->sched.class = &fair_sched_class;
+    thrd->sched.policy = SCHED_NORMAL;
+    thrd->sched.rt_priority = 0;
+    thrd->sched.rt_time_slice = 0;
+
+    thrd->sched.dl_runtime = 0;
+    thrd->sched.dl_deadline = 0;
+    thrd->sched.dl_period = 0;
+    thrd->sched.dl_bandwidth = 0;
+    thrd->sched.dl_budget = 0;
+    thrd->sched.deadline = 0;
+    thrd->sched.dl_throttled = false;
+
+    thrd->sched.nice = inherit ? current->sched.nice : 0;
+    fair_set_weight(thrd);
+    thrd->sched.vruntime = 0;
+    thrd->sched.exec_start = 0;
+    thrd->sched.sum_exec_runtime = 0;
+    thrd->sched.slice_start = 0;
+    thrd->sched.run_node = (rb_tree_node) RB_TREE_NODE_OF(thrd);
+}
+
+void scheduler_thread_deinit(thread* thrd) {
+    if (thrd->sched.dl_bandwidth)
+        dl_reserve_bandwidth(thrd, 0, 0);
+}
+
+void scheduler_lock() { spin_lock(&this_cpu_read(run_queue)->lock); }
+
+void scheduler_unlock() { spin_unlock(&this_cpu_read(run_queue)->lock); }
+
+thread* get_current_thread() { return this_cpu_read(current); }
+
+static u64 class_rank(const sched_class* class) {
+    for (u64 i = 0; i < SCHED_CLASSES_COUNT; i++) {
+        if (sched_classes[i] == class)
+            return i;
+    }
+
+    panic("Unknown scheduling class");
+}
+
+static void enqueue_thread(run_queue* rq, thread* thrd,
+                           enqueue_reason reason) {
+
+    thrd->sched.class->enqueue(rq, thrd, reason);
+    thrd->on_run_queue = true;
+    rq->size++;
+}
+
+static void dequeue_thread(run_queue* rq, thread* thrd) {
+    thrd->sched.class->dequeue(rq, thrd);
+    thrd->on_run_queue = false;
+    rq->size--;
+}
+
+// Class of thread that would run next on this run queue, if any
+static const sched_class* next_class(run_queue* rq, thread** next) {
+    for (u64 i = 0; i < SCHED_CLASSES_COUNT; i++) {
+        thread* first = sched_classes[i]->peek(rq);
+        if (first) {
+            if (next)
+                *next = first;
+
+            return sched_classes[i];
+        }
+    }
+
+    return NULL;
 }
 
-void scheduler_lock() { spin_lock(&schedule_lock); }
+static thread* pick_next_thread(run_queue* rq) {
+    thread* next = NULL;
+    if (next_class(rq, &next))
+        dequeue_thread(rq, next);
+
+    return next;
+}
+
+// Charges current thread of provided cpu for time it spent running
+static void update_current(percpu* cpu, u64 now) {
+    thread* current = cpu->current;
+    if (!current || current == cpu->idle)
+        return;
+
+    u64 delta = now - current->sched.exec_start;
+    current->sched.exec_start = now;
+    current->sched.sum_exec_runtime += delta;
+    current->sched.class->update_current(cpu->run_queue, current, delta);
+}
+
+static bool should_preempt(run_queue* rq, thread* current) {
+    const sched_class* next = next_class(rq, NULL);
+    if (next && class_rank(next) < class_rank(current->sched.class))
+        return true;
+
+    // class may also stop its thread when nothing else is runnable, e.g. if
+    // thread exhausted its budget
+    return current->sched.class->check_preempt(rq, current);
+}
+
+// Number of threads that want cpu, read without locking so is approximate
+static u64 cpu_load(u64 cpu) {
+    percpu* data = percpu_of(cpu);
+    thread* current = data->current;
+    bool busy = current && current != data->idle;
+
+    return run_queues[cpu].size + (busy ? 1 : 0);
+}
+
+static u64 least_loaded_cpu() {
+    u64 result = this_cpu_id();
+    u64 result_load = cpu_load(result);
+
+    for (u64 cpu = 0; cpu < arch_cpus_count(); cpu++) {
+        u64 load = cpu_load(cpu);
+        if (load < result_load) {
+            result = cpu;
+            result_load = load;
+        }
+    }
+
+    return result;
+}
+
+static u64 busiest_cpu() {
+    u64 result = 0;
+    for (u64 cpu = 1; cpu < arch_cpus_count(); cpu++) {
+        if (run_queues[cpu].size > run_queues[result].size)
+            result = cpu;
+    }
+
+    return result;
+}
+
+// Makes provided cpu reconsider what it runs. Current cpu does that from
+// timer interrupt, as soon as interrupts are enabled.
+static void resched_cpu(u64 cpu) {
+    if (cpu == this_cpu_id())
+        clockevent_program(timer_now_ns());
+    else
+        arch_send_reschedule(cpu);
+}
+
+// Locks run queue thread belongs to, handles concurrent thread migration.
+// Should be called with interrupts disabled.
+static run_queue* lock_thread_run_queue(thread* thrd) {
+    while (true) {
+        run_queue* rq = &run_queues[thrd->cpu];
+        spin_lock(&rq->lock);
+        if (rq == &run_queues[thrd->cpu])
+            return rq;
+
+        spin_unlock(&rq->lock);
+    }
+}
+
+// Moves thread that would run next to run queue of another cpu, both run
+// queues should be locked
+static thread* migrate_thread(run_queue* from, u64 to_cpu, bool enqueue) {
+    thread* thrd = pick_next_thread(from);
+    if (!thrd)
+        return NULL;
+
+    run_queue* to = &run_queues[to_cpu];
+    thrd->sched.class->migrate(from, to, thrd);
+    thrd->cpu = to_cpu;
+
+    if (enqueue)
+        enqueue_thread(to, thrd, ENQUEUE_RESTORE);
+
+    return thrd;
+}
 
-void scheduler_unlock() { spin_unlock(&schedule_lock); }
+// Makes cpu reconsider what it runs if just queued thread should run before
+// its current thread. Cpu whose run queue was empty is poked as well, since
+// its timer may be stopped, leaving no chance to preempt current thread later.
+static void check_preempt_queued(run_queue* rq, thread* queued) {
+    percpu* data = percpu_of(rq->cpu);
+    thread* current = data->current;
+    if (!current || current == data->idle || rq->size == 1) {
+        resched_cpu(rq->cpu);
+        return;
+    }
 
-thread* get_current_thread() {
-    bool interrupts_enabled = spin_lock_irq_save(&schedule_lock);
-    thread* current = current_thread;
-    spin_unlock_irq_restore(&schedule_lock, interrupts_enabled);
-    return current;
+    u64 queued_rank = class_rank(queued->sched.class);
+    u64 current_rank = class_rank(current->sched.class);
+    if (queued_rank < current_rank
+        || (queued_rank == current_rank
+            && queued->sched.class->wakeup_preempt(current, queued)))
+        resched_cpu(rq->cpu);
 }
 
 void schedule_thread(thread* thrd) {
-    bool interrupts_enabled = spin_lock_irq_save(&schedule_lock);
+    bool interrupts_enabled = local_irq_save();
+
+    // threads that never ran have no cache footprint, so start them on least
+    // loaded cpu, others are woken up on cpu they last ran on
+    if (thrd->state == INITIALISED)
+        thrd->cpu = least_loaded_cpu();
+
+    run_queue* rq = lock_thread_run_queue(thrd);
+    enqueue_reason reason =
+        thrd->state == INITIALISED ? ENQUEUE_NEW : ENQUEUE_WAKEUP;
 
     // This is needed to solve race with any sleep waits on conditions - lost
     // updates. If we don't set state to RUNNING here, this may happen:
@@ -58,14 +289,14 @@ void schedule_thread(thread* thrd) {
     // It's fine to modify thread state outside of cpu where thread is
     // running in this case, since this function can be called in one of three
     // orders (with respect to schedule()) because both are synchronized on
-    // scheduler lock:
+    // lock of run queue of cpu the thread belongs to:
     //
     // 1) before schedule() and before thread checked necessary conditions and
     // set its state - good, there is nothing to do, thread will check
     // necessary condition which is already met and won’t sleep.
     //
     // 2) After thread set its state and before schedule - since both are
-    // synchronized on scheduler lock, our state override will be visible to
+    // synchronized on run queue lock, our state override will be visible to
     // schedule() through this lock
     //
     // 3) after schedule() - then if thread has been blocked, its already not
@@ -73,48 +304,258 @@ void schedule_thread(thread* thrd) {
     thrd->state = RUNNING;
 
     if (!thrd->currently_running && !thrd->on_run_queue) {
-        queue_push(&run_queue, &thrd->scheduler_node);
-        thrd->on_run_queue = true;
+        enqueue_thread(rq, thrd, reason);
+        check_preempt_queued(rq, thrd);
+    }
+
+    spin_unlock(&rq->lock);
+    local_irq_restore(interrupts_enabled);
+}
+
+// Changes scheduling parameters of thread, `change` is applied while thread
+// is off run queue
+static void change_thread_params(thread* thrd,
+                                 void (*change)(thread* thrd, u64 arg),
+                                 u64 arg) {
+
+    bool interrupts_enabled = local_irq_save();
+    run_queue* rq = lock_thread_run_queue(thrd);
+
+    bool queued = thrd->on_run_queue;
+    if (queued)
+        dequeue_thread(rq, thrd);
+
+    change(thrd, arg);
+
+    if (queued)
+        enqueue_thread(rq, thrd, ENQUEUE_RESTORE);
+
+    // running thread may need to give up cpu now, queued one may need to
+    // preempt current thread of its cpu
+    if (thrd->currently_running)
+        resched_cpu(thrd->cpu);
+    else if (queued)
+        check_preempt_queued(rq, thrd);
+
+    spin_unlock(&rq->lock);
+    local_irq_restore(interrupts_enabled);
+}
+
+static void change_nice(thread* thrd, u64 nice) {
+    thrd->sched.nice = (i32) nice;
+    fair_set_weight(thrd);
+}
+
+void scheduler_set_nice(thread* thrd, i32 nice) {
+    nice = MAX(NICE_MIN, MIN(NICE_MAX, nice));
+    change_thread_params(thrd, change_nice, (u64) nice);
+}
+
+i32 scheduler_get_nice(thread* thrd) { return thrd->sched.nice; }
+
+static const sched_class* policy_class(u8 policy) {
+    switch (policy) {
+    case SCHED_DEADLINE:
+        return &dl_sched_class;
+    case SCHED_FIFO:
+    case SCHED_RR:
+        return &rt_sched_class;
+    default:
+        return &fair_sched_class;
+    }
+}
+
+static void change_policy(thread* thrd, u64 arg) {
+    const sched_attr* attr = (const sched_attr*) arg;
+
+    thrd->sched.policy = attr->policy;
+    thrd->sched.class = policy_class(attr->policy);
+    thrd->sched.rt_priority = attr->priority;
+
+    thrd->sched.dl_runtime = attr->runtime;
+    thrd->sched.dl_deadline = attr->deadline;
+    thrd->sched.dl_period = attr->period;
+    thrd->sched.dl_throttled = false;
+    if (attr->policy == SCHED_DEADLINE) {
+        thrd->sched.dl_budget = attr->runtime;
+        thrd->sched.deadline = timer_now_ns() + attr->deadline;
+    }
+}
+
+static bool valid_attr(const sched_attr* attr) {
+    switch (attr->policy) {
+    case SCHED_NORMAL:
+        return !attr->priority && !attr->runtime;
+    case SCHED_FIFO:
+    case SCHED_RR:
+        return attr->priority >= RT_PRIORITY_MIN
+               && attr->priority <= RT_PRIORITY_MAX && !attr->runtime;
+    case SCHED_DEADLINE:
+        return !attr->priority && attr->runtime
+               && attr->runtime <= attr->deadline
+               && attr->deadline <= attr->period
+               && attr->period <= DL_PERIOD_MAX_NS;
+    default:
+        return false;
     }
+}
+
+u64 scheduler_set_policy(thread* thrd, const sched_attr* attr) {
+    if (!valid_attr(attr))
+        return -EINVAL;
+
+    u64 runtime = attr->policy == SCHED_DEADLINE ? attr->runtime : 0;
+    if (!dl_reserve_bandwidth(thrd, runtime, attr->period))
+        return -EBUSY;
 
-    spin_unlock_irq_restore(&schedule_lock, interrupts_enabled);
+    change_thread_params(thrd, change_policy, (u64) attr);
+    return 0;
+}
+
+void scheduler_get_attr(thread* thrd, sched_attr* attr) {
+    attr->policy = thrd->sched.policy;
+    attr->priority = thrd->sched.rt_priority;
+    attr->runtime = thrd->sched.dl_runtime;
+    attr->deadline = thrd->sched.dl_deadline;
+    attr->period = thrd->sched.dl_period;
+}
+
+u8 scheduler_get_policy(thread* thrd) { return thrd->sched.policy; }
+
+// Takes thread from busiest run queue, should be called with current cpu run
+// queue locked
+static thread* steal_thread(percpu* cpu) {
+    u64 busiest = busiest_cpu();
+    run_queue* victim = &run_queues[busiest];
+    if (busiest == cpu->id || !victim->size)
+        return NULL;
+
+    if (!try_lock(&victim->lock))
+        return NULL;
+
+    thread* stolen = migrate_thread(victim, cpu->id, false);
+    spin_unlock(&victim->lock);
+    return stolen;
+}
+
+static void balance_run_queues() {
+    u64 busiest = busiest_cpu();
+    u64 idlest = least_loaded_cpu();
+    if (busiest == idlest || cpu_load(busiest) < cpu_load(idlest) + 2)
+        return;
+
+    run_queue* first = &run_queues[busiest < idlest ? busiest : idlest];
+    run_queue* second = &run_queues[busiest < idlest ? idlest : busiest];
+    spin_lock(&first->lock);
+    spin_lock(&second->lock);
+
+    thread* migrated = migrate_thread(&run_queues[busiest], idlest, true);
+    if (migrated)
+        check_preempt_queued(&run_queues[idlest], migrated);
+
+    spin_unlock(&second->lock);
+    spin_unlock(&first->lock);
+}
+
+void scheduler_tick() {
+    run_queue* rq = this_cpu_read(run_queue);
+    u64 now = timer_now_ns();
+    if (now < rq->next_balance)
+        return;
+
+    rq->next_balance = now + BALANCE_INTERVAL_NS;
+    balance_run_queues();
+}
+
+// Programs timer of current cpu for the earliest time scheduler or kernel
+// timers have to act at, idle cpu with nothing to wait for stops its timer
+static void program_next_event(run_queue* rq, thread* current, u64 now) {
+    u64 next = rq->size ? MAX(rq->next_balance, now) : TIME_NEVER;
+    next = MIN(next, timer_wheel_next_event());
+    for (u64 i = 0; i < SCHED_CLASSES_COUNT; i++) {
+        next = MIN(next, sched_classes[i]->next_event(rq, current, now));
+    }
+
+    clockevent_program(next);
 }
 
 // This should be called with scheduler lock held
+// Kernel threads don't use thread pointer, so the one of last user thread is
+// left in cpu while they run
+static void switch_tls(thread* prev, thread* next) {
+    bool user_writable = arch_tls_user_writable();
+    if (prev && !prev->kernel_thread && user_writable) {
+        prev->tls = arch_tls_read();
+        prev->tls_aux = arch_tls_aux_read();
+    }
+
+    if (next->kernel_thread)
+        return;
+
+    arch_tls_write(next->tls);
+    // otherwise user space can't change it and it stays zero
+    if (user_writable)
+        arch_tls_aux_write(next->tls_aux);
+}
+
 struct cpu_context* context_switch(struct cpu_context* context) {
-    thread* old_thread = current_thread;
+    percpu* cpu = this_cpu();
+    run_queue* rq = cpu->run_queue;
+    kthread* kernel_wait_thread = cpu->idle;
+    thread* old_thread = cpu->current;
     if (old_thread) {
         old_thread->context = context;
         old_thread->currently_running = false;
     }
 
-    queue_node* new_node = queue_pop(&run_queue);
-    thread* new_thread = new_node ? (thread*) new_node->value : NULL;
+    u64 now = timer_now_ns();
+    update_current(cpu, now);
+    for (u64 i = 0; i < SCHED_CLASSES_COUNT; i++) {
+        sched_classes[i]->refresh(rq, now);
+    }
+
+    bool old_runnable = old_thread && old_thread->state == RUNNING
+                        && old_thread != kernel_wait_thread;
 
-    // we are in one and only alive running thread, just resume it
-    if (!new_thread && old_thread && old_thread->state == RUNNING) {
+    // thread keeps cpu until its class decides otherwise
+    if (old_runnable && !should_preempt(rq, old_thread)) {
         old_thread->currently_running = true;
+        program_next_event(rq, old_thread, now);
         return context;
     }
 
     if (old_thread && old_thread->state == RUNNING) {
         old_thread->state = STOPPED;
 
-        // if we came from kernel wait thread then not add it to run queue
-        if (old_thread != kernel_wait_thread) {
-            queue_push(&run_queue, &old_thread->scheduler_node);
-            old_thread->on_run_queue = true;
-        }
+        // if we came from kernel wait thread then not add it to run queue,
+        // preempted thread competes with others and may be picked again
+        if (old_thread != kernel_wait_thread)
+            enqueue_thread(rq, old_thread, ENQUEUE_PREEMPTED);
     }
 
-    // old thread can't continue running and no next thread, so just wake up
-    // kernel wait thread
-    current_thread = new_thread ? new_thread : kernel_wait_thread;
-    current_thread->state = RUNNING;
-    current_thread->on_run_queue = false;
-    current_thread->currently_running = true;
+    // cpu that is about to go idle tries to take work from others
+    thread* new_thread = pick_next_thread(rq);
+    if (!new_thread)
+        new_thread = steal_thread(cpu);
 
-    vmm_set_vm_space(current_thread->proc->vm);
+    // no thread can run now, so just wake up kernel wait thread
+    thread* current = new_thread ? new_thread : kernel_wait_thread;
+    current->state = RUNNING;
+    current->currently_running = true;
+    current->sched.exec_start = now;
+    current->sched.slice_start = current->sched.sum_exec_runtime;
+    cpu->current = current;
+    if (current != old_thread) {
+        cpu->stats.context_switches++;
+        if (old_thread)
+            rseq_preempt(old_thread);
+        switch_tls(old_thread, current);
+        arch_fpu_switch(old_thread, current);
+    }
 
-    return current_thread->context;
-}
+    program_next_event(rq, new_thread, now);
+
+    vmm_set_vm_space(current->proc->vm);
+
+    return current->context;
+}
\ No newline at end of file
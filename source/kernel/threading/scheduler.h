@@ -6,6 +6,56 @@
 
 void scheduler_init();
 
+// Creates idle thread of current cpu, should be called once on every cpu
+void scheduler_init_cpu();
+
+#define NICE_MIN -20
+#define NICE_MAX 19
+
+#define SCHED_NORMAL 0
+#define SCHED_FIFO 1
+#define SCHED_RR 2
+#define SCHED_DEADLINE 6
+
+#define RT_PRIORITY_MIN 1
+#define RT_PRIORITY_MAX 99
+
+// Sets up scheduling data of new thread, user threads inherit nice value of
+// current user thread
+void scheduler_thread_init(thread* thrd);
+// Releases resources reserved by thread, e.g. deadline bandwidth
+void scheduler_thread_deinit(thread* thrd);
+
+// Provided value is clamped to [NICE_MIN, NICE_MAX]
+void scheduler_set_nice(thread* thrd, i32 nice);
+i32 scheduler_get_nice(thread* thrd);
+
+typedef struct sched_attr {
+    u8 policy;
+    u8 priority; // SCHED_FIFO and SCHED_RR only
+
+    // SCHED_DEADLINE only, in nanoseconds, thread gets runtime of cpu time
+    // before deadline within every period
+    u64 runtime;
+    u64 deadline;
+    u64 period;
+} sched_attr;
+
+// Real-time policies require priority in [RT_PRIORITY_MIN, RT_PRIORITY_MAX],
+// other policies require zero priority. Deadline policy requires
+// 0 < runtime <= deadline <= period and passes admission control.
+// Returns -EINVAL on invalid arguments and -EBUSY if there is not enough cpu
+// bandwidth left for deadline thread.
+u64 scheduler_set_policy(thread* thrd, const sched_attr* attr);
+void scheduler_get_attr(thread* thrd, sched_attr* attr);
+u8 scheduler_get_policy(thread* thrd);
+
+// Fair threads run for at least this long before being preempted by other
+// fair threads, unless they block
+void scheduler_set_timeslice_us(u64 us);
+u64 scheduler_get_timeslice_us();
+
+// Lock free, reads current thread from per cpu area
 thread* get_current_thread();
 
 void schedule_thread(thread* thrd);
@@ -18,6 +68,10 @@ _Noreturn void schedule_thread_exit();
 // Does atomic context switch
 void schedule();
 
+// Should be called from every timer interrupt, periodically balances run
+// queues
+void scheduler_tick();
+
 struct cpu_context* context_switch(struct cpu_context* context);
 
 void scheduler_lock();
@@ -1,4 +1,7 @@
 #include "thread.h"
+#include "../arch/common/fpu.h"
+#include "../io_ring/io_ring.h"
+#include "../synchronization/wait.h"
 #include "scheduler.h"
 
 static id_generator tid_gen;
@@ -87,8 +90,29 @@ bool thread_join(thread* child, u64* exit_code) {
     return true;
 }
 
+u64 thread_try_join(thread* child, u64* exit_code) {
+    u64 result = 0;
+
+    bool interrupts_enabled = spin_lock_irq_save(&child->lock);
+    if (child->parent != get_current_thread())
+        result = -EINVAL;
+    else if (!child->finished)
+        result = -EAGAIN;
+    else
+        *exit_code = child->exit_code;
+    spin_unlock_irq_restore(&child->lock, interrupts_enabled);
+
+    // Same as in thread_join, only parent thread can remove child
+    if (!result)
+        thread_remove_child(child);
+
+    return result;
+}
+
 _Noreturn void thread_exit(u64 exit_code) {
     thread* current = get_current_thread();
+    io_ring_thread_exit(current);
+
     bool interrupts_enabled = spin_lock_irq_save(&current->lock);
     current->exiting = true;
     current->exit_code = exit_code;
@@ -105,6 +129,7 @@ _Noreturn void thread_exit(u64 exit_code) {
 
     current->finished = true;
     con_var_broadcast(&current->finish_cvar);
+    io_ring_notify(current->proc);
 
     ref_count* refc = &current->refc;
     CON_VAR_WAIT_FOR_IRQ(&refc->empty_cvar, &current->lock, interrupts_enabled,
@@ -115,9 +140,12 @@ _Noreturn void thread_exit(u64 exit_code) {
 }
 
 void thread_destroy(thread* thrd) {
+    scheduler_thread_deinit(thrd);
     threading_free_tid(thrd->id);
     array_list_deinit(&thrd->children);
     kfree(thrd->kernel_stack);
+    if (thrd->fpu_state)
+        arch_fpu_state_free(thrd->fpu_state);
     // TODO: add arch cpu_context deinit function, because different
     //       architectures might want to store context not on kernel stack, and
     //       this memory won't be automatically freed with stack
@@ -126,6 +154,18 @@ void thread_destroy(thread* thrd) {
 
 void thread_yield() { schedule(); }
 
+bool thread_sleep_until(u64 deadline_ns) {
+    // nothing wakes sleeping thread up except for timer and signals
+    DECLARE_SPIN_LOCK(sleep_lock);
+
+    bool interrupts_enabled = spin_lock_irq_save(&sleep_lock);
+    u64 result = WAIT_FOR_IRQ_INTERRUPTABLE_TIMED(
+        &sleep_lock, interrupts_enabled, false, deadline_ns);
+    spin_unlock_irq_restore(&sleep_lock, interrupts_enabled);
+
+    return result != (u64) -EINTR;
+}
+
 bool thread_any_pending_signals() {
     thread* current = get_current_thread();
     bool interrupts_enabled = spin_lock_irq_save(&current->siginfo_lock);
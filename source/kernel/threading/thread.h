@@ -3,6 +3,7 @@
 
 #include "../lib/container/array_list/array_list.h"
 #include "../lib/container/linked_list/linked_list.h"
+#include "../lib/container/rb_tree/rb_tree.h"
 #include "../lib/ref_count/ref_count.h"
 #include "../lib/types.h"
 #include "../signal/signal.h"
@@ -27,6 +28,33 @@ typedef struct {
     sigmask signals_mask;
 } thread_siginfo;
 
+struct sched_class;
+
+typedef struct {
+    const struct sched_class* class;
+    u8 policy;
+    u8 rt_priority;
+    u64 rt_time_slice; // time left until round robin rotation
+
+    u64 dl_runtime;    // budget granted every period
+    u64 dl_deadline;   // relative to start of period
+    u64 dl_period;     // how often budget is replenished
+    u64 dl_bandwidth;  // reserved share of cpu, fixed point
+    i64 dl_budget;     // runtime left until current deadline
+    u64 deadline;      // absolute
+    bool dl_throttled; // budget is exhausted, waits for replenishment
+
+    i32 nice;
+    u32 weight;
+
+    u64 vruntime;         // runtime scaled by weight, defines run order
+    u64 exec_start;       // time runtime was last accounted at
+    u64 sum_exec_runtime; // total time spent on cpu
+    u64 slice_start;      // sum_exec_runtime when thread was put on cpu
+
+    rb_tree_node run_node; // node in run queue of fair or deadline class
+} thread_schedinfo;
+
 /*
  * Thread locking order:
  * 1) thread lock
@@ -54,8 +82,22 @@ typedef struct _thread {
     struct cpu_context* context;
     bool currently_running;
     bool on_run_queue;
+    u64 cpu; // cpu thread last ran on, its run queue lock guards these fields
+    thread_schedinfo sched;
     linked_list_node scheduler_node;
 
+    // restartable sequences, see rseq.h, used only by thread itself and by
+    // scheduler when thread leaves cpu
+    u64 rseq; // user address of registered area or 0
+    u32 rseq_signature;
+    bool rseq_resume; // cpu id and critical section should be checked
+
+    u64 tls;     // user thread pointer, valid while thread is off cpu
+    u64 tls_aux; // second user base register, see arch/common/tls.h
+
+    void* fpu_state; // arch specific, see arch/common/fpu.h
+    bool fpu_loaded; // fpu registers hold newer state than fpu_state
+
     lock lock; // guards fields below and also guards thread against
                // de-allocation
 
@@ -85,12 +127,19 @@ void thread_remove_child(thread* child);
 
 bool thread_detach(thread* thread);
 bool thread_join(thread* thread, u64* exit_code);
+// Same as thread_join, but returns -EAGAIN instead of waiting for child, 0 if
+// joined and -EINVAL if thread isn't child of current one
+u64 thread_try_join(thread* thread, u64* exit_code);
 
 _Noreturn void thread_exit(u64 exit_code);
 void thread_destroy(thread* thread);
 
 void thread_yield();
 
+// Blocks current thread until monotonic time reaches deadline, returns false
+// if woken up earlier by a signal
+bool thread_sleep_until(u64 deadline_ns);
+
 bool thread_signal(thread* thread, signal sig);
 bool thread_any_pending_signals();
 
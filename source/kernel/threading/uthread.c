@@ -1,4 +1,5 @@
 #include "uthread.h"
+#include "../arch/common/fpu.h"
 #include "../arch/common/thread.h"
 #include "process.h"
 #include "scheduler.h"
@@ -8,7 +9,7 @@
 #define UTHREAD_MAX_STACKS 4096
 
 const vm_area_flags USER_STACK_FLAGS = {
-    .writable = true, .executable = true, .user_access_allowed = true};
+    .writable = true, .executable = false, .user_access_allowed = true};
 
 static void* uthread_map_user_stack(process* proc, u64 tgid);
 
@@ -27,6 +28,10 @@ static bool uthread_init(process* proc, uthread* parent, uthread* thrd,
         goto failed_to_allocate_kernel_stack;
     memset(thrd->kernel_stack, 0, THREAD_KERNEL_STACK_SIZE);
 
+    thrd->fpu_state = arch_fpu_state_alloc();
+    if (!thrd->fpu_state)
+        goto failed_to_allocate_fpu_state;
+
     thrd->user_stack =
         user_stack ? user_stack : uthread_map_user_stack(proc, thrd->tgid);
     if (!thrd->user_stack)
@@ -60,6 +65,7 @@ static bool uthread_init(process* proc, uthread* parent, uthread* thrd,
     thrd->finish_cvar = (con_var) CON_VAR_STATIC_INITIALIZER;
     thrd->lock = SPIN_LOCK_STATIC_INITIALIZER;
     thrd->scheduler_node = (linked_list_node) LINKED_LIST_NODE_OF(thrd);
+    scheduler_thread_init(thrd);
 
     if (parent && !thread_add_child(thrd))
         goto failed_to_add_thread_to_parent;
@@ -87,6 +93,9 @@ failed_to_init_child_list:
     rw_spin_unlock_write(&proc->vm->lock);
 
 failed_to_map_user_stack:
+    arch_fpu_state_free(thrd->fpu_state);
+
+failed_to_allocate_fpu_state:
     kfree(thrd->kernel_stack);
 
 failed_to_allocate_kernel_stack:
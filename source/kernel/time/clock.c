@@ -0,0 +1,57 @@
+#include "clock.h"
+#include "../arch/common/timer.h"
+#include "../vdso/vdso.h"
+#include "clocksource.h"
+
+#define NS_PER_SECOND 1000000000UL
+
+// Realtime is monotonic time shifted by wall clock time of boot
+static u64 realtime_offset_ns = 0;
+
+void clock_init() {
+    realtime_offset_ns =
+        arch_wall_clock_seconds() * NS_PER_SECOND - clocksource_read_ns();
+    vdso_update_clock();
+}
+
+u64 clock_realtime_offset_ns() { return realtime_offset_ns; }
+
+timespec timespec_from_ns(u64 ns) {
+    return (timespec){.tv_sec = ns / NS_PER_SECOND,
+                      .tv_nsec = ns % NS_PER_SECOND};
+}
+
+bool timespec_to_ns(const timespec* time, u64* ns) {
+    if (time->tv_sec < 0 || time->tv_nsec < 0
+        || time->tv_nsec >= (i64) NS_PER_SECOND)
+        return false;
+
+    u64 max_seconds = ((u64) -1 - time->tv_nsec) / NS_PER_SECOND;
+    if ((u64) time->tv_sec > max_seconds)
+        *ns = (u64) -1;
+    else
+        *ns = time->tv_sec * NS_PER_SECOND + time->tv_nsec;
+
+    return true;
+}
+
+bool clock_gettime(u64 clock_id, timespec* time) {
+    switch (clock_id) {
+    case CLOCK_REALTIME:
+        *time = timespec_from_ns(realtime_offset_ns + clocksource_read_ns());
+        return true;
+    case CLOCK_MONOTONIC:
+        *time = timespec_from_ns(clocksource_read_ns());
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool clock_getres(u64 clock_id, timespec* resolution) {
+    if (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC)
+        return false;
+
+    *resolution = timespec_from_ns(clocksource_resolution_ns());
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef SOS_CLOCK_H
+#define SOS_CLOCK_H
+
+#include "../lib/types.h"
+
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+
+typedef struct {
+    i64 tv_sec;
+    i64 tv_nsec;
+} timespec;
+
+// Reads wall clock time, should be called after clocksource is registered
+void clock_init();
+
+// Realtime is monotonic time plus this offset
+u64 clock_realtime_offset_ns();
+
+// Return false for unknown clock
+bool clock_gettime(u64 clock_id, timespec* time);
+bool clock_getres(u64 clock_id, timespec* resolution);
+
+timespec timespec_from_ns(u64 ns);
+// Returns false for negative time or nanoseconds that don't fit in a second,
+// too big time saturates
+bool timespec_to_ns(const timespec* time, u64* ns);
+
+#endif // SOS_CLOCK_H
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "clockevent.h"
+#include "../lib/math.h"
+#include "../threading/percpu.h"
+#include "timer.h"
+
+static const clockevent_device* current_device = NULL;
+
+// Time each cpu has its timer interrupt programmed at
+static u64 next_events[MAX_CPUS] = {[0 ... MAX_CPUS - 1] = TIME_NEVER};
+
+void clockevent_register(const clockevent_device* device) {
+    current_device = device;
+}
+
+bool clockevent_oneshot() { return current_device != NULL; }
+
+void clockevent_program(u64 deadline_ns) {
+    if (!current_device)
+        return;
+
+    next_events[this_cpu_id()] = deadline_ns;
+    if (deadline_ns == TIME_NEVER) {
+        current_device->stop();
+        return;
+    }
+
+    u64 now = timer_now_ns();
+    u64 delta = deadline_ns > now ? deadline_ns - now : 0;
+
+    // too distant event is reached in several steps
+    delta = MAX(delta, current_device->min_delta_ns);
+    delta = MIN(delta, current_device->max_delta_ns);
+    current_device->set_next_event(delta);
+}
+
+void clockevent_program_before(u64 deadline_ns) {
+    if (deadline_ns < next_events[this_cpu_id()])
+        clockevent_program(deadline_ns);
+}
\ No newline at end of file
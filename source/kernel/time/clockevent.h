@@ -0,0 +1,38 @@
+#ifndef SOS_CLOCKEVENT_H
+#define SOS_CLOCKEVENT_H
+
+#include "../lib/types.h"
+
+// Time that never comes, used to say there is no next event
+#define TIME_NEVER ((u64) -1)
+
+// Per cpu timer interrupt source that is programmed for one event at a time.
+// Every cpu has its own instance of the device, operations act on current cpu.
+typedef struct {
+    const char* name;
+
+    // Delta range device can be programmed with
+    u64 min_delta_ns;
+    u64 max_delta_ns;
+
+    void (*set_next_event)(u64 delta_ns);
+    void (*stop)();
+} clockevent_device;
+
+// Should be called on boot cpu before other cpus are started. Until device is
+// registered, periodic tick of boot cpu is used.
+void clockevent_register(const clockevent_device* device);
+
+// False if only periodic tick is available
+bool clockevent_oneshot();
+
+// Programs timer interrupt of current cpu at provided monotonic time, past
+// time makes interrupt fire as soon as possible, TIME_NEVER stops the timer.
+// Should be called with interrupts disabled.
+void clockevent_program(u64 deadline_ns);
+
+// Same as above, but only moves timer interrupt of current cpu earlier, never
+// later
+void clockevent_program_before(u64 deadline_ns);
+
+#endif // SOS_CLOCKEVENT_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "clocksource.h"
+#include "../interrupts/irq.h"
+#include "../vdso/vdso.h"
+
+#define NS_PER_SECOND 1000000000UL
+
+// Cycles are converted in fixed point: ns = cycles * mult >> MULT_SHIFT
+#define MULT_SHIFT 32
+
+static const clocksource* current_source = NULL;
+static u64 mult = 0;
+
+// Time is counted from base, which is moved on source switch
+static u64 base_cycles = 0;
+static u64 base_ns = 0;
+
+static u64 cycles_to_ns(u64 cycles) {
+    return ((unsigned __int128) cycles * mult) >> MULT_SHIFT;
+}
+
+void clocksource_register(const clocksource* source) {
+    if (current_source && current_source->rating >= source->rating)
+        return;
+
+    bool interrupts_enabled = local_irq_save();
+    u64 now = clocksource_read_ns();
+    current_source = source;
+    mult = (NS_PER_SECOND << MULT_SHIFT) / source->frequency;
+    base_cycles = source->read();
+    base_ns = now;
+    local_irq_restore(interrupts_enabled);
+
+    vdso_update_clock();
+}
+
+const clocksource* clocksource_current() { return current_source; }
+
+u64 clocksource_read_ns() {
+    if (!current_source)
+        return 0;
+
+    return base_ns + cycles_to_ns(current_source->read() - base_cycles);
+}
+
+u64 clocksource_resolution_ns() {
+    if (!current_source)
+        return 0;
+
+    u64 resolution = NS_PER_SECOND / current_source->frequency;
+    return resolution ? resolution : 1;
+}
+
+bool clocksource_get_conversion(clocksource_conversion* conversion) {
+    if (!current_source)
+        return false;
+
+    *conversion = (clocksource_conversion){.base_cycles = base_cycles,
+                                           .base_ns = base_ns,
+                                           .mult = mult,
+                                           .shift = MULT_SHIFT};
+    return true;
+}
\ No newline at end of file
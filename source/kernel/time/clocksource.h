@@ -0,0 +1,36 @@
+#ifndef SOS_CLOCKSOURCE_H
+#define SOS_CLOCKSOURCE_H
+
+#include "../lib/types.h"
+
+// Free running 64 bit counter time is measured with
+typedef struct {
+    const char* name;
+    u64 (*read)();
+    u64 frequency;      // in Hz
+    u64 rating;         // registered source with highest rating is used
+    bool user_readable; // user code can read counter, e.g. through vdso
+} clocksource;
+
+// Converts counter of current source to monotonic time:
+// ns = base_ns + ((cycles - base_cycles) * mult >> shift)
+typedef struct {
+    u64 base_cycles;
+    u64 base_ns;
+    u64 mult;
+    u64 shift;
+} clocksource_conversion;
+
+// Should be called on boot cpu before other cpus are started. Switching to
+// better source keeps time monotonic.
+void clocksource_register(const clocksource* source);
+const clocksource* clocksource_current();
+
+// Monotonic time since first source was registered, zero before that
+u64 clocksource_read_ns();
+u64 clocksource_resolution_ns();
+
+// Returns false if no source is registered yet
+bool clocksource_get_conversion(clocksource_conversion* conversion);
+
+#endif // SOS_CLOCKSOURCE_H
\ No newline at end of file
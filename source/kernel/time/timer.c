@@ -1,13 +1,31 @@
 #include "timer.h"
+#include "../arch/common/smp.h"
 #include "../lib/types.h"
 #include "../threading/scheduler.h"
+#include "clockevent.h"
+#include "clocksource.h"
+#include "timer_wheel.h"
 
-static volatile u64 ticks = 0;
-
+// Runs on every cpu that has its timer event expired. Expired kernel timers
+// fire first, so that threads they wake up compete for cpu right away. Then
+// scheduler charges running thread, which enforces time slices, deadline
+// budgets and real-time throttling, and programs next event of this cpu.
 struct cpu_context* handle_timer_interrupt(struct cpu_context* context) {
-    ticks++;
+    // periodic tick is delivered only to boot cpu, other cpus are preempted
+    // through reschedule ipi
+    if (!clockevent_oneshot())
+        arch_broadcast_reschedule();
 
+    timer_wheel_run();
+    scheduler_tick();
     schedule();
 
     return context;
+}
+
+u64 timer_now_ns() { return clocksource_read_ns(); }
+
+u64 timer_deadline_ns(u64 timeout_ns) {
+    u64 now = timer_now_ns();
+    return timeout_ns < TIME_NEVER - now ? now + timeout_ns : TIME_NEVER;
 }
\ No newline at end of file
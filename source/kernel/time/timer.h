@@ -1,6 +1,14 @@
 #ifndef SOS_TIMER_H
 #define SOS_TIMER_H
 
+#include "../lib/types.h"
+
 struct cpu_context* handle_timer_interrupt(struct cpu_context* context);
 
+// Monotonic time since boot
+u64 timer_now_ns();
+
+// Monotonic time timeout_ns from now, saturates at TIME_NEVER
+u64 timer_deadline_ns(u64 timeout_ns);
+
 #endif // SOS_TIMER_H
@@ -0,0 +1,250 @@
+#include "timer_wheel.h"
+#include "../interrupts/irq.h"
+#include "../lib/math.h"
+#include "../synchronization/spin_lock.h"
+#include "../threading/percpu.h"
+#include "clockevent.h"
+#include "timer.h"
+
+/*
+ * Wheel time is counted in ticks of TICK_NS. Every level is an array of
+ * buckets, each next level is LEVEL_GRANULARITY times coarser than previous
+ * one. Timer is put into the finest level that can hold its expiry time,
+ * rounded up to granularity of that level, so timers never cascade between
+ * levels and are processed only once, when their bucket is reached.
+ */
+
+#define TICK_SHIFT 16
+#define TICK_NS (1UL << TICK_SHIFT)
+
+#define LEVEL_BITS 6
+#define LEVEL_SIZE (1UL << LEVEL_BITS)
+#define LEVEL_GRANULARITY_SHIFT 3
+#define LEVELS 8
+
+#define BUCKETS_COUNT (LEVELS * LEVEL_SIZE)
+// Holds timers that are taken from their buckets and are about to fire
+#define EXPIRED_BUCKET BUCKETS_COUNT
+
+typedef struct {
+    lock lock;
+    u64 clk; // next tick to be processed
+    u64 pending[LEVELS]; // bitmap of non empty buckets of every level
+    linked_list buckets[BUCKETS_COUNT + 1];
+    ktimer* running; // timer whose callback is being called
+} timer_wheel;
+
+#define TIMER_WHEEL_STATIC_INITIALIZER                                         \
+    { .lock = SPIN_LOCK_STATIC_INITIALIZER, .clk = 0, .running = NULL }
+
+static timer_wheel wheels[MAX_CPUS] = {[0 ... MAX_CPUS - 1] =
+                                           TIMER_WHEEL_STATIC_INITIALIZER};
+
+void ktimer_init(ktimer* timer, ktimer_callback* callback, void* data) {
+    *timer = (ktimer) KTIMER_STATIC_INITIALIZER(*timer, callback, data);
+}
+
+// First tick at which time has passed
+static u64 time_to_tick(u64 ns) { return ns / TICK_NS + (ns % TICK_NS != 0); }
+
+static u64 level_shift(u64 level) { return level * LEVEL_GRANULARITY_SHIFT; }
+
+// Index of first bucket of level that is reached at or after tick
+static u64 level_index(u64 tick, u64 level) {
+    u64 shift = level_shift(level);
+    return (tick + (1UL << shift) - 1) >> shift;
+}
+
+// Earliest tick at which some non empty bucket is processed
+static u64 next_pending_tick(timer_wheel* wheel) {
+    u64 next = TIME_NEVER;
+    for (u64 level = 0; level < LEVELS; level++) {
+        u64 bits = wheel->pending[level];
+        if (!bits)
+            continue;
+
+        u64 first = level_index(wheel->clk, level);
+        u64 start = first % LEVEL_SIZE;
+        u64 rotated = start ? (bits >> start) | (bits << (64 - start)) : bits;
+        u64 index = first + __builtin_ctzl(rotated);
+        next = MIN(next, index << level_shift(level));
+    }
+
+    return next;
+}
+
+// Returns tick at which timer will be processed
+static u64 enqueue_timer(timer_wheel* wheel, ktimer* timer) {
+    u64 tick = MAX(time_to_tick(timer->expires), wheel->clk);
+
+    u64 level = 0;
+    u64 index = level_index(tick, 0);
+    while (index - level_index(wheel->clk, level) >= LEVEL_SIZE) {
+        // too distant timer waits in last bucket of last level and is queued
+        // again once that bucket is reached
+        if (level == LEVELS - 1) {
+            index = level_index(wheel->clk, level) + LEVEL_SIZE - 1;
+            break;
+        }
+
+        level++;
+        index = level_index(tick, level);
+    }
+
+    u64 slot = index % LEVEL_SIZE;
+    timer->bucket = level * LEVEL_SIZE + slot;
+    timer->pending = true;
+    linked_list_add_last_node(&wheel->buckets[timer->bucket], &timer->node);
+    wheel->pending[level] |= 1UL << slot;
+
+    return index << level_shift(level);
+}
+
+static void dequeue_timer(timer_wheel* wheel, ktimer* timer) {
+    linked_list* bucket = &wheel->buckets[timer->bucket];
+    linked_list_remove_node(bucket, &timer->node);
+    if (timer->bucket != EXPIRED_BUCKET && !bucket->size) {
+        u64 level = timer->bucket / LEVEL_SIZE;
+        wheel->pending[level] &= ~(1UL << (timer->bucket % LEVEL_SIZE));
+    }
+
+    timer->pending = false;
+}
+
+// Locks wheel timer is queued on, handles concurrent re-arming on other cpu.
+// Should be called with interrupts disabled.
+static timer_wheel* lock_timer_wheel(ktimer* timer) {
+    while (true) {
+        timer_wheel* wheel = &wheels[timer->cpu];
+        spin_lock(&wheel->lock);
+        if (wheel == &wheels[timer->cpu])
+            return wheel;
+
+        spin_unlock(&wheel->lock);
+    }
+}
+
+// Idle wheel may be far behind, timer armed on it would land in too coarse
+// level. Ticks with no buckets to process can be skipped.
+static void forward_clock(timer_wheel* wheel) {
+    u64 now = timer_now_ns() / TICK_NS;
+    if (now > wheel->clk && next_pending_tick(wheel) > now)
+        wheel->clk = now;
+}
+
+void ktimer_add(ktimer* timer, u64 expires_ns) {
+    bool interrupts_enabled = local_irq_save();
+
+    if (timer->pending) {
+        timer_wheel* old = lock_timer_wheel(timer);
+        if (timer->pending)
+            dequeue_timer(old, timer);
+        spin_unlock(&old->lock);
+    }
+
+    // periodic tick interrupts boot cpu only
+    u64 cpu = clockevent_oneshot() ? this_cpu_id() : 0;
+    timer_wheel* wheel = &wheels[cpu];
+    spin_lock(&wheel->lock);
+    timer->expires = expires_ns;
+    timer->cpu = cpu;
+    timer->node.value = timer;
+    forward_clock(wheel);
+    u64 fire_tick = enqueue_timer(wheel, timer);
+    spin_unlock(&wheel->lock);
+
+    if (cpu == this_cpu_id())
+        clockevent_program_before(fire_tick * TICK_NS);
+
+    local_irq_restore(interrupts_enabled);
+}
+
+bool ktimer_cancel(ktimer* timer) {
+    bool cancelled = false;
+    while (true) {
+        bool interrupts_enabled = local_irq_save();
+        timer_wheel* wheel = lock_timer_wheel(timer);
+        if (timer->pending) {
+            dequeue_timer(wheel, timer);
+            cancelled = true;
+        }
+        bool running = wheel->running == timer;
+        spin_unlock(&wheel->lock);
+        local_irq_restore(interrupts_enabled);
+
+        if (!running)
+            return cancelled;
+    }
+}
+
+// Moves timers of buckets processed at current tick to expired bucket
+static void collect_expired(timer_wheel* wheel) {
+    linked_list* expired = &wheel->buckets[EXPIRED_BUCKET];
+    for (u64 level = 0; level < LEVELS; level++) {
+        u64 shift = level_shift(level);
+        // coarser levels are processed only at their granularity boundary
+        if (wheel->clk & ((1UL << shift) - 1))
+            break;
+
+        u64 slot = (wheel->clk >> shift) % LEVEL_SIZE;
+        linked_list* bucket = &wheel->buckets[level * LEVEL_SIZE + slot];
+        linked_list_node* node;
+        while ((node = linked_list_remove_first_node(bucket))) {
+            ((ktimer*) node->value)->bucket = EXPIRED_BUCKET;
+            linked_list_add_last_node(expired, node);
+        }
+        wheel->pending[level] &= ~(1UL << slot);
+    }
+
+    wheel->clk++;
+}
+
+// Wheel lock is released while callback is called, so that callback can arm
+// timers, including its own one
+static void run_expired(timer_wheel* wheel, u64 tick) {
+    linked_list* expired = &wheel->buckets[EXPIRED_BUCKET];
+    linked_list_node* node;
+    while ((node = linked_list_remove_first_node(expired))) {
+        ktimer* timer = node->value;
+        if (time_to_tick(timer->expires) > tick) {
+            enqueue_timer(wheel, timer);
+            continue;
+        }
+
+        timer->pending = false;
+        wheel->running = timer;
+        spin_unlock(&wheel->lock);
+
+        timer->callback(timer);
+
+        spin_lock(&wheel->lock);
+        wheel->running = NULL;
+    }
+}
+
+void timer_wheel_run() {
+    timer_wheel* wheel = &wheels[this_cpu_id()];
+    u64 now = timer_now_ns() / TICK_NS;
+
+    spin_lock(&wheel->lock);
+    u64 next;
+    while ((next = next_pending_tick(wheel)) <= now) {
+        // nothing is processed at ticks before next one, so skip them
+        wheel->clk = MAX(wheel->clk, next);
+        collect_expired(wheel);
+        run_expired(wheel, next);
+    }
+
+    wheel->clk = MAX(wheel->clk, now + 1);
+    spin_unlock(&wheel->lock);
+}
+
+u64 timer_wheel_next_event() {
+    timer_wheel* wheel = &wheels[this_cpu_id()];
+
+    spin_lock(&wheel->lock);
+    u64 next = next_pending_tick(wheel);
+    spin_unlock(&wheel->lock);
+
+    return next == TIME_NEVER ? TIME_NEVER : next * TICK_NS;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef SOS_TIMER_WHEEL_H
+#define SOS_TIMER_WHEEL_H
+
+#include "../lib/container/linked_list/linked_list.h"
+#include "../lib/types.h"
+
+/*
+ * Kernel timers are kept in per cpu hierarchical timer wheels, so arming and
+ * cancelling timer is O(1). Callbacks are called from timer interrupt of cpu
+ * timer was armed on, with interrupts disabled, so they should be short and
+ * must not block.
+ *
+ * Wheel trades precision for speed: timer fires no earlier than its expiry
+ * time, but may fire later by up to 1/8 of time that was left until expiry
+ * when it was armed.
+ */
+
+struct ktimer;
+
+typedef void ktimer_callback(struct ktimer* timer);
+
+typedef struct ktimer {
+    u64 expires; // monotonic time in nanoseconds
+    ktimer_callback* callback;
+    void* data;
+
+    // fields below are guarded by lock of wheel timer is queued on
+    linked_list_node node;
+    u64 cpu;
+    u32 bucket;
+    bool pending;
+} ktimer;
+
+#define KTIMER_STATIC_INITIALIZER(timer, cb, value)                            \
+    {                                                                          \
+        .expires = 0, .callback = (cb), .data = (value),                       \
+        .node = LINKED_LIST_NODE_OF(&(timer)), .cpu = 0, .bucket = 0,          \
+        .pending = false                                                       \
+    }
+
+void ktimer_init(ktimer* timer, ktimer_callback* callback, void* data);
+
+// Arms timer on wheel of current cpu, already pending timer is re-armed.
+// Timer should not be armed concurrently from several cpus.
+void ktimer_add(ktimer* timer, u64 expires_ns);
+
+// Returns true if timer was pending and its callback won't be called. Waits
+// for callback to finish if it is running, so must not be called from
+// callback of the same timer.
+bool ktimer_cancel(ktimer* timer);
+
+// Calls callbacks of expired timers of current cpu, should be called from
+// timer interrupt
+void timer_wheel_run();
+
+// Earliest time wheel of current cpu has timers to fire at, TIME_NEVER if it
+// is empty. Should be called with interrupts disabled.
+u64 timer_wheel_next_event();
+
+#endif // SOS_TIMER_WHEEL_H
\ No newline at end of file
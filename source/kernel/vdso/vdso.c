@@ -0,0 +1,115 @@
+#include "vdso.h"
+#include "../arch/common/signal.h"
+#include "../lib/memory_util.h"
+#include "../lib/panic.h"
+#include "../memory/memory_map.h"
+#include "../memory/virtual/shm.h"
+#include "../synchronization/barriers.h"
+#include "../synchronization/spin_lock.h"
+#include "../time/clock.h"
+#include "../time/clocksource.h"
+
+static shm_segment* clock_segment = NULL;
+static vdso_clock_data* clock_data = NULL;
+static lock clock_data_lock = SPIN_LOCK_STATIC_INITIALIZER;
+
+static shm_segment* code_segment = NULL;
+
+static const vm_area_flags VDSO_FLAGS = {.writable = false,
+                                         .user_access_allowed = true,
+                                         .executable = false,
+                                         .shared = true};
+
+static const vm_area_flags VDSO_CODE_FLAGS = {.writable = false,
+                                              .user_access_allowed = true,
+                                              .executable = true,
+                                              .shared = true};
+
+static void code_init() {
+    code_segment = shm_segment_create(1);
+    if (!code_segment)
+        panic("Can't allocate vdso code page");
+
+    shm_segment_ref(code_segment);
+    memcpy((void*) P2V(code_segment->frames[0]),
+           (void*) arch_signal_trampoline_code(),
+           arch_signal_trampoline_size());
+}
+
+void vdso_init() {
+    clock_segment = shm_segment_create(1);
+    if (!clock_segment)
+        panic("Can't allocate vdso clock data");
+
+    // never freed, since every user space maps it
+    shm_segment_ref(clock_segment);
+    clock_data = (vdso_clock_data*) P2V(clock_segment->frames[0]);
+
+    vdso_update_clock();
+    code_init();
+}
+
+void vdso_update_clock() {
+    if (!clock_data)
+        return;
+
+    clocksource_conversion conversion;
+    const clocksource* source = clocksource_current();
+    bool readable = clocksource_get_conversion(&conversion)
+                    && source->user_readable;
+
+    bool interrupts_enabled = spin_lock_irq_save(&clock_data_lock);
+    clock_data->sequence++;
+    smp_wb();
+
+    clock_data->mode = readable ? VDSO_CLOCK_COUNTER : VDSO_CLOCK_SYSCALL;
+    if (readable) {
+        clock_data->base_cycles = conversion.base_cycles;
+        clock_data->base_ns = conversion.base_ns;
+        clock_data->mult = conversion.mult;
+        clock_data->shift = conversion.shift;
+    }
+    clock_data->realtime_offset_ns = clock_realtime_offset_ns();
+
+    smp_wb();
+    clock_data->sequence++;
+    spin_unlock_irq_restore(&clock_data_lock, interrupts_enabled);
+}
+
+bool vdso_install(vm_space* space, u64 pid) {
+    shm_segment* process_segment = shm_segment_create(1);
+    if (!process_segment)
+        return false;
+
+    shm_segment_ref(process_segment);
+    vdso_process_data* process_data =
+        (vdso_process_data*) P2V(process_segment->frames[0]);
+    process_data->pid = pid;
+
+    rw_spin_lock_write_irq(&space->lock);
+
+    // forked space shares clock data and code with its parent, but not
+    // process data
+    vm_space_unmap_shared(space, VDSO_PROCESS_DATA_VADDR);
+
+    vm_page_mapping_result result = SUCCESS;
+    if (!vm_space_get_surrounding_area(space, VDSO_CLOCK_DATA_VADDR,
+                                       PAGE_SIZE))
+        result = vm_space_map_shared(space, VDSO_CLOCK_DATA_VADDR,
+                                     clock_segment, VDSO_FLAGS);
+    if (result == SUCCESS
+        && !vm_space_get_surrounding_area(space, VDSO_SIGNAL_TRAMPOLINE_VADDR,
+                                          PAGE_SIZE))
+        result = vm_space_map_shared(space, VDSO_SIGNAL_TRAMPOLINE_VADDR,
+                                     code_segment, VDSO_CODE_FLAGS);
+    if (result == SUCCESS)
+        result = vm_space_map_shared(space, VDSO_PROCESS_DATA_VADDR,
+                                     process_segment, VDSO_FLAGS);
+
+    rw_spin_unlock_write_irq(&space->lock);
+
+    // mapped area holds its own reference
+    shm_segment_unref(process_segment);
+
+    return result == SUCCESS;
+}
\ No newline at end of file
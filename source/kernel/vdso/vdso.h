@@ -0,0 +1,56 @@
+#ifndef SOS_VDSO_H
+#define SOS_VDSO_H
+
+#include "../arch/common/vmm.h"
+#include "../lib/types.h"
+#include "../memory/virtual/vm.h"
+
+/*
+ * Pages mapped read-only into every user vm space. Data pages let user code
+ * read time and its pid without syscall, code page holds signal trampoline.
+ * Clock data and code pages are shared by all spaces. Clock data is protected
+ * by sequence counter: writer makes it odd while data is updated, so reader
+ * retries if counter is odd or changed while it read. Process data page is
+ * private to every process.
+ *
+ * Layout and addresses are mirrored by user library.
+ */
+
+#define VDSO_CLOCK_DATA_VADDR 0x00007F0000000000
+#define VDSO_PROCESS_DATA_VADDR (VDSO_CLOCK_DATA_VADDR + PAGE_SIZE)
+#define VDSO_SIGNAL_TRAMPOLINE_VADDR (VDSO_CLOCK_DATA_VADDR + 2 * PAGE_SIZE)
+
+// Current clocksource can't be read from user space, syscall should be used
+#define VDSO_CLOCK_SYSCALL 0
+// Current clocksource is arch counter user space can read, e.g. tsc
+#define VDSO_CLOCK_COUNTER 1
+
+typedef struct {
+    volatile u64 sequence;
+    u64 mode;
+
+    // monotonic ns = base_ns + ((counter - base_cycles) * mult >> shift)
+    u64 base_cycles;
+    u64 base_ns;
+    u64 mult;
+    u64 shift;
+
+    u64 realtime_offset_ns; // realtime ns = monotonic ns + offset
+} vdso_clock_data;
+
+typedef struct {
+    u64 pid;
+} vdso_process_data;
+
+// Should be called before first user process is created
+void vdso_init();
+
+// Maps vdso pages into user vm space of process, replaces process data page
+// inherited on fork. Returns false if memory is exhausted.
+bool vdso_install(vm_space* space, u64 pid);
+
+// Publishes current clocksource conversion and realtime offset, called by time
+// keeping code whenever they change
+void vdso_update_clock();
+
+#endif // SOS_VDSO_H
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "batch.h"
+#include "syscall.h"
+
+long long syscall_batch(struct syscall_batch_entry* entries, long long count,
+                        long long flags) {
+    return syscall3(SYS_BATCH, (long long) entries, count, flags);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef SOS_BATCH_H
+#define SOS_BATCH_H
+
+#define SYSCALL_BATCH_MAX_ENTRIES 256
+
+#define SYSCALL_BATCH_STOP_ON_ERROR 0x1
+
+struct syscall_batch_entry {
+    long long number;
+    long long args[6];
+    long long result;
+};
+
+// Returns count of entries executed, each one has its result filled in
+long long syscall_batch(struct syscall_batch_entry* entries, long long count,
+                        long long flags);
+
+#endif // SOS_BATCH_H
\ No newline at end of file
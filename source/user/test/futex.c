@@ -0,0 +1,17 @@
+#include "futex.h"
+#include "syscall.h"
+
+long long futex(volatile int* uaddr, int op, int val, long long val2,
+                volatile int* uaddr2, int val3) {
+    return syscall6(SYS_FUTEX, (long long) uaddr, op, val, val2,
+                    (long long) uaddr2, val3);
+}
+
+long long futex_wait(volatile int* uaddr, int val,
+                     const struct timespec* timeout) {
+    return futex(uaddr, FUTEX_WAIT, val, (long long) timeout, 0, 0);
+}
+
+long long futex_wake(volatile int* uaddr, int count) {
+    return futex(uaddr, FUTEX_WAKE, count, 0, 0, 0);
+}
\ No newline at end of file
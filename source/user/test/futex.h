@@ -0,0 +1,39 @@
+#ifndef SOS_FUTEX_H
+#define SOS_FUTEX_H
+
+#include "time.h"
+
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+#define FUTEX_REQUEUE 3
+#define FUTEX_CMP_REQUEUE 4
+#define FUTEX_WAKE_OP 5
+
+#define FUTEX_OP_SET 0
+#define FUTEX_OP_ADD 1
+#define FUTEX_OP_OR 2
+#define FUTEX_OP_ANDN 3
+#define FUTEX_OP_XOR 4
+
+#define FUTEX_OP_OPARG_SHIFT 8
+
+#define FUTEX_OP_CMP_EQ 0
+#define FUTEX_OP_CMP_NE 1
+#define FUTEX_OP_CMP_LT 2
+#define FUTEX_OP_CMP_LE 3
+#define FUTEX_OP_CMP_GT 4
+#define FUTEX_OP_CMP_GE 5
+
+#define FUTEX_OP(op, oparg, cmp, cmparg)                                       \
+    (((op) << 28) | ((cmp) << 24) | ((oparg) << 12) | (cmparg))
+
+// val2 is either timeout pointer or second count, depending on operation
+long long futex(volatile int* uaddr, int op, int val, long long val2,
+                volatile int* uaddr2, int val3);
+
+// Sleeps while *uaddr == val, null timeout stands for waiting forever
+long long futex_wait(volatile int* uaddr, int val,
+                     const struct timespec* timeout);
+long long futex_wake(volatile int* uaddr, int count);
+
+#endif // SOS_FUTEX_H
\ No newline at end of file
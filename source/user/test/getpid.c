@@ -1,3 +1,3 @@
-#include "syscall.h"
+#include "vdso.h"
 
-long long getpid() { return syscall0(SYS_GETPID); }
\ No newline at end of file
+long long getpid() { return vdso_getpid(); }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "io_ring.h"
+#include "syscall.h"
+
+long long io_ring_init(struct io_ring* ring, unsigned int entries, void* base) {
+    long long result = syscall2(SYS_IO_RING_SETUP, entries, (long long) base);
+    if (result < 0)
+        return result;
+
+    ring->header = base;
+    ring->sqes = (struct io_ring_sqe*) ((char*) base + ring->header->sq_offset);
+    ring->cqes = (struct io_ring_cqe*) ((char*) base + ring->header->cq_offset);
+
+    return 0;
+}
+
+struct io_ring_sqe* io_ring_get_sqe(struct io_ring* ring) {
+    struct io_ring_header* header = ring->header;
+    unsigned int head = __atomic_load_n(&header->sq_head, __ATOMIC_ACQUIRE);
+    if (header->sq_tail - head == header->sq_entries)
+        return 0;
+
+    return &ring->sqes[header->sq_tail & (header->sq_entries - 1)];
+}
+
+void io_ring_submit(struct io_ring* ring) {
+    // entry should be visible before tail that publishes it
+    __atomic_store_n(&ring->header->sq_tail, ring->header->sq_tail + 1,
+                     __ATOMIC_RELEASE);
+}
+
+struct io_ring_cqe* io_ring_peek_cqe(struct io_ring* ring) {
+    struct io_ring_header* header = ring->header;
+    unsigned int tail = __atomic_load_n(&header->cq_tail, __ATOMIC_ACQUIRE);
+    if (header->cq_head == tail)
+        return 0;
+
+    return &ring->cqes[header->cq_head & (header->cq_entries - 1)];
+}
+
+void io_ring_cqe_seen(struct io_ring* ring) {
+    __atomic_store_n(&ring->header->cq_head, ring->header->cq_head + 1,
+                     __ATOMIC_RELEASE);
+}
+
+long long io_enter(long long to_submit, long long min_complete) {
+    return syscall2(SYS_IO_ENTER, to_submit, min_complete);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef SOS_IO_RING_H
+#define SOS_IO_RING_H
+
+// Mirrors ring layout kernel shares with process
+
+#define IO_RING_MAX_ENTRIES 1024
+
+#define IO_OP_NOP 0
+#define IO_OP_PRINT 1        // args[0] - string
+#define IO_OP_PRINT_U64 2    // args[0] - number
+#define IO_OP_WAIT 3         // args[0] - pid, args[1] - exit code pointer
+#define IO_OP_PTHREAD_JOIN 4 // args[0] - thread, args[1] - exit code pointer
+
+struct io_ring_header {
+    volatile unsigned int sq_head;
+    volatile unsigned int sq_tail;
+    volatile unsigned int cq_head;
+    volatile unsigned int cq_tail;
+
+    unsigned int sq_entries;
+    unsigned int cq_entries;
+    unsigned int sq_offset;
+    unsigned int cq_offset;
+};
+
+struct io_ring_sqe {
+    long long opcode;
+    long long user_data;
+    long long args[6];
+};
+
+struct io_ring_cqe {
+    long long user_data;
+    long long result;
+};
+
+struct io_ring {
+    struct io_ring_header* header;
+    struct io_ring_sqe* sqes;
+    struct io_ring_cqe* cqes;
+};
+
+// Maps ring with `entries` submission slots (power of two) at page aligned
+// `base`, returns 0 or negative error code
+long long io_ring_init(struct io_ring* ring, unsigned int entries, void* base);
+
+// Returns free submission slot or 0 if queue is full, slot is handed to
+// kernel by io_ring_submit
+struct io_ring_sqe* io_ring_get_sqe(struct io_ring* ring);
+void io_ring_submit(struct io_ring* ring);
+
+// Returns oldest completion or 0 if there are none, io_ring_cqe_seen frees it
+struct io_ring_cqe* io_ring_peek_cqe(struct io_ring* ring);
+void io_ring_cqe_seen(struct io_ring* ring);
+
+long long io_enter(long long to_submit, long long min_complete);
+
+#endif // SOS_IO_RING_H
\ No newline at end of file
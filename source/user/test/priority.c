@@ -0,0 +1,23 @@
+#include "priority.h"
+#include "syscall.h"
+
+// kernel returns nice value biased by 20 to keep it positive
+#define NICE_RETURN_BIAS 20
+
+long long setpriority(int which, long long who, int prio) {
+    return syscall3(SYS_SETPRIORITY, which, who, prio);
+}
+
+long long getpriority(int which, long long who) {
+    long long result = syscall2(SYS_GETPRIORITY, which, who);
+    return result < 0 ? result - NICE_RETURN_BIAS : NICE_RETURN_BIAS - result;
+}
+
+long long nice(int inc) {
+    long long current = getpriority(PRIO_PROCESS, 0);
+    if (current < -NICE_RETURN_BIAS)
+        return current;
+
+    long long result = setpriority(PRIO_PROCESS, 0, current + inc);
+    return result < 0 ? result : getpriority(PRIO_PROCESS, 0);
+}
@@ -0,0 +1,13 @@
+#ifndef SOS_PRIORITY_H
+#define SOS_PRIORITY_H
+
+#define PRIO_PROCESS 0
+
+long long setpriority(int which, long long who, int prio);
+// Returns nice value, negative values below -20 are errors
+long long getpriority(int which, long long who);
+
+// Adds increment to nice value of current process, returns new nice value
+long long nice(int inc);
+
+#endif // SOS_PRIORITY_H
@@ -1,4 +1,5 @@
 #include "pthread.h"
+#include "futex.h"
 #include "syscall.h"
 
 long long pthread_run(const char* name, pthread_func* func, pthread* thread) {
@@ -19,4 +20,77 @@ _Noreturn void pthread_exit(long long code) {
     syscall1(SYS_PTHREAD_EXIT, code);
 
     __builtin_unreachable();
+}
+
+#define MUTEX_UNLOCKED 0
+#define MUTEX_LOCKED 1
+#define MUTEX_CONTENDED 2
+
+#define WAKE_ALL 0x7FFFFFFF
+
+void pthread_mutex_init(pthread_mutex* mutex) { mutex->state = MUTEX_UNLOCKED; }
+
+int pthread_mutex_trylock(pthread_mutex* mutex) {
+    int expected = MUTEX_UNLOCKED;
+    return __atomic_compare_exchange_n(&mutex->state, &expected, MUTEX_LOCKED,
+                                       0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+               ? 0
+               : -1;
+}
+
+// Mutex is taken as contended, since there may be other waiters
+static void mutex_lock_contended(pthread_mutex* mutex) {
+    while (__atomic_exchange_n(&mutex->state, MUTEX_CONTENDED,
+                               __ATOMIC_ACQUIRE)
+           != MUTEX_UNLOCKED) {
+        futex_wait(&mutex->state, MUTEX_CONTENDED, 0);
+    }
+}
+
+void pthread_mutex_lock(pthread_mutex* mutex) {
+    if (pthread_mutex_trylock(mutex) == 0)
+        return;
+
+    mutex_lock_contended(mutex);
+}
+
+void pthread_mutex_unlock(pthread_mutex* mutex) {
+    if (__atomic_exchange_n(&mutex->state, MUTEX_UNLOCKED, __ATOMIC_RELEASE)
+        == MUTEX_CONTENDED)
+        futex_wake(&mutex->state, 1);
+}
+
+void pthread_cond_init(pthread_cond* cond) {
+    cond->sequence = 0;
+    cond->mutex = 0;
+}
+
+void pthread_cond_wait(pthread_cond* cond, pthread_mutex* mutex) {
+    int sequence = __atomic_load_n(&cond->sequence, __ATOMIC_RELAXED);
+    cond->mutex = mutex;
+
+    pthread_mutex_unlock(mutex);
+    // signal which comes after unlock changes sequence, so it isn't missed
+    futex_wait(&cond->sequence, sequence, 0);
+
+    // waiter could be requeued onto mutex by broadcast
+    mutex_lock_contended(mutex);
+}
+
+void pthread_cond_signal(pthread_cond* cond) {
+    __atomic_add_fetch(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&cond->sequence, 1);
+}
+
+void pthread_cond_broadcast(pthread_cond* cond) {
+    pthread_mutex* mutex = cond->mutex;
+    __atomic_add_fetch(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+
+    if (!mutex) {
+        futex_wake(&cond->sequence, WAKE_ALL);
+        return;
+    }
+
+    // only one waiter can take mutex anyway, others wait for its unlock
+    futex(&cond->sequence, FUTEX_REQUEUE, 1, WAKE_ALL, &mutex->state, 0);
 }
\ No newline at end of file
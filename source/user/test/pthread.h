@@ -4,9 +4,39 @@
 typedef void pthread_func();
 typedef long long pthread;
 
+// Futex based mutex: 0 - unlocked, 1 - locked, 2 - locked and may have
+// waiters. Uncontended lock and unlock don't enter kernel.
+typedef struct {
+    volatile int state;
+} pthread_mutex;
+
+#define PTHREAD_MUTEX_INITIALIZER                                              \
+    { 0 }
+
+// Waiters sleep on sequence, which is bumped by every signal and broadcast
+typedef struct {
+    volatile int sequence;
+    pthread_mutex* volatile mutex; // mutex waiters use, broadcast requeues
+                                   // them there instead of waking all at once
+} pthread_cond;
+
+#define PTHREAD_COND_INITIALIZER                                               \
+    { 0, 0 }
+
 long long pthread_run(const char* name, pthread_func* func, pthread* thread);
 long long pthread_join(pthread thread, long long* exit_code);
 long long pthread_detach(pthread thread);
 _Noreturn void pthread_exit(long long code);
 
+void pthread_mutex_init(pthread_mutex* mutex);
+void pthread_mutex_lock(pthread_mutex* mutex);
+// Returns 0 if mutex was acquired, -1 otherwise
+int pthread_mutex_trylock(pthread_mutex* mutex);
+void pthread_mutex_unlock(pthread_mutex* mutex);
+
+void pthread_cond_init(pthread_cond* cond);
+void pthread_cond_wait(pthread_cond* cond, pthread_mutex* mutex);
+void pthread_cond_signal(pthread_cond* cond);
+void pthread_cond_broadcast(pthread_cond* cond);
+
 #endif // SOS_PTHREAD_H
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "rseq.h"
+#include "syscall.h"
+
+static long long rseq(struct rseq* rs, int flags) {
+    return syscall6(SYS_RSEQ, (long long) rs, sizeof(struct rseq), flags,
+                    RSEQ_SIG, 0, 0);
+}
+
+long long rseq_register(struct rseq* rs) { return rseq(rs, 0); }
+
+long long rseq_unregister(struct rseq* rs) {
+    return rseq(rs, RSEQ_FLAG_UNREGISTER);
+}
+
+/*
+ * Descriptor (label 3) covers instructions from label 1 up to label 2, the
+ * add is the commit. Descriptor is published right before the section, so
+ * kernel either sees the thread outside of it or inside with descriptor set.
+ * Abort handler (label 4) is preceded by the signature and retries.
+ */
+int rseq_percpu_add(struct rseq* rs, long long* counters, long long value) {
+    int cpu;
+    __asm__ volatile(".pushsection .data\n"
+                     ".balign 32\n"
+                     "3:\n"
+                     ".long 0, 0\n"
+                     ".quad 1f, 2f - 1f, 4f\n"
+                     ".popsection\n"
+                     "0:\n"
+                     "leaq 3b(%%rip), %%rax\n"
+                     "movq %%rax, 8(%[rs])\n"
+                     "1:\n"
+                     "movl 4(%[rs]), %[cpu]\n"
+                     "movslq %[cpu], %%rax\n"
+                     "addq %[value], (%[counters], %%rax, 8)\n"
+                     "2:\n"
+                     "jmp 5f\n"
+                     ".long %c[sig]\n"
+                     "4:\n"
+                     "jmp 0b\n"
+                     "5:\n"
+                     : [cpu] "=&r"(cpu)
+                     : [rs] "r"(rs), [counters] "r"(counters),
+                       [value] "r"(value), [sig] "i"(RSEQ_SIG)
+                     : "rax", "memory", "cc");
+    return cpu;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef SOS_RSEQ_H
+#define SOS_RSEQ_H
+
+#define RSEQ_FLAG_UNREGISTER 1
+
+// Signature placed before abort handlers, same as linux uses on x86
+#define RSEQ_SIG 0x53053053
+
+struct rseq {
+    unsigned int cpu_id_start;
+    unsigned int cpu_id;
+    unsigned long long rseq_cs;
+    unsigned int flags;
+    unsigned int padding[3];
+} __attribute__((aligned(32)));
+
+long long rseq_register(struct rseq* rs);
+long long rseq_unregister(struct rseq* rs);
+
+// Adds value to counter of cpu the thread runs on without atomics, sequence
+// is restarted if thread is preempted, migrated or signalled in the middle.
+// Returns id of the cpu.
+int rseq_percpu_add(struct rseq* rs, long long* counters, long long value);
+
+#endif // SOS_RSEQ_H
\ No newline at end of file
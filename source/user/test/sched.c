@@ -0,0 +1,18 @@
+#include "sched.h"
+#include "syscall.h"
+
+long long sched_setscheduler(long long pid, int policy, int priority) {
+    return syscall3(SYS_SCHED_SETSCHEDULER, pid, policy, priority);
+}
+
+long long sched_getscheduler(long long pid) {
+    return syscall1(SYS_SCHED_GETSCHEDULER, pid);
+}
+
+long long sched_setattr(long long pid, struct sched_attr* attr) {
+    return syscall2(SYS_SCHED_SETATTR, pid, (long long) attr);
+}
+
+long long sched_getattr(long long pid, struct sched_attr* attr) {
+    return syscall2(SYS_SCHED_GETATTR, pid, (long long) attr);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef SOS_SCHED_H
+#define SOS_SCHED_H
+
+#define SCHED_NORMAL 0
+#define SCHED_FIFO 1
+#define SCHED_RR 2
+#define SCHED_DEADLINE 6
+
+struct sched_attr {
+    unsigned char policy;
+    unsigned char priority;
+
+    // deadline policy parameters in nanoseconds
+    unsigned long long runtime;
+    unsigned long long deadline;
+    unsigned long long period;
+};
+
+// Real-time policies take priority in [1, 99], normal policy takes zero
+long long sched_setscheduler(long long pid, int policy, int priority);
+long long sched_getscheduler(long long pid);
+
+long long sched_setattr(long long pid, struct sched_attr* attr);
+long long sched_getattr(long long pid, struct sched_attr* attr);
+
+#endif // SOS_SCHED_H
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "semaphore.h"
+#include "futex.h"
+
+void sem_init(semaphore* sem, int value) {
+    sem->value = value;
+    sem->waiters = 0;
+}
+
+int sem_trywait(semaphore* sem) {
+    int value = __atomic_load_n(&sem->value, __ATOMIC_RELAXED);
+    while (value > 0) {
+        if (__atomic_compare_exchange_n(&sem->value, &value, value - 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return 0;
+    }
+
+    return -1;
+}
+
+void sem_wait(semaphore* sem) {
+    while (sem_trywait(sem) != 0) {
+        // poster checks waiters after raising value, so either it sees this
+        // waiter or kernel sees raised value
+        __atomic_add_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+        futex_wait(&sem->value, 0, 0);
+        __atomic_sub_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void sem_post(semaphore* sem) {
+    __atomic_add_fetch(&sem->value, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST))
+        futex_wake(&sem->value, 1);
+}
\ No newline at end of file
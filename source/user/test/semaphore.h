@@ -0,0 +1,20 @@
+#ifndef SOS_SEMAPHORE_H
+#define SOS_SEMAPHORE_H
+
+// Counting semaphore on futex, post and wait enter kernel only if some thread
+// has to sleep or be woken up
+typedef struct {
+    volatile int value;
+    volatile int waiters;
+} semaphore;
+
+#define SEMAPHORE_INITIALIZER(value)                                           \
+    { value, 0 }
+
+void sem_init(semaphore* sem, int value);
+void sem_wait(semaphore* sem);
+// Returns 0 if semaphore was acquired, -1 otherwise
+int sem_trywait(semaphore* sem);
+void sem_post(semaphore* sem);
+
+#endif // SOS_SEMAPHORE_H
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "shm.h"
+#include "syscall.h"
+
+long long shm_create(unsigned long long size) {
+    return syscall1(SYS_SHM_CREATE, (long long) size);
+}
+
+long long shm_attach(long long id, void* addr, int writable) {
+    return syscall3(SYS_SHM_ATTACH, id, (long long) addr, writable);
+}
+
+long long shm_detach(void* addr) {
+    return syscall1(SYS_SHM_DETACH, (long long) addr);
+}
+
+long long shm_remove(long long id) { return syscall1(SYS_SHM_REMOVE, id); }
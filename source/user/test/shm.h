@@ -0,0 +1,9 @@
+#ifndef SOS_SHM_H
+#define SOS_SHM_H
+
+long long shm_create(unsigned long long size);
+long long shm_attach(long long id, void* addr, int writable);
+long long shm_detach(void* addr);
+long long shm_remove(long long id);
+
+#endif // SOS_SHM_H
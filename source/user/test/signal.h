@@ -18,6 +18,7 @@ typedef enum {
     SIGQUIT = 3,
     SIGILL = 4,
     SIGABRT = 6,
+    SIGFPE = 8,
     SIGKILL = 9,
     SIGSEGV = 11,
     SIGTERM = 14,
@@ -3,7 +3,10 @@
 long long syscall0(int syscall_number) {
     long long res;
 
-    __asm__ volatile("int $0x80" : "=a"(res) : "a"(syscall_number) : "memory");
+    __asm__ volatile("syscall"
+                     : "=a"(res)
+                     : "a"(syscall_number)
+                     : "rcx", "r11", "memory");
 
     return res;
 }
@@ -12,10 +15,10 @@ long long syscall1(int syscall_number, long long arg0) {
     long long res;
 
     register long long reg_arg0 asm("rdi") = arg0;
-    __asm__ volatile("int $0x80"
+    __asm__ volatile("syscall"
                      : "=a"(res)
                      : "r"(reg_arg0), "a"(syscall_number)
-                     : "memory");
+                     : "rcx", "r11", "memory");
 
     return res;
 }
@@ -25,10 +28,10 @@ long long syscall2(int syscall_number, long long arg0, long long arg1) {
 
     register long long reg_arg0 asm("rdi") = arg0;
     register long long reg_arg1 asm("rsi") = arg1;
-    __asm__ volatile("int $0x80"
+    __asm__ volatile("syscall"
                      : "=a"(res)
                      : "r"(reg_arg0), "r"(reg_arg1), "a"(syscall_number)
-                     : "memory");
+                     : "rcx", "r11", "memory");
 
     return res;
 }
@@ -41,11 +44,33 @@ long long syscall3(int syscall_number, long long arg0, long long arg1,
     register long long reg_arg0 asm("rdi") = arg0;
     register long long reg_arg1 asm("rsi") = arg1;
     register long long reg_arg2 asm("rdx") = arg2;
-    __asm__ volatile("int $0x80"
+    __asm__ volatile("syscall"
+                     : "=a"(res)
+                     : "r"(reg_arg0), "r"(reg_arg1), "r"(reg_arg2),
+                       "a"(syscall_number)
+                     : "rcx", "r11", "memory");
+
+    return res;
+}
+
+long long syscall6(int syscall_number, long long arg0, long long arg1,
+                   long long arg2, long long arg3, long long arg4,
+                   long long arg5) {
+
+    long long res;
+
+    register long long reg_arg0 asm("rdi") = arg0;
+    register long long reg_arg1 asm("rsi") = arg1;
+    register long long reg_arg2 asm("rdx") = arg2;
+    register long long reg_arg3 asm("r10") = arg3;
+    register long long reg_arg4 asm("r8") = arg4;
+    register long long reg_arg5 asm("r9") = arg5;
+    __asm__ volatile("syscall"
                      : "=a"(res)
                      : "r"(reg_arg0), "r"(reg_arg1), "r"(reg_arg2),
+                       "r"(reg_arg3), "r"(reg_arg4), "r"(reg_arg5),
                        "a"(syscall_number)
-                     : "memory");
+                     : "rcx", "r11", "memory");
 
     return res;
 }
\ No newline at end of file
@@ -18,11 +18,35 @@
 #define SYS_WAIT 10
 #define SYS_GETPID 11
 
+#define SYS_SHM_CREATE 12
+#define SYS_SHM_ATTACH 13
+#define SYS_SHM_DETACH 14
+#define SYS_SHM_REMOVE 15
+
+#define SYS_SETPRIORITY 16
+#define SYS_GETPRIORITY 17
+#define SYS_SCHED_SETSCHEDULER 18
+#define SYS_SCHED_GETSCHEDULER 19
+#define SYS_SCHED_SETATTR 20
+#define SYS_SCHED_GETATTR 21
+#define SYS_CLOCK_GETTIME 22
+#define SYS_CLOCK_GETRES 23
+#define SYS_NANOSLEEP 24
+#define SYS_BATCH 25
+#define SYS_IO_RING_SETUP 26
+#define SYS_IO_ENTER 27
+#define SYS_FUTEX 28
+#define SYS_RSEQ 29
+#define SYS_ARCH_PRCTL 30
+
 
 long long syscall0(int syscall_number);
 long long syscall1(int syscall_number, long long arg0);
 long long syscall2(int syscall_number, long long arg0, long long arg1);
 long long syscall3(int syscall_number, long long arg0, long long arg1,
                    long long arg2);
+long long syscall6(int syscall_number, long long arg0, long long arg1,
+                   long long arg2, long long arg3, long long arg4,
+                   long long arg5);
 
 #endif // SOS_SYSCALL_H
\ No newline at end of file
@@ -1,9 +1,17 @@
+#include "batch.h"
 #include "exit.h"
 #include "fork.h"
 #include "getpid.h"
+#include "io_ring.h"
+#include "priority.h"
+#include "sched.h"
 #include "pthread.h"
+#include "rseq.h"
+#include "shm.h"
 #include "signal.h"
 #include "syscall.h"
+#include "time.h"
+#include "tls.h"
 #include "wait.h"
 
 int signals = 0;
@@ -41,20 +49,31 @@ void sigchld_handler() {
 
 int threads = 1;
 
+pthread_mutex counter_mutex = PTHREAD_MUTEX_INITIALIZER;
+long long counter = 0;
+
 void thread_func() {
     long long i = 1;
-    int current = ++threads;
     long long pid = getpid();
 
+    // thread number is kept in thread-local storage
+    struct tls_block tls;
+    tls_setup(&tls);
+    tls_set(0, (void*) (long long) ++threads);
+
     while (1) {
         print("Hello from proc: ");
         printll(pid);
         print(", thread: ");
-        printll(current);
+        printll((long long) tls_get(0));
         print(", cnt: ");
         printll(i);
         print("\n");
 
+        pthread_mutex_lock(&counter_mutex);
+        counter++;
+        pthread_mutex_unlock(&counter_mutex);
+
         if (i == 5)
             break;
 
@@ -64,10 +83,134 @@ void thread_func() {
     pthread_exit(0xCAFE);
 }
 
+#define SHM_ADDR ((volatile long long*) 0x40000000)
+
+void test_shared_memory() {
+    long long id = shm_create(4096);
+    if (id < 0 || shm_attach(id, (void*) SHM_ADDR, 1) < 0) {
+        print("Failed to set up shared memory\n");
+        return;
+    }
+
+    *SHM_ADDR = 0;
+    long long pid = fork();
+    if (pid == 0) {
+        *SHM_ADDR = 0xC0FFEE;
+        exit(0);
+    }
+
+    long long exit_code;
+    if (pid > 0)
+        wait(pid, &exit_code);
+
+    print("Value written by child to shared memory: ");
+    printll(*SHM_ADDR);
+    print("\n");
+
+    shm_detach((void*) SHM_ADDR);
+    shm_remove(id);
+}
+
 const sigaction sigint_action = {.handler = (signal_handler*) sigint_handler};
 const sigaction sigkill_action = {.disposition = IGNORE};
 const sigaction sigchld_action = {.handler = (signal_handler*) sigchld_handler};
 
+#define IO_RING_ADDR ((void*) 0x50000000)
+
+#define MAX_CPUS 64
+
+struct rseq main_rseq;
+long long cpu_counters[MAX_CPUS];
+
+void test_rseq() {
+    if (rseq_register(&main_rseq) < 0) {
+        print("Failed to register rseq area\n");
+        return;
+    }
+
+    int cpu = 0;
+    for (int i = 0; i < 1000; i++) {
+        cpu = rseq_percpu_add(&main_rseq, cpu_counters, 1);
+    }
+
+    print("Last rseq increment on cpu: ");
+    printll(cpu);
+    print(", its counter: ");
+    printll(cpu_counters[cpu]);
+    print("\n");
+
+    rseq_unregister(&main_rseq);
+}
+
+// Threads keep partial sums in vector registers across preemptions, so
+// results only match if kernel switches their fpu state
+void fpu_thread_func() {
+    double pi = 0;
+    double sign = 1;
+    for (long long i = 0; i < 10000000; i++) {
+        pi += sign * 4 / (2 * i + 1);
+        sign = -sign;
+    }
+
+    print("Pi computed by thread: ");
+    printll((long long) (pi * 1000000));
+    print("e-6\n");
+    pthread_exit(0);
+}
+
+void test_fpu() {
+#define FPU_THREADS_COUNT 2
+    pthread threads[FPU_THREADS_COUNT];
+    int cnt = 0;
+    for (; cnt < FPU_THREADS_COUNT; cnt++) {
+        if (pthread_run("fpu-thread", fpu_thread_func, &threads[cnt]) != 0)
+            break;
+    }
+
+    for (int i = 0; i < cnt; i++) {
+        long long exit_code;
+        pthread_join(threads[i], &exit_code);
+    }
+}
+
+void test_io_ring() {
+    struct io_ring ring;
+    if (io_ring_init(&ring, 8, IO_RING_ADDR) < 0) {
+        print("Failed to set up io ring\n");
+        return;
+    }
+
+    long long pid = fork();
+    if (pid == 0)
+        exit(7);
+
+    long long exit_code = 0;
+    struct io_ring_sqe* sqe = io_ring_get_sqe(&ring);
+    *sqe = (struct io_ring_sqe){.opcode = IO_OP_WAIT,
+                                .user_data = 1,
+                                .args = {pid, (long long) &exit_code}};
+    io_ring_submit(&ring);
+
+    sqe = io_ring_get_sqe(&ring);
+    *sqe = (struct io_ring_sqe){.opcode = IO_OP_PRINT,
+                                .user_data = 2,
+                                .args = {(long long) "Printed from io ring\n"}};
+    io_ring_submit(&ring);
+
+    // print completes right away, wait completes once child exits
+    io_enter(2, 2);
+
+    struct io_ring_cqe* cqe;
+    while ((cqe = io_ring_peek_cqe(&ring))) {
+        if (cqe->user_data == 1) {
+            print("Io ring reaped child, code: ");
+            printll(exit_code);
+            print("\n");
+        }
+        io_ring_cqe_seen(&ring);
+    }
+}
+
 void __attribute__((section(".entrypoint"))) main() {
     // This one should succeed (e.g. return 0)
     long sigint_act_set = process_set_sigaction(SIGINT, &sigint_action);
@@ -75,6 +218,46 @@ void __attribute__((section(".entrypoint"))) main() {
     long sigkill_act_set = process_set_sigaction(SIGKILL, &sigkill_action);
 //    long sigchld_act_set = process_set_sigaction(SIGCHLD, &sigchld_action);
 
+    test_shared_memory();
+    test_io_ring();
+    test_rseq();
+    test_fpu();
+
+    // forked children inherit lowered priority
+    print("Nice: ");
+    printll(nice(5));
+    print("\n");
+
+    print("Policy: ");
+    printll(sched_getscheduler(0));
+    print("\n");
+
+    struct timespec resolution;
+    clock_getres(CLOCK_MONOTONIC, &resolution);
+    print("Clock resolution ns: ");
+    printll(resolution.tv_nsec);
+    print("\n");
+
+    struct timespec nap = {.tv_sec = 0, .tv_nsec = 10000000};
+    struct timespec before, after;
+    clock_gettime(CLOCK_MONOTONIC, &before);
+    nanosleep(&nap, 0);
+    clock_gettime(CLOCK_MONOTONIC, &after);
+    print("Slept us: ");
+    printll(((after.tv_sec - before.tv_sec) * 1000000000LL + after.tv_nsec
+             - before.tv_nsec)
+            / 1000);
+    print("\n");
+
+    struct syscall_batch_entry batch[] = {
+        {.number = SYS_PRINT, .args = {(long long) "Batched pid: "}},
+        {.number = SYS_GETPID},
+    };
+    if (syscall_batch(batch, 2, SYSCALL_BATCH_STOP_ON_ERROR) == 2) {
+        printll(batch[1].result);
+        print("\n");
+    }
+
     for (int i = 0; i < 11; i++) {
         if (fork() < 0)
             exit(-2);
@@ -97,6 +280,12 @@ void __attribute__((section(".entrypoint"))) main() {
         pthread_join(threads[i], &exit_code);
     }
 
+    print("Process: ");
+    printll(getpid());
+    print(", counter: ");
+    printll(counter);
+    print("\n");
+
     long long exit_code;
     long long exit_pid;
 
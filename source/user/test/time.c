@@ -0,0 +1,20 @@
+#include "time.h"
+#include "syscall.h"
+#include "vdso.h"
+
+long long clock_gettime(int clock_id, struct timespec* time) {
+    // trap only if clock can't be read from user space
+    if (vdso_clock_gettime(clock_id, time) == 0)
+        return 0;
+
+    return syscall2(SYS_CLOCK_GETTIME, clock_id, (long long) time);
+}
+
+long long clock_getres(int clock_id, struct timespec* resolution) {
+    return syscall2(SYS_CLOCK_GETRES, clock_id, (long long) resolution);
+}
+
+long long nanosleep(const struct timespec* request,
+                    struct timespec* remaining) {
+    return syscall2(SYS_NANOSLEEP, (long long) request, (long long) remaining);
+}
\ No newline at end of file
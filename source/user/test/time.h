@@ -0,0 +1,16 @@
+#ifndef SOS_TIME_H
+#define SOS_TIME_H
+
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+
+struct timespec {
+    long long tv_sec;
+    long long tv_nsec;
+};
+
+long long clock_gettime(int clock_id, struct timespec* time);
+long long clock_getres(int clock_id, struct timespec* resolution);
+long long nanosleep(const struct timespec* request, struct timespec* remaining);
+
+#endif // SOS_TIME_H
\ No newline at end of file
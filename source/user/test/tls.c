@@ -0,0 +1,11 @@
+#include "tls.h"
+#include "syscall.h"
+
+long long arch_prctl(int code, long long addr) {
+    return syscall2(SYS_ARCH_PRCTL, code, addr);
+}
+
+long long tls_setup(struct tls_block* block) {
+    *block = (struct tls_block){.self = block};
+    return arch_prctl(ARCH_SET_FS, (long long) block);
+}
\ No newline at end of file
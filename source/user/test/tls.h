@@ -0,0 +1,48 @@
+#ifndef SOS_TLS_H
+#define SOS_TLS_H
+
+#define ARCH_SET_FS 0x1002
+#define ARCH_GET_FS 0x1003
+
+#define TLS_SLOTS 16
+
+// Layout follows x86_64 abi: fs base points to block which starts with pointer
+// to itself, so that its address is got with single %fs relative load
+struct tls_block {
+    struct tls_block* self;
+    void* slots[TLS_SLOTS];
+};
+
+long long arch_prctl(int code, long long addr);
+
+// Makes block thread-local storage of calling thread, block must outlive the
+// thread or next tls_setup
+long long tls_setup(struct tls_block* block);
+
+static inline struct tls_block* tls_current() {
+    struct tls_block* block;
+    __asm__ volatile("mov %%fs:0, %0" : "=r"(block));
+    return block;
+}
+
+#define TLS_SLOT_OFFSET(slot)                                                  \
+    ((long long) __builtin_offsetof(struct tls_block, slots)                   \
+     + (slot) * (long long) sizeof(void*))
+
+static inline void* tls_get(int slot) {
+    void* value;
+    __asm__ volatile("mov %%fs:(%1), %0"
+                     : "=r"(value)
+                     : "r"(TLS_SLOT_OFFSET(slot))
+                     : "memory");
+    return value;
+}
+
+static inline void tls_set(int slot, void* value) {
+    __asm__ volatile("mov %1, %%fs:(%0)"
+                     :
+                     : "r"(TLS_SLOT_OFFSET(slot)), "r"(value)
+                     : "memory");
+}
+
+#endif // SOS_TLS_H
\ No newline at end of file
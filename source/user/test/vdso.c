@@ -0,0 +1,48 @@
+#include "vdso.h"
+
+#define NS_PER_SECOND 1000000000ULL
+
+static unsigned long long read_counter() {
+    unsigned int low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((unsigned long long) high << 32) | low;
+}
+
+long long vdso_clock_gettime(int clock_id, struct timespec* time) {
+    const volatile struct vdso_clock_data* data =
+        (const volatile struct vdso_clock_data*) VDSO_CLOCK_DATA_ADDR;
+
+    if (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC)
+        return -1;
+
+    unsigned long long ns;
+    while (1) {
+        unsigned long long sequence = data->sequence;
+        if (sequence & 1)
+            continue;
+
+        if (data->mode != VDSO_CLOCK_COUNTER)
+            return -1;
+
+        unsigned long long cycles = read_counter() - data->base_cycles;
+        ns = data->base_ns
+             + (unsigned long long) (((unsigned __int128) cycles * data->mult)
+                                     >> data->shift);
+        if (clock_id == CLOCK_REALTIME)
+            ns += data->realtime_offset_ns;
+
+        // loads are not reordered with each other on x86, only compiler
+        // has to be stopped
+        __asm__ volatile("" ::: "memory");
+        if (data->sequence == sequence)
+            break;
+    }
+
+    time->tv_sec = ns / NS_PER_SECOND;
+    time->tv_nsec = ns % NS_PER_SECOND;
+    return 0;
+}
+
+long long vdso_getpid() {
+    return ((const struct vdso_process_data*) VDSO_PROCESS_DATA_ADDR)->pid;
+}
\ No newline at end of file
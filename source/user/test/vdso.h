@@ -0,0 +1,33 @@
+#ifndef SOS_VDSO_H
+#define SOS_VDSO_H
+
+#include "time.h"
+
+// Mirrors pages kernel maps into every process, signal handlers return to
+// trampoline page, it is not meant to be called directly
+#define VDSO_CLOCK_DATA_ADDR 0x00007F0000000000ULL
+#define VDSO_PROCESS_DATA_ADDR 0x00007F0000001000ULL
+#define VDSO_SIGNAL_TRAMPOLINE_ADDR 0x00007F0000002000ULL
+
+#define VDSO_CLOCK_SYSCALL 0
+#define VDSO_CLOCK_COUNTER 1
+
+struct vdso_clock_data {
+    unsigned long long sequence; // odd while kernel updates data
+    unsigned long long mode;
+    unsigned long long base_cycles;
+    unsigned long long base_ns;
+    unsigned long long mult;
+    unsigned long long shift;
+    unsigned long long realtime_offset_ns;
+};
+
+struct vdso_process_data {
+    unsigned long long pid;
+};
+
+// Returns -1 if clock can't be read without syscall
+long long vdso_clock_gettime(int clock_id, struct timespec* time);
+long long vdso_getpid();
+
+#endif // SOS_VDSO_H
\ No newline at end of file